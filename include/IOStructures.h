@@ -53,6 +53,22 @@ typedef struct properties{
     int file; /**< File format (1 libsvm, 0 csv). */
     char *separator;/**< csv char separator. */
     int verbose; /**< 1 print messages in the standard output, 0 silent mode. */
+    double CacheSize; /**< Memory budget (in MB) of the kernel row cache (0 disables the cache). */
+    int Shrinking; /**< If the samples that stay at a bound are temporarily removed from the training (1) or not (0). */
+    int AdaptiveSize; /**< If the size of the working set is adapted during the training (1) or fixed (0). */
+    int WorkingSetPolicy; /**< Selection of the working set among the samples that violate the KKT conditions (0 random, 1 largest violation, 2 half largest violation and half random). */
+    int FastExp; /**< Exponential of the rbf kernel in blocks (0 math library, 1 vectorized approximation). */
+    int Single; /**< Storage of the features (0 double precision, 1 single precision). */
+    int CSR; /**< Layout of the features (0 array of svm_sample, 1 CSR format). */
+    int Folds; /**< Number of folds of the cross validation (0 to train a model). */
+    char *CPath; /**< List of costs separated by commas to train one model per cost (NULL to train a single cost). */
+    char *InitModel; /**< File of a trained model used as the starting point of the training (NULL to start from zero). */
+    char *Checkpoint; /**< File where the state of the full solver is saved periodically (NULL to disable the checkpoints). */
+    int CheckpointInterval; /**< Number of iterations between two checkpoints (used if CheckpointSeconds is 0). */
+    double CheckpointSeconds; /**< Seconds between two checkpoints (0 to use CheckpointInterval). */
+    char *Resume; /**< Checkpoint file used to resume an interrupted training (NULL to start a new training). */
+    double Deadline; /**< Maximum training time in seconds, the best weights found so far are returned when it is reached (0 without limit). */
+    int Multiclass; /**< Decomposition of the problems with more than two classes (0 one-vs-one, 1 one-vs-rest). */
 }properties;
 
 
@@ -69,6 +85,9 @@ typedef struct predictProperties{
     int file; /**< File format (1 libsvm, 0 csv). */
     char *separator;/**< csv char separator. */
     int verbose; /**< 1 print messages in the standard output, 0 silent mode. */
+    int FastExp; /**< Exponential of the rbf kernel (0 math library, 1 vectorized approximation). */
+    int Single; /**< Storage of the features (0 double precision, 1 single precision). */
+    int CSR; /**< Layout of the features (0 array of svm_sample, 1 CSR format). */
 }predictProperties;
 
 
@@ -90,9 +109,44 @@ typedef struct model{
     int maxdim; /**< Number of dimensions of the dataset. */
     double bias; /**< The bias term of the classification function. */
     struct svm_sample* features; /**< Array of features.*/  
+    int single; /**< If the support vectors are stored in single precision (xs) instead of x. */
+    struct svm_sample_single **xs; /**< The support vectors in single precision. */
+    struct svm_sample_single* featuresSingle; /**< Array of features in single precision.*/
+    int csr; /**< If the features are stored in CSR format (rowPtr, indexes and values) instead of x. */
+    int *rowPtr; /**< Position of the first feature of every sample in indexes and values, the last element is the number of features (CSR format). */
+    unsigned int *indexes; /**< The feature index of every value (CSR format). */
+    double *values; /**< The values of the features distinct than zero (CSR format). */
+    int dense; /**< If the features are stored in the dense matrix instead of x. */
+    double *matrix; /**< Row-major matrix of features aligned to 64 bytes, the feature k of the sample i is matrix[i*stride+k-1] (dense layout). */
+    int stride; /**< Distance between two rows of the dense matrix, maxdim rounded up to a multiple of 64 bytes (dense layout). */
+    int deadline; /**< If the training stopped on the deadline before the convergence (1) or not (0). */
 }model;
 
 
+/**
+ * @brief A multi-class model.
+ * It combines the binary classifiers of the decomposition of a problem with more than two classes. The
+ * support vectors of all the binary classifiers are stored once in a common model, so the prediction
+ * evaluates the kernel function of every distinct support vector only once per sample. The coefficients
+ * of the binary classifier k are the positions start[k],...,start[k+1]-1 of svIndex and weights.
+ */
+
+typedef struct multiclassModel{
+    int nClasses; /**< Number of classes. */
+    double *labels; /**< The label of every class in ascending order. */
+    int strategy; /**< Decomposition in binary problems (0 one-vs-one, 1 one-vs-rest). */
+    int nModels; /**< Number of binary classifiers. */
+    int *positive; /**< The class of the positive samples of every binary classifier. */
+    int *negative; /**< The class of the negative samples of every binary classifier (-1 for the rest of classes). */
+    double *bias; /**< The bias term of every binary classifier. */
+    int *start; /**< Position of the first coefficient of every binary classifier, the last element is the number of coefficients. */
+    int *svIndex; /**< The support vector of the common model of every coefficient. */
+    double *weights; /**< The weight of every coefficient. */
+    model svs; /**< The distinct support vectors of all the binary classifiers (its weights are not used). */
+    int deadline; /**< If the training of any binary classifier stopped on the deadline before the convergence (1) or not (0). */
+}multiclassModel;
+
+
 /**
  * @brief A single feature of a data.
  *
@@ -105,10 +159,31 @@ typedef struct svm_sample{
 }svm_sample;
 
 
+/**
+ * @brief A single feature of a data in single precision.
+ *
+ * This structure represents a single feature of a data using half of the memory of svm_sample (8 bytes instead of 16 bytes).
+ */
+
+typedef struct svm_sample_single{
+    int index; /**< The feature index. */   
+    float value; /**< The feature value. */   
+}svm_sample_single;
+
+
 /**
  * @brief A dataset.
  *
  * This structure represents a dataset, a collection of samples and its associated labels.
+ *
+ * The features are stored in one of these layouts:
+ * - x: Every sample is an array of svm_sample terminated by a feature with index -1 (default layout).
+ * - xs: The same layout using svm_sample_single (single precision).
+ * - CSR: Compressed Sparse Row format. The features of the sample i are indexes[rowPtr[i]...rowPtr[i+1]-1]
+ *   and values[rowPtr[i]...rowPtr[i+1]-1], the indexes and the values are stored in different arrays without padding.
+ * - Dense: Only for dense datasets, a row-major matrix of maxdim columns aligned to 64 bytes without indexes.
+ *
+ * The functions sampleLength and copySample read a sample in any layout.
  */
 
 typedef struct svm_dataset{
@@ -119,6 +194,16 @@ typedef struct svm_dataset{
     struct svm_sample **x; /**< Pointer to the first feature of every sample. */   
     double *quadratic_value; /**< The L2 norm of every sample. It is used to compute kernel functions faster.*/
     struct svm_sample* features; /**< Array of features.*/  
+    int single; /**< If the features are stored in single precision (xs) instead of x. */
+    struct svm_sample_single **xs; /**< Pointer to the first feature of every sample in single precision. */
+    struct svm_sample_single* featuresSingle; /**< Array of features in single precision.*/
+    int csr; /**< If the features are stored in CSR format (rowPtr, indexes and values) instead of x. */
+    int *rowPtr; /**< Position of the first feature of every sample in indexes and values, the last element is the number of features (CSR format). */
+    unsigned int *indexes; /**< The feature index of every value (CSR format). */
+    double *values; /**< The values of the features distinct than zero (CSR format). */
+    int dense; /**< If the features are stored in the dense matrix instead of x. */
+    double *matrix; /**< Row-major matrix of features aligned to 64 bytes, the feature k of the sample i is matrix[i*stride+k-1] (dense layout). */
+    int stride; /**< Distance between two rows of the dense matrix, maxdim rounded up to a multiple of 64 bytes (dense layout). */
 }svm_dataset;
 
 /**
@@ -130,6 +215,122 @@ typedef struct svm_dataset{
 
 void freeDataset (svm_dataset data);
 
+/**
+ * @brief It stores the features of a dataset in single precision.
+ *
+ * It copies the features of a dataset into an array of svm_sample_single and frees the
+ * double precision features, halving the memory of the features.
+ * @param dataset The dataset.
+ * @param samples The number of samples stored in the dataset (the training sets also contain the average of every class).
+ */
+
+void datasetToSingle(svm_dataset *dataset, int samples);
+
+/**
+ * @brief It stores the support vectors of a model in single precision.
+ *
+ * @param mymodel The model.
+ */
+
+void modelToSingle(model *mymodel);
+
+/**
+ * @brief It stores the features of a dataset in CSR format.
+ *
+ * It copies the features of a dataset into the CSR arrays (rowPtr, indexes and values) and frees
+ * the array of svm_sample.
+ * @param dataset The dataset.
+ * @param samples The number of samples stored in the dataset (the training sets also contain the average of every class).
+ */
+
+void datasetToCSR(svm_dataset *dataset, int samples);
+
+/**
+ * @brief It stores the support vectors of a model in CSR format.
+ *
+ * @param mymodel The model.
+ */
+
+void modelToCSR(model *mymodel);
+
+/**
+ * @brief It stores the features of a dense dataset in a dense matrix.
+ *
+ * It copies the features of a dense dataset into a row-major matrix aligned to 64 bytes whose rows
+ * are padded to a multiple of 64 bytes and frees the array of svm_sample. Sparse datasets are not changed.
+ * @param dataset The dataset.
+ * @param samples The number of samples stored in the dataset (the training sets also contain the average of every class).
+ */
+
+void datasetToDense(svm_dataset *dataset, int samples);
+
+/**
+ * @brief It stores the support vectors of a dense model in a dense matrix.
+ *
+ * @param mymodel The model.
+ */
+
+void modelToDense(model *mymodel);
+
+/**
+ * @brief Number of features of a sample of a dataset.
+ *
+ * @param dataset The dataset.
+ * @param index The index of the sample.
+ * @return The number of features of the sample (without the final -1 index).
+ */
+
+int sampleLength(svm_dataset dataset, int index);
+
+/**
+ * @brief It copies a sample of a dataset.
+ *
+ * It copies the features of a sample (including the final -1 index) into an array in double precision.
+ * @param dataset The dataset.
+ * @param index The index of the sample.
+ * @param result The array of sampleLength()+1 elements where the sample is copied.
+ */
+
+void copySample(svm_dataset dataset, int index, svm_sample *result);
+
+/**
+ * @brief It finds the support vectors of a model in a dataset.
+ *
+ * Every support vector is matched with a sample of the dataset that has the same features. The features with
+ * value zero are ignored, so the layouts of the dataset and the model do not need to be the same. Every sample
+ * of the dataset is matched at most once.
+ * @param dataset The dataset.
+ * @param mymodel The model (svm_sample layout, as it is loaded by readModel).
+ * @return An array with the index of the sample of every support vector (-1 if it is not in the dataset).
+ */
+
+int *matchSupportVectors(svm_dataset dataset, model *mymodel);
+
+/**
+ * @brief It creates a dataset with a subset of the samples of other dataset.
+ *
+ * The subset shares the features of the original dataset when they are stored as arrays of samples (x and xs)
+ * and copies them in the CSR and dense layouts, where the rows must be contiguous. The labels and the norms
+ * are copied, so they are not calculated again. The average of every class of the original dataset is also
+ * copied after the last sample. The subset can be released with freeDataset.
+ * @param dataset The original dataset.
+ * @param indexes The indexes of the samples of the subset.
+ * @param n The number of samples of the subset.
+ * @return The subset.
+ */
+
+svm_dataset subsetDataset(svm_dataset dataset, int *indexes, int n);
+
+/**
+ * @brief Random assignment of the samples of a dataset to the folds of a cross validation.
+ *
+ * @param l The number of samples.
+ * @param folds The number of folds.
+ * @return The fold of every sample, every fold has l/folds samples (rounded up or down).
+ */
+
+int *crossValidationFolds(int l, int folds);
+
 /**
  * @brief Free model memory
  *
@@ -139,6 +340,27 @@ void freeDataset (svm_dataset data);
 
 void freeModel (model modelo);
 
+/**
+ * @brief It calculates the average of every class of a subset.
+ * The training sets store the average of the positive and the negative samples after the last sample. This
+ * function replaces the averages that a subset copies from the original dataset by the averages of the
+ * samples of the subset with their current labels, it is used when the samples of the subset are labeled again.
+ * @param subset A subset created with subsetDataset.
+ */
+
+void subsetClassAverages(svm_dataset *subset);
+
+/**
+ * @brief It merges the binary classifiers of a multi-class model.
+ * The distinct support vectors of the binary classifiers (compared by their features) are stored in
+ * the common model and the coefficients of every classifier point to them.
+ * @param mymodel The multi-class model with the classes and the binary problems (nClasses, labels, strategy,
+ * nModels, positive and negative), the rest of the fields are filled.
+ * @param models The binary classifier of every binary problem (svm_sample layout, as it is built by the training functions).
+ */
+
+void mergeModels(multiclassModel *mymodel, model *models);
+
 /**
  * @brief It reads a file that contains a labeled dataset in libsvm format.
  *
@@ -209,6 +431,7 @@ svm_dataset readUnlabeledFileCSV(char filename[],char* separator);
  * @brief It stores a trained model into a file.
  *
  * It stores the struct of a trained model (that has been obtained using PIRWLS or PSIRWLS) into a file.
+ * The support vectors are always written as arrays of svm_sample, the models in CSR format are converted.
  * @param mod The struct with the model to store.
  * @param Output The name of the file.
  */
@@ -219,6 +442,7 @@ void storeModel(model * mod, FILE *Output);
  * @brief It loads a trained model from a file.
  *
  * It loads a trained model (that has been obtained using PIRWLS or PSIRWLS) from a file.
+ * The support vectors are loaded as arrays of svm_sample, use modelToSingle, modelToCSR or modelToDense to change their layout.
  * @param mod The pointer with the struct to load results.
  * @param Input The name of the file.
  */
@@ -226,6 +450,46 @@ void storeModel(model * mod, FILE *Output);
 void readModel(model * mod, FILE *Input);
 
 
+/**
+ * @brief It stores a multi-class model into a file.
+ *
+ * The file starts with its own magic bytes, so the predictor can tell the multi-class models from the
+ * binary ones. The common model of the support vectors is stored after the binary classifiers using storeModel.
+ * @param mod The multi-class model to store.
+ * @param Output The file.
+ * @return 0 if the model was written, 1 on a write error.
+ */
+
+int storeMulticlassModel(multiclassModel *mod, FILE *Output);
+
+/**
+ * @brief It loads a multi-class model from a file.
+ *
+ * The support vectors are loaded as arrays of svm_sample, use modelToSingle, modelToCSR or modelToDense on mod->svs to change their layout.
+ * @param mod The pointer with the struct to load results.
+ * @param Input The file.
+ */
+
+void readMulticlassModel(multiclassModel *mod, FILE *Input);
+
+/**
+ * @brief It tells if a model file contains a multi-class model.
+ *
+ * It reads the first bytes of the file and it goes back to the same position.
+ * @param Input The file.
+ * @return 1 if the file contains a multi-class model and 0 otherwise.
+ */
+
+int isMulticlassModel(FILE *Input);
+
+/**
+ * @brief Free multi-class model memory
+ * Free memory allocated by a multi-class model.
+ * @param mod The model
+ */
+
+void freeMulticlassModel(multiclassModel mod);
+
 /**
  * @brief It writes the content of a double array into a file.
  *
@@ -60,6 +60,33 @@ double *test(svm_dataset dataset, model mymodel,predictProperties props);
 
 double *softTest(svm_dataset dataset, model mymodel,predictProperties props);
 
+/**
+ * @brief Function to classify data with a multi-class model.
+ *
+ * The kernel function of every sample and every distinct support vector is evaluated once and it is used by
+ * all the binary classifiers. In the one-vs-one decomposition every binary classifier votes for one of its two
+ * classes and the class with more votes is chosen (the smallest label in a tie). In the one-vs-rest decomposition
+ * the class of the binary classifier with the largest output is chosen.
+ * @param dataset The test set.
+ * @param mymodel A trained multi-class model.
+ * @param props The test properties.
+ * @return The label of the class of every test sample.
+ */
+
+double *multiclassTest(svm_dataset dataset, multiclassModel mymodel,predictProperties props);
+
+/**
+ * @brief Accuracy of a model on a labeled dataset.
+ *
+ * The support vectors of the model are converted to the layout of the dataset before the classification.
+ * @param dataset The labeled test set.
+ * @param mymodel A trained SVM model (svm_sample layout, as it is built by the training functions).
+ * @param props The test properties.
+ * @return The fraction of samples that are correctly classified.
+ */
+
+double modelAccuracy(svm_dataset dataset, model *mymodel,predictProperties props);
+
 
 /**
  * @brief Print instructions.
@@ -39,45 +39,55 @@
 
 
 /**
- * @brief Function to allocate auxiliar memory to be used in the algebra operations.
+ * @brief Context of the parallel algebra operations.
+ *
+ * It owns the auxiliar memory of every thread. Every solver uses its own context, so different
+ * trainings can run at the same time in the same process.
+ */
+
+typedef struct solverContext{
+    int Threads; /**< Number of threads of the linear algebra functions. */
+    int size; /**< Size of the dimensions of the matrices that the auxiliar memory can handle. */
+    double **auxmemory1; /**< Auxiliar memory of every thread to perform temporal results. */
+    double **auxmemory2; /**< Auxiliar memory of every thread to perform temporal results. */
+    double **auxmemory3; /**< Auxiliar memory of every thread to perform temporal results. */
+}solverContext;
+
+/**
+ * @brief Function to create a context with the auxiliar memory used in the algebra operations.
  *
- * 
  * The parallel lineal algebra functions of this module require some memory for every thead to
- * allocate temporal results. This function must be called before any other function.
+ * allocate temporal results. Every solver owns its context, so different trainings can run at the same time.
  *
  * @param Threads The number of threads to parallelize the linear algebra functions.
  * @param size The size of the dimensions of the matrices that will be handle. If a matrix has a rows and b columns, then n=max(a,b).
- * @see updateMemory()
+ * @return The context.
+ * @see updateSolverContext()
  */
 
-void initMemory(int Threads, int size);
+solverContext *initSolverContext(int Threads, int size);
 
 /**
- * @brief Function to free auxiliar memory to be used in the algebra operations.
+ * @brief Function to free a context of the algebra operations.
  *
- * 
- * The parallel lineal algebra functions of this module require some memory for every thead to
- * allocate temporal results. This function must be called after any other function.
- *
- * @param Threads The number of threads to parallelize the linear algebra functions.
- * @see updateMemory()
+ * @param context The context.
+ * @see initSolverContext()
  */
 
-void freeMemory(int Threads);
+void freeSolverContext(solverContext *context);
 
 
 /**
- * @brief Function to update auxiliar memory to be used in the algebra operations.
+ * @brief Function to enlarge the auxiliar memory of a context.
  *
- * The parallel lineal algebra functions of this module require some memory for every thead to
- * allocate temporal results. This function must be called if we allocated the memory using the function initMemory and we are going to work with bigger matrices.
+ * This function must be called if we are going to work with bigger matrices than the size of the context.
  *
- * @param Threads The number of threads to parallelize the linear algebra functions.
+ * @param context The context.
  * @param size The size of the dimensions of the matrices that will be handle. If a matrix has a rows and b columns, then n=max(a,b).
- * @see initMemory()
+ * @see initSolverContext()
  */
 
-void updateMemory(int Threads, int size);
+void updateSolverContext(solverContext *context, int size);
 
 /**
  * @brief This function saves a piece of a matrix in the auxiliar memory.
@@ -132,10 +142,11 @@ void putSubMatrix(double *matrix,int size1,int size2,int O1,int O2,double *A, in
  * @param n The order of the square submatrix
  * @param nCores The number of threads to perform the task.
  * @param deep It is a recursive function, this parameter tell the recursion deep to use.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see Chol()
  */
 
-void ParallelChol(double *matrix,int r,int c, int ro, int co, int n,int nCores, int deep);
+void ParallelChol(double *matrix,int r,int c, int ro, int co, int n,int nCores, int deep, solverContext *context);
 
 
 /**
@@ -165,9 +176,24 @@ void ParallelChol(double *matrix,int r,int c, int ro, int co, int n,int nCores,
  * @param ror The row where the result submatrix starts.
  * @param cor The column where the result submatrix starts.
  * @param nCores The number of threads to launch to solve the task.
+ * @param context The context of the solver with the temporal memory of every thread.
+ */
+
+void ParallelLinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, solverContext *context);
+
+/**
+ * @brief Parallel linear system with a given temporal memory.
+ *
+ * Like ParallelLinearSystem(), but the temporal memory of the parallel Cholesky factorization is
+ * given by the caller, so a solver that solves many systems allocates it only once.
+ *
+ * @param memaux The temporal memory, it must have space for 2*ceil(n/2)^2 elements (if it is NULL the
+ * function allocates it).
+ * @param context The context of the solver with the temporal memory of every thread.
+ * @see ParallelLinearSystem()
  */
 
-void ParallelLinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores);
+void ParallelLinearSystemBuffer(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, double *memaux, solverContext *context);
 
 
 /**
@@ -199,6 +225,68 @@ void ParallelVectorMatrixT(double *m1,int size,double *m2,double *result, int nu
 
 void ParallelVectorMatrix(double *m1,int size,double *m2,double *result, int numThreads);
 
+/**
+ * @brief Rank one update or downdate of a Cholesky factorization.
+ *
+ * Given the lower triangular factor L of a matrix A=LL' (column-major order), it obtains the
+ * factor of A+sign*xx'. The first p elements of x must be zero, so only the columns p,...,n-1
+ * of the factor change. The vector x is overwritten.
+ *
+ * @param L The lower triangular factor (column-major, leading dimension n).
+ * @param n The order of the matrix.
+ * @param p The first element of x distinct than zero.
+ * @param x The vector of the update.
+ * @param sign 1.0 to update (A+xx') or -1.0 to downdate (A-xx').
+ * @return 0 if the new matrix is positive definite, 1 if a downdate failed (the factor is not valid anymore).
+ */
+
+int CholeskyRankOneUpdate(double *L, int n, int p, double *x, double sign);
+
+/**
+ * @brief Cholesky factorization of a matrix after removing a row and a column.
+ *
+ * Given the factor of a matrix of order n, it obtains the factor of the matrix without the row and
+ * the column p. The result is stored in L with leading dimension n-1.
+ *
+ * @param L The lower triangular factor (column-major, leading dimension n).
+ * @param n The order of the matrix.
+ * @param p The row and column to remove.
+ * @param work Auxiliar array of length n.
+ */
+
+void CholeskyDeleteRow(double *L, int n, int p, double *work);
+
+/**
+ * @brief Cholesky factorization of a matrix after adding a last row and column.
+ *
+ * Given the factor of a matrix of order n, it obtains the factor of the matrix with a new last row
+ * and column. The result is stored in L with leading dimension n+1, so L must have space for (n+1)^2 elements.
+ *
+ * @param L The lower triangular factor (column-major, leading dimension n).
+ * @param n The order of the matrix.
+ * @param column The first n elements of the new column (they are overwritten).
+ * @param diag The new diagonal element.
+ * @return 0 if the new matrix is positive definite, 1 otherwise (the factor is not valid anymore).
+ */
+
+int CholeskyAppendRow(double *L, int n, double *column, double diag);
+
+/**
+ * @brief It solves a bordered linear system using the Cholesky factor of its first block.
+ *
+ * It solves the system of order n+1 [A y; y' 0] x = b where the factor of A is known. The last pivot of this
+ * matrix is not positive, so it uses the same factor that dpotrf leaves in ParallelLinearSystem when this
+ * pivot fails, [L 0; l' -l'l] with l=L^-1 y, and the result is the same that ParallelLinearSystem obtains.
+ *
+ * @param L The lower triangular factor of A (column-major, leading dimension n).
+ * @param n The order of A.
+ * @param y The border of the matrix (length n).
+ * @param b The independent term (length n+1), it is overwritten with the solution.
+ * @param work Auxiliar array of length n.
+ */
+
+void BorderedCholeskySolve(double *L, int n, double *y, double *b, double *work);
+
 /**
  * @cond
  */
@@ -224,12 +312,12 @@ void ParallelVectorMatrix(double *m1,int size,double *m2,double *result, int num
  * @param memaux The auxiliar memory.
  * @param blockSize The size of its memory to save temporal results.
  * @param deep It is a recursive function, this parameter tell the recursion deep to use.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see ParallelChol()
- * @see initMemory()
- * @see updateMemory()
+ * @see initSolverContext()
  */
 
-void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh, int deep,int posIni,double *memaux, int blockSize);
+void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh, int deep,int posIni,double *memaux, int blockSize, solverContext *context);
 
 
 /**
@@ -261,10 +349,11 @@ void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh
  * @param posIni Variable to know what task to do by this thread.
  * @param memaux The auxiliar memory.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see ParallelLinearSystem()
  */
 
-void LinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, int numTh,int posIni,double *memaux, int blockSize);
+void LinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, int numTh,int posIni,double *memaux, int blockSize, solverContext *context);
 
 
 /**
@@ -288,12 +377,13 @@ void LinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix
  * @param numTh Thread identifier.
  * @param memaux The auxiliar memory.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see DiagInversion()
  * @see InversionNLProducts()
  * @see InversionLNProducts()
  */
 
-void TriangleInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni, int numTh,double *memaux,int blockSize);
+void TriangleInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni, int numTh,double *memaux,int blockSize, solverContext *context);
 
 
 /**
@@ -311,10 +401,11 @@ void TriangleInversion(double *matrix,int r, int c, int ro, int co, int n,int nC
  * @param nCores The number of threads to perform the matrix inversion.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh Thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see TriangleInversion()
  */
 
-void DiagInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int numTh);
+void DiagInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int numTh, solverContext *context);
 
 
 /**
@@ -336,10 +427,11 @@ void DiagInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores
  * @param numTh Thread identifier.
  * @param memaux The auxiliar memory for this task.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see TriangleInversion()
  */
 
-void InversionNLProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize);
+void InversionNLProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize, solverContext *context);
 
 
 /**
@@ -361,10 +453,11 @@ void InversionNLProducts(double *matrix,int r, int c, int ro, int co, int n,int
  * @param numTh Thread identifier.
  * @param memaux The auxiliar memory for this task.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see TriangleInversion()
  */
 
-void InversionLNProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize);
+void InversionLNProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize, solverContext *context);
 
 
 /**
@@ -397,9 +490,10 @@ void InversionLNProducts(double *matrix,int r, int c, int ro, int co, int n,int
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
  * @param orientation Auxiliar variable to know the next task to perform.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh,int orientation);
+void NNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh,int orientation, solverContext *context);
 
 
 /**
@@ -431,9 +525,10 @@ void NNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void TNNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh);
+void TNNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context);
 
 /**
  * @brief An auxiliar function of used to perform parallel matrix products.
@@ -464,9 +559,10 @@ void TNNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NNTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh);
+void NNTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context);
 
 /**
  * @brief An auxiliar function of used to perform parallel matrix products.
@@ -491,9 +587,10 @@ void NNTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void AATProduct(double *m1,int r1,int ro1,int c1, int co1,int n1,int n2,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh);
+void AATProduct(double *m1,int r1,int ro1,int c1, int co1,int n1,int n2,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context);
 
 /**
  * @brief This function performs a product of a lower triangular submatrix of matrix m1
@@ -523,9 +620,10 @@ void AATProduct(double *m1,int r1,int ro1,int c1, int co1,int n1,int n2,double K
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void LNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh);
+void LNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context);
 
 
 /**
@@ -556,9 +654,10 @@ void LNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void LTNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh);
+void LTNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context);
 
 /**
  * @brief This function performs a product of a submatrix of matrix m1 and a triangular submatrix 
@@ -588,9 +687,10 @@ void LTNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NLProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh);
+void NLProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context);
 
 
 /**
@@ -621,9 +721,10 @@ void NLProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NLTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh);
+void NLTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context);
 
 
 /**
@@ -645,9 +746,10 @@ void NLTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param numTh The thread identifier.
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void MoveMatrix(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2, int n1, int n2, int nCores,int posIni,int numTh);
+void MoveMatrix(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2, int n1, int n2, int nCores,int posIni,int numTh, solverContext *context);
 
 /**
  * @endcond
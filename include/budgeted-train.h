@@ -34,6 +34,7 @@
 #define BUDGETEDTRAIN_
 
 #include "IOStructures.h"
+#include "ParallelAlgorithms.h"
 
 /**
  * @brief Random selection of centroids for the budgeted model
@@ -57,6 +58,22 @@ int* randomCentroids(svm_dataset dataset,properties props);
 
 int* SGMA(svm_dataset dataset,properties props);
 
+/**
+ * @brief Selection of centroids from a trained budgeted model.
+ *
+ * The centroids of the model are matched with the samples of the training set by their features. If there are more
+ * centroids than the budget, the centroids with the largest weights are selected. If there are less, the rest are
+ * selected at random.
+ *
+ * @param dataset The training set.
+ * @param mymodel The trained model (svm_sample layout, as it is loaded by readModel).
+ * @param props The struct with the training parameters.
+ * @param init Array of props.size elements to store the initial weight of every centroid.
+ * @return The indexes of the centroids.
+ */
+
+int* modelCentroids(svm_dataset dataset, model *mymodel, properties props, double *init);
+
 /**
  * @brief Iterative Re-Weighted Least Squares Algorithm.
  *
@@ -64,10 +81,13 @@ int* SGMA(svm_dataset dataset,properties props);
  * @param dataset The training set.
  * @param indexes The indexes of the centroids selected by the SGMA algorithm.
  * @param props The struct with the training parameters.
+ * @param init The initial weights of every centroid (NULL to start from zero).
+ * @param deadline It returns 1 if the training stopped on props.Deadline and 0 otherwise (NULL if it is not needed).
+ * @param context The context with the temporal memory of the linear algebra functions (NULL to create one for this training).
  * @return The weights of every centroid.
  */
 
-double* IRWLSpar(svm_dataset dataset, int* indexes,properties props);
+double* IRWLSpar(svm_dataset dataset, int* indexes,properties props,double *init,int *deadline,solverContext *context);
 
 
 
@@ -105,6 +125,20 @@ properties parseTrainParameters(int* argc, char*** argv);
 
 model calculateBudgetedModel(properties props, svm_dataset dataset, int *centroids, double * beta );
 
+/**
+ * @brief k-fold cross validation of the budgeted SVM.
+ *
+ * The dataset is loaded once and every fold is a subset of it that shares its features and norms.
+ * The folds are trained one after another, every one of them using all the threads. It prints the
+ * accuracy and the training time of every fold and the average accuracy.
+ *
+ * @param dataset The training set.
+ * @param props The values of the training parameters (props.Folds is the number of folds).
+ * @return The average accuracy.
+ */
+
+double crossValidationBudgeted(svm_dataset dataset,properties props);
+
 #endif
 
 
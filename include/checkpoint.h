@@ -0,0 +1,149 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @file checkpoint.h
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @brief Checkpoints of the state of the full IRWLS solver.
+ *
+ * A checkpoint stores the state of trainFULL at the end of an outer iteration (weights, error,
+ * best weights, working set, shrinking state, iteration counters and random seed) so that an
+ * interrupted training can be resumed from it. The checkpoints are written by a background thread
+ * while the training goes on.
+ */
+
+
+#ifndef CHECKPOINT_
+#define CHECKPOINT_
+
+#include <stdio.h>
+#include <pthread.h>
+
+/**
+ * @brief The state of the full IRWLS solver at the end of an outer iteration.
+ */
+
+typedef struct trainCheckpoint{
+    int l; /**< Number of samples of the training set. */
+    double C; /**< C parameter of the training. */
+    double Kgamma; /**< Gamma parameter of the kernel function. */
+    int kernelType; /**< The kernel function (linear=0, rbf=1). */
+    int iter; /**< Number of outer iterations. */
+    int SinceBest; /**< Iterations since the best value of the stop criterion. */
+    double bestNorm; /**< Best value of the stop criterion. */
+    int MaxWorkingSize; /**< Size of the working set (it changes in the adaptive mode). */
+    int nSW; /**< Number of samples of the working set of the next iteration. */
+    int nSIn; /**< Number of inactive samples. */
+    int shrinking; /**< If the shrinking is still enabled. */
+    int nActive; /**< Number of samples that are not shrunk. */
+    int nShrunk; /**< Number of shrunk samples. */
+    unsigned int seed; /**< State of the random number generator of the solver (rand_r) for the next iterations. */
+    double *beta; /**< Weights of every sample and the bias in the last position. */
+    double *betaBest; /**< Weights with the best value of the stop criterion. */
+    double *e; /**< Error of every sample. */
+    int *SW; /**< Working set of the next iteration. */
+    int *active; /**< Samples that are not shrunk. */
+    int *stable; /**< Number of iterations that every sample has been inactive at a bound. */
+    char *shrunk; /**< If every sample is shrunk. */
+}trainCheckpoint;
+
+
+/**
+ * @brief A background writer of checkpoints.
+ *
+ * It keeps a copy of the last state so that the solver can go on while it is written. The file is
+ * written with a temporary name and renamed at the end, so an interruption during the write keeps
+ * the previous checkpoint.
+ */
+
+typedef struct checkpointWriter{
+    char *file; /**< The checkpoint file. */
+    char *temporary; /**< Temporary file used during the write. */
+    trainCheckpoint state; /**< Copy of the state that is being written. */
+    pthread_t thread; /**< The thread that writes the file. */
+    int running; /**< If a write is in progress. */
+    int written; /**< Number of checkpoints written. */
+}checkpointWriter;
+
+/**
+ * @brief It creates a checkpoint writer.
+ *
+ * @param file The checkpoint file.
+ * @param l The number of samples of the training set.
+ * @return The writer.
+ */
+
+checkpointWriter *initCheckpointWriter(char *file, int l);
+
+/**
+ * @brief It writes a checkpoint in the background.
+ *
+ * The state is copied and a thread writes it to the file. If the previous checkpoint is still
+ * being written, it waits for it first.
+ *
+ * @param writer The writer.
+ * @param state The state of the solver.
+ */
+
+void saveCheckpoint(checkpointWriter *writer, trainCheckpoint *state);
+
+/**
+ * @brief It waits for the last write and frees the writer.
+ *
+ * @param writer The writer.
+ * @return The number of checkpoints that have been written.
+ */
+
+int freeCheckpointWriter(checkpointWriter *writer);
+
+/**
+ * @brief It stores a checkpoint into a file.
+ *
+ * @param state The state of the solver.
+ * @param Output The file.
+ * @return 0 if the checkpoint was written, 1 on a write error.
+ */
+
+int storeCheckpoint(trainCheckpoint *state, FILE *Output);
+
+/**
+ * @brief It loads a checkpoint from a file.
+ *
+ * It allocates the arrays of the state, they must be released with freeCheckpoint.
+ *
+ * @param state The struct to load the state.
+ * @param Input The file.
+ */
+
+void readCheckpoint(trainCheckpoint *state, FILE *Input);
+
+/**
+ * @brief Free checkpoint memory
+ *
+ * Free the arrays allocated by readCheckpoint.
+ * @param state The state.
+ */
+
+void freeCheckpoint(trainCheckpoint state);
+
+#endif
@@ -38,6 +38,8 @@
 #define FULLTRAIN_
 
 #include "IOStructures.h"
+#include "kernelCache.h"
+#include "ParallelAlgorithms.h"
 
 /**
  * @brief Random permutation of n elements.
@@ -50,6 +52,95 @@
 
 int * rpermute(int n);
 
+/**
+ * @brief Permutation of n elements that starts by the k elements with the largest value.
+ *
+ * It finds the k largest values in parallel (every thread selects the k largest values of a part of the
+ * array and the candidates of every thread are merged). The first k elements of the permutation are
+ * sorted from the largest value, the rest of elements follow in an arbitrary order.
+ *
+ * @param value The value of every element.
+ * @param n The number of elements.
+ * @param k The number of largest elements to select.
+ * @param nThreads The number of threads.
+ * @return The permutation.
+ */
+
+int * largestFirst(double *value, int n, int k, int nThreads);
+
+/**
+ * @brief Workspace of a full training.
+ *
+ * The buffers used in every iteration of trainFULL and subIRWLS are allocated once per training, aligned
+ * to 64 bytes, and reused by every iteration. The buffers of the working set have capacity+1 elements and
+ * the buffers of the training set have l elements.
+ */
+
+typedef struct fullWorkspace{
+    int capacity; /**< Maximum size of the working set. */
+    int l; /**< Number of samples of the training set. */
+    double *a; /**< Weight a of every sample of the working set. */
+    int *elementGroup; /**< Group (S1, S2 or S3) of every sample of the working set. */
+    double *betaNew; /**< Weights of the current iteration of subIRWLS. */
+    double *betaAux; /**< Solution of the linear system. */
+    double *betaBest; /**< Best weights of subIRWLS, it is the result of subIRWLS. */
+    int *S1comp; /**< Samples of the group S1. */
+    int *S3comp; /**< Samples of the group S3. */
+    double *H; /**< Matrix of the linear system ((capacity+1)x(capacity+1)). */
+    double **Hrows; /**< Pointer to every row of H. */
+    double *et; /**< Right hand side of the linear system. */
+    double *G13; /**< Effect of the group S3 on the group S1. */
+    double *L; /**< Cholesky factor of the kernel block of S1 ((capacity+1)x(capacity+1)). */
+    int *Lindex; /**< Sample of every row of L. */
+    double *Ldiag; /**< Diagonal term 1/a of every row of L. */
+    char *Lmember; /**< If every sample of the working set is in L. */
+    int *S1position; /**< Position of every sample of the working set in S1. */
+    double *Lrhs; /**< Right hand side of the system solved with L. */
+    double *Lborder; /**< Border of the system solved with L. */
+    double *Lwork; /**< Auxiliar array of the updates of L. */
+    double *memaux; /**< Temporal memory of the parallel linear system. */
+    int *changed; /**< Samples of the working set whose weights changed in the last iteration. */
+    double *delta; /**< Change of the weight of every sample of changed. */
+    double **changedRows; /**< Cached kernel row of every sample of the working set whose weight changed. */
+    kernelCacheBuffers *cacheBuffers; /**< Buffers of the requests of the kernel rows of the working set to the cache. */
+    int *perm; /**< Order of the candidates to the working set (l elements). */
+    int *permAux; /**< Auxiliar permutation (l elements). */
+    int *candidates; /**< Candidates of the selection of the largest violations (l elements). */
+    char *selected; /**< Selected elements of the selection of the largest violations (l elements). */
+    char *previous; /**< Samples of the working set of the previous iteration (l elements). */
+    double *values; /**< Auxiliar values of the training set (l elements). */
+}fullWorkspace;
+
+/**
+ * @brief It creates the workspace of a full training.
+ *
+ * @param capacity The maximum size of the working set.
+ * @param l The number of samples of the training set.
+ * @return The workspace.
+ */
+
+fullWorkspace *initFullWorkspace(int capacity, int l);
+
+/**
+ * @brief It enlarges the buffers of the working set of a workspace.
+ *
+ * The content of the buffers of the working set is not kept.
+ *
+ * @param workspace The workspace.
+ * @param capacity The new maximum size of the working set.
+ */
+
+void resizeFullWorkspace(fullWorkspace *workspace, int capacity);
+
+/**
+ * @brief Free workspace memory
+ *
+ * Free memory allocated by a workspace.
+ * @param workspace The workspace.
+ */
+
+void freeFullWorkspace(fullWorkspace *workspace);
+
 /**
  * @brief IRWLS procedure on a Working Set.
  *
@@ -63,10 +154,14 @@ int * rpermute(int n);
  * @param GIN The classification effect of the inactive set.
  * @param e The current error on every training data.
  * @param beta The bias term of the classification function.
- * @return The new weights vector of the classifier.
+ * @param indexes The index in the training set of every sample of the working set.
+ * @param Krows The cached kernel row of every sample of the working set (NULL if it is not cached).
+ * @param workspace The workspace of the training, its capacity must be at least dataset.l.
+ * @param context The context with the temporal memory of the linear algebra functions.
+ * @return The new weights vector of the classifier, it is stored in the workspace (workspace->betaBest).
  */
 
-double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, double *beta);
+double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, double *beta, int *indexes, double **Krows, fullWorkspace *workspace, solverContext *context);
 
 /**
  * @brief It trains a full SVM with a training set.
@@ -79,10 +174,51 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
  * It trains a full SVM using a training set and the training parameters.
  * @param dataset The training set.
  * @param props The values of the training parameters.
+ * @param init The initial weights of every sample and the bias in the last position (NULL to start from zero).
+ * @param deadline It returns 1 if the training stopped on props.Deadline and 0 otherwise (NULL if it is not needed).
+ * @param context The context with the temporal memory of the linear algebra functions (NULL to create one for this training).
  * @return The weights of every Support Vector of the SVM.
+ * @see initialFULLWeights()
  */
 
-double* trainFULL(svm_dataset dataset,properties props);
+double* trainFULL(svm_dataset dataset,properties props,double *init,int *deadline,solverContext *context);
+
+/**
+ * @brief It trains a full SVM with a training set from an initial solution.
+ *
+ * It trains a full SVM using a training set and the training parameters. The error of the initial
+ * weights and the kernel cache can be kept between consecutive trainings of the same training set.
+ * @param dataset The training set.
+ * @param props The values of the training parameters.
+ * @param init The initial weights of every sample and the bias in the last position (NULL to start from zero).
+ * The weights must satisfy the box constraints of props.C.
+ * @param initError The error of every sample for the initial weights e[i]=y[i]-sum_j init[j]K(i,j)-b
+ * (NULL to calculate it). It is ignored if init is NULL.
+ * @param error Array to store the error of every sample for the returned weights (NULL if it is not needed).
+ * It can be the same array as initError.
+ * @param cache The kernel cache (NULL to train without cache).
+ * @param deadline It returns 1 if the training stopped on props.Deadline and 0 otherwise (NULL if it is not needed).
+ * When the deadline is reached the best weights found so far are returned.
+ * @param context The context with the temporal memory of the linear algebra functions (NULL to create one for this training).
+ * @return The weights of every Support Vector of the SVM.
+ * @see trainFULL()
+ */
+
+double* trainFULLWarm(svm_dataset dataset,properties props,double *init,double *initError,double *error,kernelCache *cache,int *deadline,solverContext *context);
+
+/**
+ * @brief Initial weights of a training set from a trained model.
+ *
+ * The support vectors of the model are matched with the samples of the training set by their features.
+ * The weights of the matched samples are clipped to the box constraints of the current cost.
+ *
+ * @param dataset The training set.
+ * @param mymodel The trained model (svm_sample layout, as it is loaded by readModel).
+ * @param props The values of the training parameters.
+ * @return The weight of every sample and the bias in the last position.
+ */
+
+double* initialFULLWeights(svm_dataset dataset, model *mymodel, properties props);
 
 
 /**
@@ -105,6 +241,17 @@ void printFULLInstructions(void) ;
 
 properties parseTrainFULLParameters(int* argc, char*** argv);
 
+/**
+ * @brief It parses a list of costs.
+ *
+ * It parses a list of costs separated by commas (for example "0.1,1,10,100") and sorts it in increasing order.
+ * @param list The list of costs.
+ * @param n Pointer to store the number of costs.
+ * @return The costs in increasing order.
+ */
+
+double* parseCostList(char *list, int *n);
+
 /**
  * @brief It converts the result into a model struct.
  *
@@ -118,6 +265,20 @@ properties parseTrainFULLParameters(int* argc, char*** argv);
 
 model calculateFULLModel(properties props, svm_dataset dataset, double * beta );
 
+/**
+ * @brief k-fold cross validation of the full SVM.
+ *
+ * The dataset is loaded once and every fold is a subset of it that shares its features and norms.
+ * The folds are trained one after another, every one of them using all the threads. It prints the
+ * accuracy and the training time of every fold and the average accuracy.
+ *
+ * @param dataset The training set.
+ * @param props The values of the training parameters (props.Folds is the number of folds).
+ * @return The average accuracy.
+ */
+
+double crossValidationFULL(svm_dataset dataset,properties props);
+
 #endif
 
 
@@ -0,0 +1,129 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+ 
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ 
+ ============================================================================
+ */
+
+/**
+ * @file grid-search.h
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @brief Search of the training parameters on a grid of values using k-fold cross validation.
+ *
+ * Every point of the grid (a cost, a gamma and, with the budgeted solver, a budget size) is evaluated
+ * with k-fold cross validation. The trainings of every point and fold are independent jobs that are
+ * scheduled across the cores with a work-stealing queue. The dataset and the norms of its samples are
+ * loaded once and shared by all the jobs.
+ */
+
+
+#ifndef GRIDSEARCH_
+#define GRIDSEARCH_
+
+#include "IOStructures.h"
+
+/**
+ * @brief Parameters of the grid search.
+ *
+ * This struct stores the values of the grid and the training parameters shared by all its points.
+ */
+
+typedef struct gridProperties{
+    properties train; /**< Training parameters shared by all the points (C, Kgamma and size are taken from the grid). */
+    double *C; /**< Costs of the grid. */
+    int nC; /**< Number of costs. */
+    double *Kgamma; /**< Gamma parameters of the grid. */
+    int nGamma; /**< Number of gamma parameters. */
+    int *size; /**< Budget sizes of the grid (only with the budgeted solver). */
+    int nSize; /**< Number of budget sizes (1 with the full solver). */
+    int Budgeted; /**< If the points are trained with the budgeted solver (1) or the full solver (0). */
+}gridProperties;
+
+
+/**
+ * @brief The result of a point of the grid.
+ */
+
+typedef struct gridPoint{
+    double C; /**< The cost. */
+    double Kgamma; /**< The gamma parameter of the kernel. */
+    int size; /**< The budget size (0 with the full solver). */
+    double accuracy; /**< Average accuracy of the folds. */
+    double nSVs; /**< Average number of support vectors of the folds. */
+    double time; /**< Sum of the training times of the folds in seconds. */
+}gridPoint;
+
+
+/**
+ * @brief It parses a list of positive values separated by commas.
+ *
+ * @param list The list of values.
+ * @param n It returns the number of values.
+ * @return The values in the order of the list.
+ */
+
+double* parseGridList(char *list, int *n);
+
+/**
+ * @brief Grid search using k-fold cross validation.
+ *
+ * The trainings of every point and fold are scheduled across props.train.Threads threads. Every worker
+ * owns a queue of jobs, it takes the jobs from the front of its own queue and, when it is empty, it steals
+ * jobs from the back of the queues of the other workers.
+ *
+ * Small training sets run many single-threaded jobs at the same time (one per thread) while large training
+ * sets, or grids with fewer jobs than threads, run the jobs one after another using all the threads.
+ *
+ * @param dataset The training set.
+ * @param props The values of the grid and the training parameters (props.train.Folds is the number of folds).
+ * @return The result of every point of the grid, sorted by accuracy (best first).
+ */
+
+gridPoint* gridSearch(svm_dataset dataset, gridProperties props);
+
+/**
+ * @brief It prints the ranked table of the results of the grid.
+ *
+ * @param points The results of the grid sorted by accuracy.
+ * @param n The number of points.
+ * @param budgeted If the budget size column is printed.
+ */
+
+void printGridRanking(gridPoint *points, int n, int budgeted);
+
+/**
+ * @brief It shows the command line instructions in the standard output.
+ *
+ * It shows the command line instructions in the standard output.
+ */
+
+void printGridInstructions(void) ;
+
+/**
+ * @brief It parses the command line.
+ *
+ * It parses input command line to extract the parameters of the grid search.
+ * @param argc The number of words of the command line.
+ * @param argv The list of words of the command line.
+ * @return A struct that contains the values of the grid and the training parameters.
+ */
+
+gridProperties parseGridParameters(int* argc, char*** argv);
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @file jobQueue.h
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @brief Work-stealing queues of independent jobs.
+ *
+ * The jobs are distributed among the queues of a set of workers before they start. Every worker
+ * takes the jobs of its own queue from the head and, when it is empty, it steals the jobs of the
+ * other queues from their tail. They are used to run the trainings of the grid search and of the
+ * binary problems of a multi-class problem in parallel.
+ */
+
+
+#ifndef JOBQUEUE_
+#define JOBQUEUE_
+
+#include <omp.h>
+
+/**
+ * @brief The queue of jobs of a worker.
+ *
+ * The owner takes the jobs from the head and the other workers steal them from the tail.
+ */
+
+typedef struct jobQueue{
+    int *jobs; /**< The jobs. */
+    int head; /**< Position of the next job of the owner. */
+    int tail; /**< Position after the last job. */
+    omp_lock_t lock; /**< Lock of head and tail. */
+}jobQueue;
+
+/**
+ * @brief It creates the queues of a set of workers.
+ *
+ * The jobs 0,...,nJobs-1 are dealt in order, the job i is added to the queue of the worker i%nWorkers.
+ *
+ * @param nJobs The number of jobs.
+ * @param nWorkers The number of workers.
+ * @return An array with the queue of every worker.
+ */
+
+jobQueue *initJobQueues(int nJobs, int nWorkers);
+
+/**
+ * @brief Next job of a worker, from its own queue or stolen from the others.
+ *
+ * No job is added once the workers have started, so a worker finishes when every queue is empty.
+ *
+ * @param queues The queue of every worker.
+ * @param nWorkers The number of workers.
+ * @param worker The worker.
+ * @return The job or -1 when all the queues are empty.
+ */
+
+int nextJob(jobQueue *queues, int nWorkers, int worker);
+
+/**
+ * @brief Free queues memory
+ *
+ * @param queues The queue of every worker.
+ * @param nWorkers The number of workers.
+ */
+
+void freeJobQueues(jobQueue *queues, int nWorkers);
+
+#endif
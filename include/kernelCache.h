@@ -0,0 +1,191 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @file kernelCache.h
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @brief Cache of rows of the kernel matrix.
+ *
+ * A Least Recently Used (LRU) cache of rows of the kernel matrix of a training set. Every row
+ * contains the kernel function of one sample against every sample of the dataset. The number
+ * of rows that can be stored is limited by a memory budget.
+ *
+ * A cache can be a view of the cache of a larger dataset: the rows of the samples of a subset are
+ * gathered from the rows of the larger dataset, so the kernel values are shared by the trainings of
+ * different subsets.
+ */
+
+
+#ifndef KERNELCACHE_
+#define KERNELCACHE_
+
+#include <pthread.h>
+#include "IOStructures.h"
+
+/**
+ * @brief The buffers of a request of rows to a kernel cache.
+ *
+ * Every thread that requests rows to a cache uses its own buffers, so the requests do not allocate memory.
+ */
+
+typedef struct kernelCacheBuffers{
+    int size; /**< Maximum number of rows of a request. */
+    int *missing; /**< Samples whose rows are calculated by the request. */
+    int *missingSlot; /**< The slot of every calculated row. */
+    double **missingRows; /**< The memory of every calculated row. */
+    int *waiting; /**< Slots whose rows are being calculated by other requests. */
+}kernelCacheBuffers;
+
+/**
+ * @brief A cache of rows of the kernel matrix.
+ *
+ * This structure stores rows of the kernel matrix using a Least Recently Used replacement policy.
+ * Rows that are in use are pinned and they can not be replaced until they are released.
+ */
+
+typedef struct kernelCache{
+    int l; /**< Number of samples of the dataset (length of every row). */
+    int capacity; /**< Maximum number of rows that fit in the memory budget. */
+    int nSlots; /**< Number of slots that have been allocated. */
+    double **rows; /**< The memory of every slot. */
+    int *slotSample; /**< The sample whose row is stored in every slot (-1 if the slot is empty). */
+    int *sampleSlot; /**< The slot that stores the row of every sample (-1 if it is not cached). */
+    int *pinned; /**< Number of users of every slot, pinned slots can not be replaced. */
+    int *prev; /**< Previous slot in the LRU list. */
+    int *next; /**< Next slot in the LRU list. */
+    int head; /**< Most recently used slot. */
+    int tail; /**< Least recently used slot. */
+    long long hits; /**< Number of requested rows that were found in the cache. */
+    long long misses; /**< Number of requested rows that had to be computed. */
+    char *pending; /**< If the row of every slot is being calculated (it can not be read yet). */
+    struct kernelCache *parent; /**< The cache of the larger dataset (NULL if it is not a view). */
+    svm_dataset parentDataset; /**< The larger dataset (only views). */
+    int *map; /**< The sample of the larger dataset of every sample (only views). */
+    int *parentIndexes; /**< The samples of the larger dataset of a request (only views, l elements). */
+    double **parentRows; /**< The rows of the larger dataset of a request (only views, l elements). */
+    int *uncached; /**< The samples of a request whose rows are not in the larger cache (only views, l elements). */
+    double **uncachedRows; /**< The rows of the samples in uncached (only views, l elements). */
+    kernelCacheBuffers *parentBuffers; /**< The buffers of the requests to the cache of the larger dataset (only views). */
+    pthread_mutex_t lock; /**< Lock to protect the cache structure. */
+    pthread_cond_t ready; /**< Signaled when pending rows have been calculated. */
+}kernelCache;
+
+/**
+ * @brief It creates a kernel cache.
+ *
+ * It creates a cache of kernel rows for a dataset with l samples. The number of rows is limited by a memory budget.
+ *
+ * @param l The number of samples of the dataset.
+ * @param megabytes The memory budget in MB.
+ * @return The cache or NULL if the budget is not enough to store a single row.
+ */
+
+kernelCache *initKernelCache(int l, double megabytes);
+
+/**
+ * @brief It creates a view of a kernel cache.
+ *
+ * It creates a cache of kernel rows for a subset of a dataset. The rows that are not in the view are
+ * requested to the cache of the dataset and the elements of the subset are gathered, so the rows
+ * calculated by the training of a subset can be used by the trainings of other subsets. The rows that do
+ * not fit in the cache of the dataset are calculated for the subset only.
+ *
+ * A view is used by a single thread, different threads can use different views of the same cache.
+ *
+ * @param parent The cache of the dataset (NULL to create a cache that is not a view).
+ * @param parentDataset The dataset.
+ * @param map The sample of the dataset of every sample of the subset (the array is copied).
+ * @param l The number of samples of the subset.
+ * @param megabytes The memory budget of the view in MB.
+ * @return The view or NULL if the budget is not enough to store a single row.
+ */
+
+kernelCache *initKernelCacheView(kernelCache *parent, svm_dataset parentDataset, int *map, int l, double megabytes);
+
+/**
+ * @brief Free cache memory
+ *
+ * Free memory allocated by a kernel cache.
+ * @param cache The cache.
+ */
+
+void freeKernelCache(kernelCache *cache);
+
+/**
+ * @brief It creates the buffers of the requests to a kernel cache.
+ *
+ * @param size The maximum number of rows of a request.
+ * @return The buffers.
+ */
+
+kernelCacheBuffers *initKernelCacheBuffers(int size);
+
+/**
+ * @brief Free buffers memory
+ *
+ * Free memory allocated by the buffers of the requests to a kernel cache.
+ * @param buffers The buffers.
+ */
+
+void freeKernelCacheBuffers(kernelCacheBuffers *buffers);
+
+/**
+ * @brief It obtains a set of rows of the kernel matrix.
+ *
+ * It looks for the rows of the kernel matrix of a list of samples. The rows that are not
+ * in the cache are calculated in parallel. The rows are pinned and they must be released with
+ * kernelCacheRelease when they are not needed anymore.
+ *
+ * When the memory budget is not enough to store all the requested rows, the pointer of
+ * the rows that could not be stored is NULL and the kernel function must be evaluated by the caller.
+ *
+ * This function can be called from different threads at the same time if every thread uses its own buffers.
+ * A thread that requests a row that is being calculated by another thread sleeps until the row is ready.
+ *
+ * @param cache The cache.
+ * @param dataset The dataset.
+ * @param indexes The indexes of the samples.
+ * @param n The number of samples.
+ * @param props The training parameters (kernel function).
+ * @param rows Array of n pointers where the rows are returned.
+ * @param buffers The buffers of the request, their size must be at least n.
+ * @see kernelCacheRelease()
+ */
+
+void kernelCacheRows(kernelCache *cache, svm_dataset dataset, int *indexes, int n, properties props, double **rows, kernelCacheBuffers *buffers);
+
+/**
+ * @brief It releases a set of rows of the kernel matrix.
+ *
+ * It unpins the rows that were obtained using kernelCacheRows so they can be replaced.
+ *
+ * @param cache The cache.
+ * @param indexes The indexes of the samples.
+ * @param rows The rows returned by kernelCacheRows (NULL rows are ignored).
+ * @param n The number of samples.
+ * @see kernelCacheRows()
+ */
+
+void kernelCacheRelease(kernelCache *cache, int *indexes, double **rows, int n);
+
+#endif
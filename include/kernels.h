@@ -35,6 +35,99 @@
 
 #include "IOStructures.h"
 
+/**
+ * @brief A kernel evaluator.
+ *
+ * It evaluates the kernel function of a sample of a first set and a sample of a second set. The
+ * specialized function for the kernel type and the representation of the samples (sparse or dense,
+ * double or single precision, array of svm_sample, CSR format or dense matrix) is chosen when the evaluator is created, so the loops that evaluate many pairs of samples do not
+ * need to check the training parameters for every pair.
+ *
+ * In a training set both sets are the samples of the dataset. In a test set the first set is
+ * the dataset and the second set contains the Support Vectors of the model.
+ */
+
+typedef struct kernelEvaluator{
+    double (*kernel)(struct kernelEvaluator *evaluator, int index1, int index2); /**< The kernel function of two samples. */
+    double (*distance)(struct kernelEvaluator *evaluator, int index1, int index2); /**< The squared distance of two samples (only rbf kernel). */
+    int kernelType; /**< The kernel function (linear=0, rbf=1). */
+    double gamma; /**< Gamma parameter of the kernel function. */
+    int dim; /**< Number of features of the dense samples. */
+    struct svm_sample **x1; /**< The samples of the first set. */
+    double *norms1; /**< The squared norm of every sample of the first set. */
+    struct svm_sample **x2; /**< The samples of the second set. */
+    double *norms2; /**< The squared norm of every sample of the second set. */
+    struct svm_sample_single **xs1; /**< The samples of the first set in single precision. */
+    struct svm_sample_single **xs2; /**< The samples of the second set in single precision. */
+    int *rowPtr1; /**< Position of the features of every sample of the first set (CSR format). */
+    unsigned int *indexes1; /**< The feature indexes of the first set (CSR format). */
+    double *values1; /**< The feature values of the first set (CSR format). */
+    int *rowPtr2; /**< Position of the features of every sample of the second set (CSR format). */
+    unsigned int *indexes2; /**< The feature indexes of the second set (CSR format). */
+    double *values2; /**< The feature values of the second set (CSR format). */
+    double *matrix1; /**< The dense matrix of the first set (dense layout). */
+    int stride1; /**< Distance between two rows of the dense matrix of the first set. */
+    double *matrix2; /**< The dense matrix of the second set (dense layout). */
+    int stride2; /**< Distance between two rows of the dense matrix of the second set. */
+}kernelEvaluator;
+
+/**
+ * @brief Kernel evaluator of the samples of a training set.
+ *
+ * It creates a kernel evaluator of two samples of the same dataset. The kernel function and the
+ * representation of the dataset (sparse or dense) are resolved here once.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param props The list of properties to extract the kernel parameters.
+ * @return The kernel evaluator.
+ */
+
+kernelEvaluator trainEvaluator(svm_dataset dataset, properties props);
+
+/**
+ * @brief Kernel evaluator of the samples of a dataset and the Support Vectors of a model.
+ *
+ * It creates a kernel evaluator of one sample of the dataset (first index) and one Support Vector
+ * of a trained model (second index). The dense functions are used when the dataset and the model
+ * are dense with the same features. Both must be stored with the same precision and layout.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param mymodel The trained SVM model.
+ * @return The kernel evaluator.
+ */
+
+kernelEvaluator testEvaluator(svm_dataset dataset, model mymodel);
+
+/**
+ * @brief Kernel function of two samples using a kernel evaluator.
+ *
+ * @param evaluator The kernel evaluator.
+ * @param index1 The index of the sample of the first set.
+ * @param index2 The index of the sample of the second set.
+ * @return The kernel function of both samples.
+ */
+
+static inline double kernelEvaluate(kernelEvaluator *evaluator, int index1, int index2){
+    return evaluator->kernel(evaluator,index1,index2);
+}
+
+/**
+ * @brief Kernel function of one sample of the first set and a list of samples of the second set.
+ *
+ * For the Radial Basis Function the distances are calculated first and the exponential
+ * is obtained for the whole row using expBatch.
+ *
+ * @param evaluator The kernel evaluator.
+ * @param index1 The index of the sample of the first set.
+ * @param indexes2 The indexes of the samples of the second set (NULL to use the samples 0,...,n2-1).
+ * @param n2 The number of samples of the second set.
+ * @param fastExp 0 to use the exp function of the math library, 1 to use the vectorized approximation.
+ * @param K Array of length n2 to store the result.
+ * @see expBatch()
+ */
+
+void kernelEvaluatorRow(kernelEvaluator *evaluator, int index1, int *indexes2, int n2, int fastExp, double *K);
+
 /**
  * @brief Radial Basis Function of two elements of the dataset.
  *
@@ -45,6 +138,8 @@
  * x1 and x2 are two elements of the dataset and gamma is a parameter whose value can be found
  * in the struct props. 
  *
+ * To evaluate many pairs of samples it is faster to create a kernel evaluator with trainEvaluator.
+ *
  * @param dataset The strut that contains the dataset information.
  * @param index1 The index of the first element of the dataset.
  * @param index2 The index of the second element of the dataset.
@@ -64,6 +159,8 @@ double kernelFunction(svm_dataset dataset, int index1, int index2, properties pr
  * x1 is an element of the dataset and x2 is a support vector of a trained model, gamma is a parameter whose value can be found
  * in the struct props. 
  *
+ * To evaluate many pairs of samples it is faster to create a kernel evaluator with testEvaluator.
+ *
  * @param dataset The strut that contains the dataset information.
  * @param index1 The index of the sample of the dataset.
  * @param mymodel The trained SVM model.
@@ -73,6 +170,50 @@ double kernelFunction(svm_dataset dataset, int index1, int index2, properties pr
 
 double kernelTest(svm_dataset dataset, int index1, model mymodel, int index2);
 
+/**
+ * @brief Block of the kernel matrix of two lists of samples of the dataset.
+ *
+ * It calculates the kernel function of every sample of the first list against every sample of the second list.
+ *
+ * In dense datasets the block is obtained by tiles using the BLAS function dgemm. For the radial basis
+ * function it uses ||x1-x2||^2 = ||x1||^2 + ||x2||^2 - 2 x1'x2 with the norms stored in the dataset.
+ * In sparse datasets every sample of the first list is scattered into a dense array and its inner
+ * products with the samples of the second list are obtained by a gather of their nonzero features.
+ * The exponential of the radial basis function is obtained for the whole tile using expBatch.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param indexes1 The indexes of the first list of samples (NULL to use the samples 0,...,n1-1).
+ * @param n1 The number of samples of the first list.
+ * @param indexes2 The indexes of the second list of samples (NULL to use the samples 0,...,n2-1).
+ * @param n2 The number of samples of the second list.
+ * @param props The list of properties to extract the kernel parameters.
+ * @param K Array of n1 rows of length n2 to store the result, K[i][j] is the kernel function of the samples indexes1[i] and indexes2[j].
+ */
+
+void kernelBlock(svm_dataset dataset, int *indexes1, int n1, int *indexes2, int n2, properties props, double **K);
+
+/**
+ * @brief Product of a block of the kernel matrix and a vector.
+ *
+ * It adds to the vector y the product of the block of the kernel matrix of two lists of samples and the vector x:
+ *
+ * y[i] += sum_j K(indexes1[i],indexes2[j])*x[j]
+ *
+ * The block is never stored, it is calculated by tiles using kernelBlock.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param indexes1 The indexes of the first list of samples (NULL to use the samples 0,...,n1-1).
+ * @param n1 The number of samples of the first list (length of y).
+ * @param indexes2 The indexes of the second list of samples (NULL to use the samples 0,...,n2-1).
+ * @param n2 The number of samples of the second list (length of x).
+ * @param props The list of properties to extract the kernel parameters.
+ * @param x The vector to multiply.
+ * @param y The vector where the result is accumulated.
+ * @see kernelBlock()
+ */
+
+void kernelBlockProduct(svm_dataset dataset, int *indexes1, int n1, int *indexes2, int n2, properties props, double *x, double *y);
+
 
 #endif
 
@@ -0,0 +1,100 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @file linear-train.h
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @brief Primal IRWLS solver of the linear SVM.
+ *
+ * With the linear kernel the classifier is f(x)=w*x+b, so the IRWLS procedure iterates on the weights w
+ * of the features instead of the weights of the samples. Every iteration solves a weighted least squares
+ * problem with the conjugate gradient method, which only needs products of the samples with vectors,
+ * and the cost of an iteration is linear in the number of features distinct than zero of the training set.
+ *
+ * The weights are stored in an array of maxdim+1 elements: the weight of the feature k is w[k-1] and the
+ * bias is w[maxdim].
+ */
+
+
+#ifndef LINEAR_TRAIN_
+#define LINEAR_TRAIN_
+
+#include "IOStructures.h"
+
+/**
+ * @brief If the primal linear solver is used to train a full SVM.
+ *
+ * The primal solver is selected for the linear kernel. The checkpoints store the state of the dual solver,
+ * so the trainings with checkpoints use the dual solver.
+ *
+ * @param props The values of the training parameters.
+ * @return 1 if the primal linear solver is used, 0 otherwise.
+ */
+
+int linearEngine(properties props);
+
+/**
+ * @brief It trains a linear SVM with the primal IRWLS procedure.
+ *
+ * Every iteration obtains the weight a[i] of every sample from its error, solves the weighted least squares
+ * problem min 0.5*|w|^2+0.5*sum_i a[i]*(y[i]-w*x[i]-b)^2 with the preconditioned conjugate gradient method and
+ * moves the weights towards its solution with a line search on the SVM cost function.
+ *
+ * @param dataset The training set.
+ * @param props The values of the training parameters.
+ * @param init The initial weights of the features and the bias in the last position (NULL to start from zero).
+ * @param deadline It returns 1 if the training stopped on props.Deadline and 0 otherwise (NULL if it is not needed).
+ * @return The weights of the features and the bias in the last position (maxdim+1 elements).
+ */
+
+double* trainLinear(svm_dataset dataset, properties props, double *init, int *deadline);
+
+/**
+ * @brief Initial weights of the primal linear solver from a trained model.
+ *
+ * The weights of the features are the sum of the support vectors multiplied by their weights, the features
+ * that are not in the training set are ignored.
+ *
+ * @param dataset The training set.
+ * @param mymodel The trained model with the linear kernel (svm_sample layout, as it is loaded by readModel).
+ * @param props The values of the training parameters.
+ * @return The weights of the features and the bias in the last position.
+ */
+
+double* initialLinearWeights(svm_dataset dataset, model *mymodel, properties props);
+
+/**
+ * @brief It creates a compact linear model.
+ *
+ * The model has a single support vector with the features of w distinct than zero and weight 1, so it is
+ * stored and used to predict like any other model with the linear kernel.
+ *
+ * @param props The values of the training parameters.
+ * @param dataset The training set.
+ * @param w The weights of the features and the bias in the last position.
+ * @return The model.
+ */
+
+model calculateLinearModel(properties props, svm_dataset dataset, double *w);
+
+#endif
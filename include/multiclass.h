@@ -0,0 +1,71 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @file multiclass.h
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @brief Training of problems with more than two classes.
+ *
+ * A multi-class problem is decomposed in binary problems, one for every pair of classes (one-vs-one) or one
+ * for every class against the rest (one-vs-rest). The binary problems are subsets of the training set that is
+ * loaded once: they share its features and norms, and the full trainings of the one-vs-one problems read
+ * their kernel rows through views of a kernel cache of the whole training set, so the rows of a sample are
+ * calculated once for all the problems of its class. The binary problems are trained in parallel with
+ * work-stealing queues and the resulting classifiers are merged in a multi-class model that stores every
+ * distinct support vector once.
+ */
+
+
+#ifndef MULTICLASS_
+#define MULTICLASS_
+
+#include "IOStructures.h"
+
+/**
+ * @brief The classes of a training set.
+ *
+ * @param dataset The training set.
+ * @param labels Pointer to store the array with the distinct labels in ascending order.
+ * @return The number of classes.
+ */
+
+int datasetClasses(svm_dataset dataset, double **labels);
+
+/**
+ * @brief It trains a multi-class model.
+ *
+ * Problems with enough binary problems and small training sets are trained with many single-threaded
+ * workers, otherwise the binary problems are trained one at a time using all the threads. The deadline
+ * of props.Deadline applies to the whole training.
+ *
+ * @param dataset The training set.
+ * @param labels The distinct labels of the training set in ascending order.
+ * @param nClasses The number of classes.
+ * @param props The values of the training parameters (props.Multiclass is the decomposition).
+ * @param budgeted 1 to train budgeted classifiers, 0 to train full classifiers.
+ * @return The multi-class model.
+ */
+
+multiclassModel trainMulticlass(svm_dataset dataset, double *labels, int nClasses, properties props, int budgeted);
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+
+/**
+ * @file simdKernels.h
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @brief Vectorized operations on dense samples.
+ *
+ * Inner products and squared euclidean distances of two samples of a dense dataset, where both
+ * samples store the same list of features, and the exponential of the radial basis function over
+ * arrays of distances. The instruction set (AVX-512, AVX2, SSE2 or scalar code)
+ * is selected at runtime the first time that one of these functions is called, so the same binary
+ * can be executed in different processors.
+ */
+
+
+#ifndef SIMDKERNELS_
+#define SIMDKERNELS_
+
+#include "IOStructures.h"
+
+/**
+ * @brief Inner product of two dense samples.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of x[i].value*y[i].value.
+ */
+
+double denseDot(svm_sample *x, svm_sample *y, int n);
+
+/**
+ * @brief Squared euclidean distance of two dense samples.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of (x[i].value-y[i].value)^2.
+ */
+
+double denseSquaredDistance(svm_sample *x, svm_sample *y, int n);
+
+/**
+ * @brief Inner product of two dense samples in single precision.
+ *
+ * The products are accumulated in double precision.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of x[i].value*y[i].value.
+ */
+
+double denseDotSingle(svm_sample_single *x, svm_sample_single *y, int n);
+
+/**
+ * @brief Squared euclidean distance of two dense samples in single precision.
+ *
+ * The differences are calculated and accumulated in double precision.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of (x[i].value-y[i].value)^2.
+ */
+
+double denseSquaredDistanceSingle(svm_sample_single *x, svm_sample_single *y, int n);
+
+/**
+ * @brief Inner product of two arrays.
+ *
+ * It is used with the values of the dense samples stored in CSR format.
+ *
+ * @param x The first array.
+ * @param y The second array.
+ * @param n The length of both arrays.
+ * @return The sum of x[i]*y[i].
+ */
+
+double arrayDot(double *x, double *y, int n);
+
+/**
+ * @brief Squared euclidean distance of two arrays.
+ *
+ * @param x The first array.
+ * @param y The second array.
+ * @param n The length of both arrays.
+ * @return The sum of (x[i]-y[i])^2.
+ */
+
+double arraySquaredDistance(double *x, double *y, int n);
+
+/**
+ * @brief Exponential of an array of distances.
+ *
+ * It replaces every value v of the array by exp(-gamma*v).
+ *
+ * @param values The array.
+ * @param n The length of the array.
+ * @param gamma The parameter of the exponential.
+ * @param fast 0 to use the exp function of the math library, 1 to use the vectorized approximation
+ * (relative error below 1e-7 for arguments greater than -708, smaller results are rounded up to exp(-708)).
+ */
+
+void expBatch(double *values, int n, double gamma, int fast);
+
+/**
+ * @brief Instruction set used by the vectorized operations.
+ *
+ * @return The name of the instruction set selected in this processor.
+ */
+
+const char *simdInstructionSet(void);
+
+#endif
@@ -38,6 +38,7 @@
 #include "IOStructures.h"
 #include "full-train.h"
 #include "budgeted-train.h"
+#include "linear-train.h"
 #include "ParallelAlgorithms.h"
 #include "LIBIRWLS-predict.h"
 #include <omp.h>
@@ -75,6 +76,9 @@ static PyObject *predict (PyObject *dummy, PyObject *args, PyObject *kwds)
     props.Threads=1;
     props.Soft=0;
     props.verbose=1;
+    props.FastExp=0;
+    props.Single=0;
+    props.CSR=0;
     svm_dataset dataset;
 
     static char *kwlist[] = {"classifier", "data", "labels", "threads", "Soft","verbose", NULL};
@@ -107,14 +111,20 @@ static PyObject *predict (PyObject *dummy, PyObject *args, PyObject *kwds)
     
     dataset = numpy2dataset(arr1,arr2);
 
-    omp_set_num_threads(props.Threads);
+    Py_DECREF(arr1);
+    Py_DECREF(arr2);
 
+    // The dataset is a copy, the classification runs without the GIL. The
+    // number of threads is an OpenMP variable of the calling thread only.
     double *predictions;
+    int previousThreads;
+    Py_BEGIN_ALLOW_THREADS
+    previousThreads = omp_get_max_threads();
+    omp_set_num_threads(props.Threads);
     if(props.Soft==0) predictions = test(dataset, modelo[0], props);
     else predictions = softTest(dataset, modelo[0], props);
-
-    Py_DECREF(arr1);
-    Py_DECREF(arr2);
+    omp_set_num_threads(previousThreads);
+    Py_END_ALLOW_THREADS
 
     freeDataset(dataset);    
 
@@ -224,6 +234,16 @@ svm_dataset numpy2dataset(PyObject *arr1,PyObject *arr2){
     dataset.x = (svm_sample **) calloc(dataset.l,sizeof(svm_sample *));
 
     dataset.sparse=0;
+    dataset.single=0;
+    dataset.xs=NULL;
+    dataset.featuresSingle=NULL;
+    dataset.csr=0;
+    dataset.rowPtr=NULL;
+    dataset.indexes=NULL;
+    dataset.values=NULL;
+    dataset.dense=0;
+    dataset.matrix=NULL;
+    dataset.stride=0;
     int elements=dataset.l;
     double *aux;
 
@@ -289,6 +309,16 @@ svm_dataset numpy2datasetWithAverage(PyObject *arr1,PyObject *arr2){
     dataset.x = (svm_sample **) calloc(dataset.l+2,sizeof(svm_sample *));
 
     dataset.sparse=0;
+    dataset.single=0;
+    dataset.xs=NULL;
+    dataset.featuresSingle=NULL;
+    dataset.csr=0;
+    dataset.rowPtr=NULL;
+    dataset.indexes=NULL;
+    dataset.values=NULL;
+    dataset.dense=0;
+    dataset.matrix=NULL;
+    dataset.stride=0;
     int elements=dataset.l,positives=0,negatives=0;
     double *aux;
 
@@ -347,8 +377,8 @@ svm_dataset numpy2datasetWithAverage(PyObject *arr1,PyObject *arr2){
     }
 
     for(e=0;e<dataset.maxdim;e++){
-        dataset.quadratic_value[dataset.l] += dataset.features[elements+e].value;
-        dataset.quadratic_value[dataset.l+1] += dataset.features[elements+dataset.maxdim+1+e].value;
+        dataset.quadratic_value[dataset.l] += pow(dataset.features[elements+e].value,2);
+        dataset.quadratic_value[dataset.l+1] += pow(dataset.features[elements+dataset.maxdim+1+e].value,2);
     }    
 
     return dataset;
@@ -373,6 +403,9 @@ budgeted_train (PyObject *dummy, PyObject *args, PyObject *kwds)
     // Pointers to store the dataset
     PyObject *arg1=NULL, *arr1=NULL, *arg2=NULL, *arr2=NULL;
 
+    // Trained model used as the starting point
+    PyObject *pyinit=NULL;
+
     // The properties struct used to train the algorithm
     properties props;
     props.Kgamma = 1.0;
@@ -384,14 +417,35 @@ budgeted_train (PyObject *dummy, PyObject *args, PyObject *kwds)
     props.algorithm=0;
     props.kernelType=1;
     props.verbose=1;
+    props.CacheSize=0.0;
+    props.Shrinking=0;
+    props.WorkingSetPolicy=0;
+    props.AdaptiveSize=0;
+    props.InitModel=NULL;
+    props.Checkpoint=NULL;
+    props.CheckpointInterval=10;
+    props.CheckpointSeconds=0.0;
+    props.Resume=NULL;
+    props.Deadline=0.0;
+    props.Multiclass=0;
+    props.CPath=NULL;
+    props.Folds=0;
+    props.FastExp=0;
+    props.Single=0;
+    props.CSR=0;
     
     // List of keywords parameters.
-    static char *kwlist[] = {"data","labels","gamma", "C", "threads", "size", "algorithm", "kernel","verbose", NULL};
+    static char *kwlist[] = {"data","labels","gamma", "C", "threads", "size", "algorithm", "kernel","verbose","init", NULL};
 
     // It parses the parameters
-    if (!PyArg_ParseTupleAndKeywords(args,kwds, "OO|ddiiiii", kwlist, &arg1, &arg2, &props.Kgamma, &props.C, &props.Threads, &props.size, &props.algorithm, &props.kernelType,&props.verbose))
+    if (!PyArg_ParseTupleAndKeywords(args,kwds, "OO|ddiiiiiO", kwlist, &arg1, &arg2, &props.Kgamma, &props.C, &props.Threads, &props.size, &props.algorithm, &props.kernelType,&props.verbose,&pyinit))
     return NULL;  
 
+    model *initModel = NULL;
+    if (pyinit != NULL && pyinit != Py_None){
+        if (!(initModel = (model*) PyCapsule_GetPointer(pyinit, "CLASSIFIER"))) return NULL;
+    }
+
     // Obtaining the dataset
     arr1 = PyArray_FROM_OTF(arg1, NPY_DOUBLE, NPY_IN_ARRAY);
     if (arr1 == NULL)
@@ -404,25 +458,36 @@ budgeted_train (PyObject *dummy, PyObject *args, PyObject *kwds)
     // Transforming the numpy dataset to our format.
     svm_dataset dataset = numpy2datasetWithAverage(arr1, arr2);
 
-    // Obtaining the centroids
-    omp_set_num_threads(props.Threads);
-    setenv("VECLIB_MAXIMUM_THREADS", "1", 1);
-    initMemory(props.Threads,props.size);
+    // Decref the created python objects
+    Py_DECREF(arr1);
+    Py_DECREF(arr2);
+
+    // The training only uses C structures, it runs without the GIL
     int * centroids;
-    if (props.algorithm==0){
+    double * init = NULL;
+    double * W;
+    model modelo;
+    int previousThreads;
+    Py_BEGIN_ALLOW_THREADS
+    previousThreads = omp_get_max_threads();
+    omp_set_num_threads(props.Threads);
+
+    // Obtaining the centroids
+    if (initModel != NULL){
+        init = (double *) calloc(props.size,sizeof(double));
+        centroids=modelCentroids(dataset,initModel,props,init);
+    }else if (props.algorithm==0){
         centroids=randomCentroids(dataset,props);
     }else{
         centroids=SGMA(dataset,props);
     }
 
     // Using the IRWLS algorithm
-    omp_set_num_threads(props.Threads);
-    double * W = IRWLSpar(dataset,centroids,props);
-    model modelo = calculateBudgetedModel(props, dataset,centroids, W);
-
-    // Decref the created python objects
-    Py_DECREF(arr1);
-    Py_DECREF(arr2);
+    W = IRWLSpar(dataset,centroids,props,init,NULL,NULL);
+    free(init);
+    modelo = calculateBudgetedModel(props, dataset,centroids, W);
+    omp_set_num_threads(previousThreads);
+    Py_END_ALLOW_THREADS
 
     // Creating the python object to save the trained model
     model *numero = (model *) malloc((1)*sizeof(model));
@@ -454,6 +519,9 @@ full_train (PyObject *dummy, PyObject *args, PyObject *kwds)
     //Pointers to store the dataset
     PyObject *arg1=NULL, *arr1=NULL, *arg2=NULL, *arr2=NULL;
 
+    //Trained model used as the starting point
+    PyObject *pyinit=NULL;
+
     //The properties struct used to train the algorithm
     properties props;
     props.Kgamma = 1.0;
@@ -464,14 +532,35 @@ full_train (PyObject *dummy, PyObject *args, PyObject *kwds)
     props.size=10;
     props.kernelType=1;
     props.verbose=1;
+    props.CacheSize=100.0;
+    props.Shrinking=1;
+    props.WorkingSetPolicy=0;
+    props.AdaptiveSize=0;
+    props.InitModel=NULL;
+    props.Checkpoint=NULL;
+    props.CheckpointInterval=10;
+    props.CheckpointSeconds=0.0;
+    props.Resume=NULL;
+    props.Deadline=0.0;
+    props.Multiclass=0;
+    props.CPath=NULL;
+    props.Folds=0;
+    props.FastExp=0;
+    props.Single=0;
+    props.CSR=0;
 
     //List of keyword parameters.
-    static char *kwlist[] = {"data","labels","gamma", "C", "threads", "workingSet", "eta", "kernel","verbose", NULL};
+    static char *kwlist[] = {"data","labels","gamma", "C", "threads", "workingSet", "eta", "kernel","verbose","cache","init", NULL};
 
     //It parses the parameters
-    if (!PyArg_ParseTupleAndKeywords(args,kwds, "OO|ddiidii",kwlist,&arg1,&arg2,&props.Kgamma,&props.C,&props.Threads,&props.MaxSize,&props.Eta,&props.kernelType,&props.verbose))
+    if (!PyArg_ParseTupleAndKeywords(args,kwds, "OO|ddiidiidO",kwlist,&arg1,&arg2,&props.Kgamma,&props.C,&props.Threads,&props.MaxSize,&props.Eta,&props.kernelType,&props.verbose,&props.CacheSize,&pyinit))
     return NULL;  
 
+    model *initModel = NULL;
+    if (pyinit != NULL && pyinit != Py_None){
+        if (!(initModel = (model*) PyCapsule_GetPointer(pyinit, "CLASSIFIER"))) return NULL;
+    }
+
     //Obtaining the numpy dataset
     arr1 = PyArray_FROM_OTF(arg1, NPY_DOUBLE, NPY_IN_ARRAY);
     if (arr1 == NULL)
@@ -484,16 +573,32 @@ full_train (PyObject *dummy, PyObject *args, PyObject *kwds)
     //Transforming the numpy dataset to our format.
     svm_dataset dataset = numpy2dataset(arr1, arr2);
 
-    //Using the IRWLS algorithm
-    initMemory(props.Threads,(props.MaxSize+1));  
-    setenv("VECLIB_MAXIMUM_THREADS", "1", 1);
-    double * W = trainFULL(dataset,props);
-    model modelo = calculateFULLModel(props, dataset, W);
-
     //Decref the created python objects
     Py_DECREF(arr1);
     Py_DECREF(arr2);
 
+    //Using the IRWLS algorithm, the training only uses C structures and runs without the GIL
+    double * init = NULL;
+    double * W;
+    model modelo;
+    int previousThreads;
+    Py_BEGIN_ALLOW_THREADS
+    previousThreads = omp_get_max_threads();
+    omp_set_num_threads(props.Threads);
+    if(linearEngine(props)==1){
+        // Linear kernel: primal solver and compact model
+        if (initModel != NULL) init = initialLinearWeights(dataset,initModel,props);
+        W = trainLinear(dataset,props,init,NULL);
+        modelo = calculateLinearModel(props, dataset, W);
+    }else{
+        if (initModel != NULL) init = initialFULLWeights(dataset,initModel,props);
+        W = trainFULL(dataset,props,init,NULL,NULL);
+        modelo = calculateFULLModel(props, dataset, W);
+    }
+    free(init);
+    omp_set_num_threads(previousThreads);
+    Py_END_ALLOW_THREADS
+
     //Creating the python object to save the trained model
     model *numero = (model *) malloc((1)*sizeof(model));
     if (NULL == numero)
@@ -518,6 +623,9 @@ initLIBIRWLS(void)
 {
      (void) Py_InitModule("LIBIRWLS", LIBIRWLSMethods);
      import_array();
+
+     // The environment is changed once at import, the solver threads must not change it
+     setenv("VECLIB_MAXIMUM_THREADS", "1", 1);
 }
 
 
@@ -16,10 +16,14 @@ ext_modules = [
             sources = ['pythonmodule.c'],
             extra_objects = ['../build/LIBIRWLS-predict.o',
                 '../build/full-train.o',
+                '../build/linear-train.o',
                 '../build/budgeted-train.o',
                 '../build/IOStructures.o',
                 '../build/ParallelAlgorithms.o',
-                '../build/kernels.o'
+                '../build/kernels.o',
+                '../build/simdKernels.o',
+                '../build/kernelCache.o',
+                '../build/checkpoint.o'
             ],
             library_dirs = [AtlasDir,"../build/"],
             extra_compile_args = ["-fPIC","-O3","-llapack", "-lf77blas", "-lcblas", "-latlas", "-lgfortran",'-fopenmp'],
@@ -30,10 +30,14 @@ ext_modules = [
             extra_objects = [libgompPath,
                 '../build/LIBIRWLS-predict.o',
                 '../build/full-train.o',
+                '../build/linear-train.o',
                 '../build/budgeted-train.o',
                 '../build/IOStructures.o',
                 '../build/ParallelAlgorithms.o',
-                '../build/kernels.o'
+                '../build/kernels.o',
+                '../build/simdKernels.o',
+                '../build/kernelCache.o',
+                '../build/checkpoint.o'
             ],
             library_dirs = [VecLibDir,"../build/"],
             extra_compile_args=['-Wno-cpp','-static','-lgomp','-lblas','-llapack'],
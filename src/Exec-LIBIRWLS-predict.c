@@ -42,6 +42,9 @@ int main(int argc, char** argv)
     }
   
     model  mymodel;
+    multiclassModel mymulticlass;
+    // The support vectors used to classify (the common support vectors of a multi-class model)
+    model *svs = &mymodel;
     
     // Reading the trained model from the file
     if(props.verbose==1) printf("\nReading trained model from file:%s\n",data_model);
@@ -50,9 +53,18 @@ int main(int argc, char** argv)
         fprintf(stderr, "Input file with the trained model not found: %s\n",data_model);
         exit(2);
     }
-    readModel(&mymodel, In);
+    int multiclass = isMulticlassModel(In);
+    if(multiclass==1){
+        readMulticlassModel(&mymulticlass, In);
+        svs = &mymulticlass.svs;
+        mymodel.deadline = mymulticlass.deadline;
+    }else{
+        readModel(&mymodel, In);
+    }
     fclose(In);
-    if(props.verbose==1) printf("Model Loaded, it contains %d Support Vectors\n\n",mymodel.nSVs);
+    if(props.verbose==1 && multiclass==1) printf("Multi-class model Loaded, it contains %d classes, %d binary classifiers and %d distinct Support Vectors\n\n",mymulticlass.nClasses,mymulticlass.nModels,svs->nSVs);
+    else if(props.verbose==1) printf("Model Loaded, it contains %d Support Vectors\n\n",mymodel.nSVs);
+    if(props.verbose==1 && mymodel.deadline==1) printf("The training of the model stopped on its deadline before the convergence\n\n");
 
 
     // Loading dataset
@@ -80,6 +92,19 @@ int main(int argc, char** argv)
         }
     }
     if(props.verbose==1) printf("Dataset Loaded, it contains %d samples and %d features\n\n", dataset.l,dataset.maxdim);
+
+    if(props.Single==1){
+        datasetToSingle(&dataset,dataset.l);
+        modelToSingle(svs);
+    }
+    if(props.CSR==1){
+        datasetToCSR(&dataset,dataset.l);
+        modelToCSR(svs);
+    }
+    if(dataset.sparse==0 && svs->sparse==0 && dataset.maxdim==svs->maxdim){
+        datasetToDense(&dataset,dataset.l);
+        modelToDense(svs);
+    }
     
     // Set the number of openmp threads
     omp_set_num_threads(props.Threads);
@@ -87,7 +112,10 @@ int main(int argc, char** argv)
     //Making predictions
     if(props.verbose==1) printf("Classifying data...\n");
     double *predictions;
-    if (props.Soft==0){
+    if (multiclass==1){
+        // The multi-class models always return the label of the class
+        predictions=multiclassTest(dataset,mymulticlass,props);
+    }else if (props.Soft==0){
         predictions=test(dataset,mymodel,props);
     }else{
         predictions=softTest(dataset,mymodel,props);
@@ -97,7 +125,8 @@ int main(int argc, char** argv)
     writeOutput (output_file, predictions,dataset.l);
 
     freeDataset(dataset);
-    freeModel(mymodel);
+    if(multiclass==1) freeMulticlassModel(mymulticlass);
+    else freeModel(mymodel);
     free(predictions);
     return 0;   
 }
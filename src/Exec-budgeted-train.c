@@ -48,6 +48,7 @@
 #include "budgeted-train.h"
 #include "kernels.h"
 #include "ParallelAlgorithms.h"
+#include "multiclass.h"
 
 
 /**
@@ -67,21 +68,24 @@ int main(int argc, char** argv)
 
     properties props = parseTrainParameters(&argc, &argv);
   
-    if (argc != 3) {
+    // The cross validation does not save a model
+    if (argc != 3 && !(props.Folds>0 && argc == 2)) {
         printBudgetedInstructions();
         return 4;
     }
 
     char * data_file = argv[1];
-    char * data_model = argv[2];
+    char * data_model = (argc == 3) ? argv[2] : NULL;
 
     if(props.verbose==1){
         printf("\nRunning with parameters:\n");
         printf("------------------------\n");
         printf("Training set: %s\n",data_file);
-        printf("The model will be saved in: %s\n",data_model);
+        if(props.Folds>0) printf("Cross validation with %d folds\n",props.Folds);
+        else printf("The model will be saved in: %s\n",data_model);
         printf("Cost c = %f\n",props.C);
         printf("Budget size = %d\n",props.size);
+        if(props.Deadline>0.0) printf("Deadline = %g seconds\n",props.Deadline);
 
         if(props.kernelType == 0){
             printf("Using linear kernel\n");
@@ -109,6 +113,46 @@ int main(int argc, char** argv)
     }
     if(props.verbose==1) printf("Dataset Loaded\n\nTraining samples: %d\nNumber of features: %d\n\n",dataset.l,dataset.maxdim);
 
+    // The training set also contains the average of every class.
+    if(props.Single==1) datasetToSingle(&dataset,dataset.l+2);
+    if(props.CSR==1) datasetToCSR(&dataset,dataset.l+2);
+    // Dense datasets are stored in an aligned matrix unless other layout has been selected.
+    datasetToDense(&dataset,dataset.l+2);
+
+    // The training sets with more than two classes are decomposed in binary problems
+    double *labels;
+    int nClasses = datasetClasses(dataset,&labels);
+    if(nClasses>2){
+        if(props.Folds>0 || props.InitModel != NULL){
+            fprintf(stderr, "The training sets with more than two classes can not be used with the cross validation or an initial model\n");
+            exit(2);
+        }
+
+        #ifdef OSX
+        setenv("VECLIB_MAXIMUM_THREADS", "1", 1);
+        #endif
+
+        struct timeval multiclass1, multiclass2;
+        omp_set_num_threads(props.Threads);
+        gettimeofday(&multiclass1, NULL);
+        multiclassModel multiclassModelo = trainMulticlass(dataset,labels,nClasses,props,1);
+        gettimeofday(&multiclass2, NULL);
+        if(props.verbose==1) printf("\nMulti-class model trained in %ld miliseconds\n\n",((multiclass2.tv_sec-multiclass1.tv_sec)*1000+(multiclass2.tv_usec-multiclass1.tv_usec)/1000));
+
+        if(props.verbose==1) printf("Saving model in file: %s\n\n",data_model);
+        FILE *Out = fopen(data_model, "wb");
+        if(Out == NULL || storeMulticlassModel(&multiclassModelo, Out) != 0 || fclose(Out) != 0){
+            fprintf(stderr, "Error: The model could not be written in %s\n",data_model);
+            exit(2);
+        }
+
+        freeMulticlassModel(multiclassModelo);
+        freeDataset(dataset);
+        free(labels);
+        return 0;
+    }
+    free(labels);
+
 
 
     #ifdef OSX    
@@ -120,14 +164,34 @@ int main(int argc, char** argv)
     
     omp_set_num_threads(props.Threads);
 
+    if(props.Folds>0){
+        crossValidationBudgeted(dataset,props);
+        freeDataset(dataset);
+        return 0;
+    }
+
     if(props.verbose==1) printf("Selecting centroids\n");
     gettimeofday(&tiempo1, NULL);
 
-    initMemory(props.Threads,props.size);
+    solverContext *context = initSolverContext(props.Threads,props.size);
 
     int * centroids;
+    double * init = NULL;
     
-    if (props.algorithm==0){
+    if (props.InitModel != NULL){
+        if(props.verbose==1) printf("Reading initial model from file:%s\n",props.InitModel);
+        FILE *InitIn = fopen(props.InitModel, "rb");
+        if (InitIn == NULL) {
+            fprintf(stderr, "Initial model file not found: %s\n",props.InitModel);
+            exit(2);
+        }
+        model initModel;
+        readModel(&initModel, InitIn);
+        fclose(InitIn);
+        init = (double *) calloc(props.size,sizeof(double));
+        centroids=modelCentroids(dataset,&initModel,props,init);
+        freeModel(initModel);
+    }else if (props.algorithm==0){
         centroids=randomCentroids(dataset,props);
     }else{
         centroids=SGMA(dataset,props);
@@ -138,14 +202,23 @@ int main(int argc, char** argv)
 	
     if(props.verbose==1) printf("\nCentroids Selected\n");
 
-    double * W = IRWLSpar(dataset,centroids,props);
+    // The selection of the centroids is part of the training time
+    if(props.Deadline>0.0){
+        gettimeofday(&tiempo2, NULL);
+        props.Deadline -= (tiempo2.tv_sec-tiempo1.tv_sec)+(tiempo2.tv_usec-tiempo1.tv_usec)/1e6;
+        if(props.Deadline<=0.0) props.Deadline=1e-9;
+    }
+
+    int deadline=0;
+    double * W = IRWLSpar(dataset,centroids,props,init,&deadline,context);
 
     gettimeofday(&tiempo2, NULL);
     if(props.verbose==1) printf("Weights calculated in %ld miliseconds\n\n",((tiempo2.tv_sec-tiempo1.tv_sec)*1000+(tiempo2.tv_usec-tiempo1.tv_usec)/1000));
 
     model modelo = calculateBudgetedModel(props, dataset,centroids, W);
+    modelo.deadline = deadline;
 	
-    freeMemory(props.Threads);
+    freeSolverContext(context);
 	
     if(props.verbose==1) printf("Saving model in file: %s\n\n",data_model);	
  
@@ -157,6 +230,7 @@ int main(int argc, char** argv)
     freeDataset(dataset);
     free(centroids);
     free(W);
+    free(init);
 
     return 0;
 }
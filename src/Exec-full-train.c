@@ -44,6 +44,8 @@
 
 #include "ParallelAlgorithms.h"
 #include "full-train.h"
+#include "linear-train.h"
+#include "multiclass.h"
 #include "kernels.h"
 
 
@@ -61,26 +63,38 @@ int main(int argc, char** argv)
 
     properties props = parseTrainFULLParameters(&argc, &argv);
   
-    if (argc != 3) {
+    // The cross validation does not save a model
+    if (argc != 3 && !(props.Folds>0 && argc == 2)) {
         printFULLInstructions();
         return 4;
     }
 
     
     char * data_file = argv[1];
-    char * data_model = argv[2];
+    char * data_model = (argc == 3) ? argv[2] : NULL;
 
     if(props.verbose==1){ 
         printf("\nRunning with parameters:\n");
         printf("------------------------\n");
         printf("Training set: %s\n",data_file);
-        printf("The model will be saved in: %s\n",data_model);
-        printf("Cost c = %f\n",props.C);
+        if(props.Folds>0) printf("Cross validation with %d folds\n",props.Folds);
+        else printf("The model will be saved in: %s\n",data_model);
+        if(props.CPath != NULL) printf("Costs c = %s\n",props.CPath);
+        else printf("Cost c = %f\n",props.C);
         printf("Working set size = %d\n",props.MaxSize);
+        if(props.AdaptiveSize==1) printf("The working set size is adapted during the training\n");
+        if(props.Checkpoint != NULL){
+            if(props.CheckpointSeconds>0.0) printf("Checkpoint every %g seconds in: %s\n",props.CheckpointSeconds,props.Checkpoint);
+            else printf("Checkpoint every %d iterations in: %s\n",props.CheckpointInterval,props.Checkpoint);
+        }
+        if(props.Resume != NULL) printf("Resuming the training from the checkpoint: %s\n",props.Resume);
         printf("Stop criteria = %f\n",props.Eta);
+        if(props.Deadline>0.0) printf("Deadline = %g seconds\n",props.Deadline);
+        printf("Kernel cache size = %f MB\n",props.CacheSize);
 
         if(props.kernelType == 0){
             printf("Using linear kernel\n");
+            if(linearEngine(props)==1) printf("The linear SVM is trained in the primal space\n");
         }else{
             printf("Using gaussian kernel with gamma = %f\n",props.Kgamma);
         }
@@ -105,6 +119,71 @@ int main(int argc, char** argv)
     }
     if(props.verbose==1) printf("Dataset Loaded\n\nTraining samples: %d\nNumber of features: %d\n\n",dataset.l,dataset.maxdim);
 
+    // The training set also contains the average of every class.
+    if(props.Single==1) datasetToSingle(&dataset,dataset.l+2);
+    if(props.CSR==1) datasetToCSR(&dataset,dataset.l+2);
+    // Dense datasets are stored in an aligned matrix unless other layout has been selected.
+    datasetToDense(&dataset,dataset.l+2);
+
+    // The training sets with more than two classes are decomposed in binary problems
+    double *labels;
+    int nClasses = datasetClasses(dataset,&labels);
+    if(nClasses>2){
+        if(props.Folds>0 || props.InitModel != NULL || props.CPath != NULL || props.Checkpoint != NULL || props.Resume != NULL){
+            fprintf(stderr, "The training sets with more than two classes can not be used with the cross validation, a list of costs, an initial model or the checkpoints\n");
+            exit(2);
+        }
+
+        #ifdef OSX
+        setenv("VECLIB_MAXIMUM_THREADS", "1", 1);
+        #endif
+
+        struct timeval multiclass1, multiclass2;
+        omp_set_num_threads(props.Threads);
+        gettimeofday(&multiclass1, NULL);
+        multiclassModel multiclassModelo = trainMulticlass(dataset,labels,nClasses,props,0);
+        gettimeofday(&multiclass2, NULL);
+        if(props.verbose==1) printf("\nMulti-class model trained in %ld miliseconds\n\n",((multiclass2.tv_sec-multiclass1.tv_sec)*1000+(multiclass2.tv_usec-multiclass1.tv_usec)/1000));
+
+        if(props.verbose==1) printf("Saving model in file: %s\n\n",data_model);
+        FILE *Out = fopen(data_model, "wb");
+        if(Out == NULL || storeMulticlassModel(&multiclassModelo, Out) != 0 || fclose(Out) != 0){
+            fprintf(stderr, "Error: The model could not be written in %s\n",data_model);
+            exit(2);
+        }
+
+        freeMulticlassModel(multiclassModelo);
+        freeDataset(dataset);
+        free(labels);
+        return 0;
+    }
+    free(labels);
+
+    // In the regularization path the initial model is used for the smallest cost
+    int nCosts=1;
+    double *costs = NULL;
+    if(props.CPath != NULL){
+        costs = parseCostList(props.CPath,&nCosts);
+        props.C = costs[0];
+    }
+
+    // Initial weights from a trained model
+    double *init = NULL;
+    if(props.InitModel != NULL){
+        if(props.verbose==1) printf("Reading initial model from file:%s\n",props.InitModel);
+        FILE *InitIn = fopen(props.InitModel, "rb");
+        if (InitIn == NULL) {
+            fprintf(stderr, "Initial model file not found: %s\n",props.InitModel);
+            exit(2);
+        }
+        model initModel;
+        readModel(&initModel, InitIn);
+        fclose(InitIn);
+        if(linearEngine(props)==1) init = initialLinearWeights(dataset,&initModel,props);
+        else init = initialFULLWeights(dataset,&initModel,props);
+        freeModel(initModel);
+    }
+
     #ifdef OSX    
     setenv("VECLIB_MAXIMUM_THREADS", "1", 1);
     #endif
@@ -115,14 +194,85 @@ int main(int argc, char** argv)
     if(props.verbose==1) printf("Running IRWLS\n");	
     gettimeofday(&tiempo1, NULL);
 
-    initMemory(props.Threads,(props.MaxSize+1));
-    double * W = trainFULL(dataset,props);
-    freeMemory(props.Threads);
+    if(props.Folds>0){
+        crossValidationFULL(dataset,props);
+        freeDataset(dataset);
+        free(init);
+        free(costs);
+        return 0;
+    }
+
+    if(props.CPath != NULL){
+
+        // Regularization path: the costs are trained in increasing order. Every training starts from the
+        // weights and the error of the previous one (they satisfy the box constraints of a larger cost)
+        // and the kernel cache is shared by all of them. The primal linear solver starts from the previous weights.
+        int linear = linearEngine(props);
+        kernelCache *cache = (linear==1) ? NULL : initKernelCache(dataset.l,props.CacheSize);
+        solverContext *context = (linear==1) ? NULL : initSolverContext(props.Threads,(props.MaxSize+1));
+        double *error = (double *) calloc(dataset.l,sizeof(double));
+        double *previous = init;
+        char *pathModel = (char *) malloc((strlen(data_model)+64)*sizeof(char));
+        int k;
+
+        for(k=0;k<nCosts;k++){
+            struct timeval point1, point2;
+            props.C = costs[k];
+            gettimeofday(&point1, NULL);
+            double * W;
+            if(linear==1) W = trainLinear(dataset,props,previous,NULL);
+            else W = trainFULLWarm(dataset,props,previous,(k>0) ? error : NULL,error,cache,NULL,context);
+            gettimeofday(&point2, NULL);
+            if(props.verbose==1) printf("\nCost %g trained in %ld miliseconds\n",props.C,((point2.tv_sec-point1.tv_sec)*1000+(point2.tv_usec-point1.tv_usec)/1000));
+
+            model modelo = (linear==1) ? calculateLinearModel(props, dataset, W) : calculateFULLModel(props, dataset, W);
+            sprintf(pathModel,"%s.c%g",data_model,props.C);
+            if(props.verbose==1) printf("Saving model in file: %s\n",pathModel);
+            FILE *Out = fopen(pathModel, "wb");
+            storeModel(&modelo, Out);
+            fclose(Out);
+            freeModel(modelo);
+
+            free(previous);
+            previous = W;
+        }
+
+        if(cache != NULL){
+            if(props.verbose==1){
+                printf("\nKernel cache: %d rows of %d, %lld hits, %lld misses (hit rate %.2f%%)\n",cache->nSlots,cache->capacity,cache->hits,cache->misses,100.0*cache->hits/(cache->hits+cache->misses));
+            }
+            freeKernelCache(cache);
+        }
+        if(context != NULL) freeSolverContext(context);
+
+        gettimeofday(&tiempo2, NULL);
+        if(props.verbose==1) printf("\nRegularization path of %d costs calculated in %ld miliseconds\n\n",nCosts,((tiempo2.tv_sec-tiempo1.tv_sec)*1000+(tiempo2.tv_usec-tiempo1.tv_usec)/1000));
+
+        free(previous);
+        free(error);
+        free(pathModel);
+        free(costs);
+        freeDataset(dataset);
+        return 0;
+    }
+
+    int deadline=0;
+    double * W;
+    model modelo;
+    if(linearEngine(props)==1){
+        W = trainLinear(dataset,props,init,&deadline);
+    }else{
+        solverContext *context = initSolverContext(props.Threads,(props.MaxSize+1));
+        W = trainFULL(dataset,props,init,&deadline,context);
+        freeSolverContext(context);
+    }
 
     gettimeofday(&tiempo2, NULL);
     if(props.verbose==1) printf("\nWeights calculated in %ld miliseconds\n\n",((tiempo2.tv_sec-tiempo1.tv_sec)*1000+(tiempo2.tv_usec-tiempo1.tv_usec)/1000));
 
-    model modelo = calculateFULLModel(props, dataset, W);
+    if(linearEngine(props)==1) modelo = calculateLinearModel(props, dataset, W);
+    else modelo = calculateFULLModel(props, dataset, W);
+    modelo.deadline = deadline;
 
     if(props.verbose==1) printf("Saving model in file: %s\n\n",data_model);	 
     FILE *Out = fopen(data_model, "wb");
@@ -132,6 +282,7 @@ int main(int argc, char** argv)
     freeModel(modelo);
     freeDataset(dataset);
     free(W);
+    free(init);
     return 0;
 }
 
@@ -0,0 +1,145 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+ 
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ 
+ ============================================================================
+ */
+
+/**
+ * @brief Main command to search the training parameters of a SVM on a grid of values.
+ *
+ * Every point of the grid is evaluated with k-fold cross validation using the full or the budgeted IRWLS procedure.
+ *
+ * @file Exec-grid-search.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @see grid-search.h
+ *
+ */
+
+#include <omp.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include "grid-search.h"
+#include "multiclass.h"
+
+
+
+/**
+ * @brief Is the main function to build the executable file to search the training parameters on a grid.
+ */
+
+
+int main(int argc, char** argv)
+{
+
+    srand(0);
+
+    gridProperties props = parseGridParameters(&argc, &argv);
+
+    if (argc != 2) {
+        printGridInstructions();
+        return 4;
+    }
+
+    char * data_file = argv[1];
+    int nPoints = props.nC*props.nGamma*props.nSize;
+
+    if(props.train.verbose==1){
+        printf("\nRunning with parameters:\n");
+        printf("------------------------\n");
+        printf("Training set: %s\n",data_file);
+        printf("Cross validation with %d folds\n",props.train.Folds);
+        printf("Grid of %d points\n",nPoints);
+        if(props.Budgeted==1){
+            printf("Budgeted solver using %s\n",(props.train.algorithm==0) ? "random selection" : "SGMA");
+        }else{
+            printf("Full solver with working set size = %d\n",props.train.MaxSize);
+            printf("Kernel cache size = %f MB\n",props.train.CacheSize);
+        }
+        printf("Stop criteria = %f\n",props.train.Eta);
+        if(props.train.kernelType == 0){
+            printf("Using linear kernel\n");
+        }else{
+            printf("Using gaussian kernel\n");
+        }
+        printf("------------------------\n");
+        printf("\n");
+    }
+
+    // Loading dataset
+    if(props.train.verbose==1) printf("\nReading dataset from file:%s\n",data_file);
+    FILE *In = fopen(data_file, "r+");
+    if (In == NULL) {
+        fprintf(stderr, "Input file with the training set not found: %s\n",data_file);
+        exit(2);
+    }
+    fclose(In);
+
+    svm_dataset dataset;
+
+    if(props.train.file==1){
+        dataset = readTrainFile(data_file);
+    }else{
+        dataset = readTrainFileCSV(data_file,props.train.separator);
+    }
+    if(props.train.verbose==1) printf("Dataset Loaded\n\nTraining samples: %d\nNumber of features: %d\n\n",dataset.l,dataset.maxdim);
+
+    // The training set also contains the average of every class.
+    if(props.train.Single==1) datasetToSingle(&dataset,dataset.l+2);
+    if(props.train.CSR==1) datasetToCSR(&dataset,dataset.l+2);
+    // Dense datasets are stored in an aligned matrix unless other layout has been selected.
+    datasetToDense(&dataset,dataset.l+2);
+
+    // The accuracy of every grid point is computed for binary problems.
+    double *labels;
+    if(datasetClasses(dataset,&labels)>2){
+        fprintf(stderr, "The grid search can not be used with training sets with more than two classes\n");
+        exit(2);
+    }
+    free(labels);
+
+    #ifdef OSX
+    setenv("VECLIB_MAXIMUM_THREADS", "1", 1);
+    #endif
+
+    struct timeval tiempo1, tiempo2;
+    omp_set_num_threads(props.train.Threads);
+
+    gettimeofday(&tiempo1, NULL);
+    gridPoint *points = gridSearch(dataset,props);
+    gettimeofday(&tiempo2, NULL);
+
+    printGridRanking(points,nPoints,props.Budgeted);
+    if(props.train.verbose==1) printf("Grid search calculated in %ld miliseconds\n\n",((tiempo2.tv_sec-tiempo1.tv_sec)*1000+(tiempo2.tv_usec-tiempo1.tv_usec)/1000));
+
+    free(points);
+    free(props.C);
+    free(props.Kgamma);
+    free(props.size);
+    freeDataset(dataset);
+    return 0;
+}
+
+/**
+ * @endcond
+ */
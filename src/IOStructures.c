@@ -43,6 +43,18 @@
  * @cond
  */
 
+/** @brief First bytes of the metadata trailer of a model file. */
+#define MODEL_METADATA_MAGIC "IRWLSMD"
+
+/** @brief Version of the metadata trailer of a model file. */
+#define MODEL_METADATA_VERSION 1
+
+/** @brief First bytes of a multi-class model file. */
+#define MULTICLASS_MODEL_MAGIC "IRWLSMC"
+
+/** @brief Version of the multi-class model file format. */
+#define MULTICLASS_MODEL_VERSION 1
+
 /**
  * @brief Free dataset memory
  *
@@ -55,6 +67,12 @@ void freeDataset (svm_dataset data){
     free(data.quadratic_value);	
     free(data.x);
     free(data.features);
+    free(data.xs);
+    free(data.featuresSingle);
+    free(data.rowPtr);
+    free(data.indexes);
+    free(data.values);
+    free(data.matrix);
 }
 
 /**
@@ -69,6 +87,657 @@ void freeModel (model modelo){
     free(modelo.quadratic_value);	
     free(modelo.x);
     free(modelo.features);
+    free(modelo.xs);
+    free(modelo.featuresSingle);
+    free(modelo.rowPtr);
+    free(modelo.indexes);
+    free(modelo.values);
+    free(modelo.matrix);
+}
+
+/**
+ * @brief It copies a list of samples into single precision.
+ *
+ * @param x The samples in double precision.
+ * @param n The number of samples.
+ * @param norms The squared norm of every sample, it is recalculated with the values in single precision.
+ * @param xs Pointer to store the array of samples in single precision.
+ * @param features Pointer to store the array of features in single precision.
+ */
+
+static void samplesToSingle(svm_sample **x, int n, double *norms, svm_sample_single ***xs, svm_sample_single **features){
+
+    int i, elements=0;
+    svm_sample *sample;
+
+    for(i=0;i<n;i++){
+        for(sample=x[i];sample->index != -1;++sample) ++elements;
+        ++elements;
+    }
+
+    *features = (svm_sample_single *) malloc(elements*sizeof(svm_sample_single));
+    *xs = (svm_sample_single **) malloc(n*sizeof(svm_sample_single *));
+
+    elements=0;
+    for(i=0;i<n;i++){
+        (*xs)[i] = &(*features)[elements];
+        norms[i] = 0.0;
+        for(sample=x[i];sample->index != -1;++sample){
+            (*features)[elements].index = sample->index;
+            (*features)[elements].value = (float) sample->value;
+            norms[i] += ((double) (*features)[elements].value)*((double) (*features)[elements].value);
+            ++elements;
+        }
+        (*features)[elements].index = -1;
+        (*features)[elements].value = 0.0f;
+        ++elements;
+    }
+}
+
+/**
+ * @brief It stores the features of a dataset in single precision.
+ *
+ * It copies the features of a dataset into an array of svm_sample_single and frees the
+ * double precision features, halving the memory of the features.
+ * @param dataset The dataset.
+ * @param samples The number of samples stored in the dataset (the training sets also contain the average of every class).
+ */
+
+void datasetToSingle(svm_dataset *dataset, int samples){
+    if(dataset->single==1 || dataset->csr==1 || dataset->dense==1) return;
+    samplesToSingle(dataset->x,samples,dataset->quadratic_value,&dataset->xs,&dataset->featuresSingle);
+    free(dataset->x);
+    free(dataset->features);
+    dataset->x=NULL;
+    dataset->features=NULL;
+    dataset->single=1;
+}
+
+/**
+ * @brief It stores the support vectors of a model in single precision.
+ *
+ * @param mymodel The model.
+ */
+
+void modelToSingle(model *mymodel){
+    if(mymodel->single==1 || mymodel->csr==1 || mymodel->dense==1) return;
+    samplesToSingle(mymodel->x,mymodel->nSVs,mymodel->quadratic_value,&mymodel->xs,&mymodel->featuresSingle);
+    free(mymodel->x);
+    free(mymodel->features);
+    mymodel->x=NULL;
+    mymodel->features=NULL;
+    mymodel->single=1;
+}
+
+/**
+ * @brief It copies a list of samples into CSR format.
+ *
+ * @param x The samples.
+ * @param n The number of samples.
+ * @param rowPtr Pointer to store the position of the first feature of every sample (n+1 elements).
+ * @param indexes Pointer to store the index of every feature.
+ * @param values Pointer to store the value of every feature.
+ */
+
+static void samplesToCSR(svm_sample **x, int n, int **rowPtr, unsigned int **indexes, double **values){
+
+    int i, elements=0;
+    svm_sample *sample;
+
+    for(i=0;i<n;i++){
+        for(sample=x[i];sample->index != -1;++sample) ++elements;
+    }
+
+    *rowPtr = (int *) malloc((n+1)*sizeof(int));
+    *indexes = (unsigned int *) malloc((elements>0 ? elements : 1)*sizeof(unsigned int));
+    *values = (double *) malloc((elements>0 ? elements : 1)*sizeof(double));
+
+    elements=0;
+    for(i=0;i<n;i++){
+        (*rowPtr)[i] = elements;
+        for(sample=x[i];sample->index != -1;++sample){
+            (*indexes)[elements] = (unsigned int) sample->index;
+            (*values)[elements] = sample->value;
+            ++elements;
+        }
+    }
+    (*rowPtr)[n] = elements;
+}
+
+/**
+ * @brief It stores the features of a dataset in CSR format.
+ *
+ * It copies the features of a dataset into the CSR arrays (rowPtr, indexes and values) and frees
+ * the array of svm_sample.
+ * @param dataset The dataset.
+ * @param samples The number of samples stored in the dataset (the training sets also contain the average of every class).
+ */
+
+void datasetToCSR(svm_dataset *dataset, int samples){
+    if(dataset->csr==1 || dataset->single==1 || dataset->dense==1) return;
+    samplesToCSR(dataset->x,samples,&dataset->rowPtr,&dataset->indexes,&dataset->values);
+    free(dataset->x);
+    free(dataset->features);
+    dataset->x=NULL;
+    dataset->features=NULL;
+    dataset->csr=1;
+}
+
+/**
+ * @brief It stores the support vectors of a model in CSR format.
+ *
+ * @param mymodel The model.
+ */
+
+void modelToCSR(model *mymodel){
+    if(mymodel->csr==1 || mymodel->single==1 || mymodel->dense==1) return;
+    samplesToCSR(mymodel->x,mymodel->nSVs,&mymodel->rowPtr,&mymodel->indexes,&mymodel->values);
+    free(mymodel->x);
+    free(mymodel->features);
+    mymodel->x=NULL;
+    mymodel->features=NULL;
+    mymodel->csr=1;
+}
+
+/**
+ * @brief It copies a list of dense samples into a dense matrix.
+ *
+ * @param x The samples, every one of them stores the features 1,...,dim.
+ * @param n The number of samples.
+ * @param dim The number of features.
+ * @param matrix Pointer to store the matrix aligned to 64 bytes.
+ * @param stride Pointer to store the distance between two rows.
+ */
+
+static void samplesToDense(svm_sample **x, int n, int dim, double **matrix, int *stride){
+
+    int i, k;
+    void *memory;
+
+    // Every row starts at a multiple of 64 bytes (the length of a cache line and of an AVX-512 register).
+    *stride = ((dim+7)/8)*8;
+    if(*stride==0) *stride=8;
+    if(posix_memalign(&memory,64,((size_t) n)*(*stride)*sizeof(double)) != 0){
+        fprintf(stderr, "Error: There is not enough memory to store the dense matrix\n");
+        exit(2);
+    }
+    *matrix = (double *) memory;
+
+    #pragma omp parallel for schedule(static) private(i,k)
+    for(i=0;i<n;i++){
+        double *row = &(*matrix)[((size_t) i)*(*stride)];
+        for(k=0;k<dim;k++) row[k]=x[i][k].value;
+        for(k=dim;k<*stride;k++) row[k]=0.0;
+    }
+}
+
+/**
+ * @brief It stores the features of a dense dataset in a dense matrix.
+ *
+ * It copies the features of a dense dataset into a row-major matrix aligned to 64 bytes whose rows
+ * are padded to a multiple of 64 bytes and frees the array of svm_sample. Sparse datasets are not changed.
+ * @param dataset The dataset.
+ * @param samples The number of samples stored in the dataset (the training sets also contain the average of every class).
+ */
+
+void datasetToDense(svm_dataset *dataset, int samples){
+    if(dataset->sparse==1 || dataset->dense==1 || dataset->single==1 || dataset->csr==1) return;
+    samplesToDense(dataset->x,samples,dataset->maxdim,&dataset->matrix,&dataset->stride);
+    free(dataset->x);
+    free(dataset->features);
+    dataset->x=NULL;
+    dataset->features=NULL;
+    dataset->dense=1;
+}
+
+/**
+ * @brief It stores the support vectors of a dense model in a dense matrix.
+ *
+ * @param mymodel The model.
+ */
+
+void modelToDense(model *mymodel){
+    if(mymodel->sparse==1 || mymodel->dense==1 || mymodel->single==1 || mymodel->csr==1) return;
+    samplesToDense(mymodel->x,mymodel->nSVs,mymodel->maxdim,&mymodel->matrix,&mymodel->stride);
+    free(mymodel->x);
+    free(mymodel->features);
+    mymodel->x=NULL;
+    mymodel->features=NULL;
+    mymodel->dense=1;
+}
+
+/**
+ * @brief Number of features of a sample of a dataset.
+ *
+ * @param dataset The dataset.
+ * @param index The index of the sample.
+ * @return The number of features of the sample (without the final -1 index).
+ */
+
+int sampleLength(svm_dataset dataset, int index){
+    int length=0;
+    if(dataset.dense==1){
+        length=dataset.maxdim;
+    }else if(dataset.csr==1){
+        length=dataset.rowPtr[index+1]-dataset.rowPtr[index];
+    }else if(dataset.single==1){
+        svm_sample_single *sample;
+        for(sample=dataset.xs[index];sample->index != -1;++sample) ++length;
+    }else{
+        svm_sample *sample;
+        for(sample=dataset.x[index];sample->index != -1;++sample) ++length;
+    }
+    return length;
+}
+
+/**
+ * @brief It copies a sample of a dataset.
+ *
+ * It copies the features of a sample (including the final -1 index) into an array in double precision.
+ * @param dataset The dataset.
+ * @param index The index of the sample.
+ * @param result The array of sampleLength()+1 elements where the sample is copied.
+ */
+
+void copySample(svm_dataset dataset, int index, svm_sample *result){
+    if(dataset.dense==1){
+        int k;
+        double *row = &dataset.matrix[((size_t) index)*dataset.stride];
+        for(k=0;k<dataset.maxdim;++k,++result){
+            result->index = k+1;
+            result->value = row[k];
+        }
+    }else if(dataset.csr==1){
+        int k;
+        for(k=dataset.rowPtr[index];k<dataset.rowPtr[index+1];++k,++result){
+            result->index = (int) dataset.indexes[k];
+            result->value = dataset.values[k];
+        }
+    }else if(dataset.single==1){
+        svm_sample_single *sample;
+        for(sample=dataset.xs[index];sample->index != -1;++sample,++result){
+            result->index = sample->index;
+            result->value = (double) sample->value;
+        }
+    }else{
+        svm_sample *sample;
+        for(sample=dataset.x[index];sample->index != -1;++sample,++result){
+            result->index = sample->index;
+            result->value = sample->value;
+        }
+    }
+    result->index = -1;
+}
+
+/**
+ * @brief Hash of the features of a sample distinct than zero.
+ */
+
+static unsigned long long hashSample(svm_sample *sample){
+    unsigned long long hash=14695981039346656037ULL, bits;
+    for(;sample->index != -1;++sample){
+        if(sample->value == 0.0) continue;
+        memcpy(&bits,&sample->value,sizeof(double));
+        hash=(hash^((unsigned long long) sample->index))*1099511628211ULL;
+        hash=(hash^bits)*1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief It compares the features of two samples distinct than zero.
+ */
+
+static int sameSample(svm_sample *a, svm_sample *b){
+    while(1){
+        while(a->index != -1 && a->value == 0.0) ++a;
+        while(b->index != -1 && b->value == 0.0) ++b;
+        if(a->index == -1 || b->index == -1) return (a->index == b->index);
+        if(a->index != b->index || a->value != b->value) return 0;
+        ++a;
+        ++b;
+    }
+}
+
+/**
+ * @brief It finds the support vectors of a model in a dataset.
+ *
+ * Every support vector is matched with a sample of the dataset that has the same features. The features with
+ * value zero are ignored, so the layouts of the dataset and the model do not need to be the same. Every sample
+ * of the dataset is matched at most once.
+ * @param dataset The dataset.
+ * @param mymodel The model (svm_sample layout, as it is loaded by readModel).
+ * @return An array with the index of the sample of every support vector (-1 if it is not in the dataset).
+ */
+
+int *matchSupportVectors(svm_dataset dataset, model *mymodel){
+    int i, k;
+    int *match = (int *) malloc(mymodel->nSVs*sizeof(int));
+    for(i=0;i<mymodel->nSVs;i++) match[i]=-1;
+    if(mymodel->nSVs==0) return match;
+
+    // Open addressing hash table with the support vectors
+    int tableSize=1;
+    while(tableSize<2*mymodel->nSVs) tableSize*=2;
+    int *table = (int *) malloc(tableSize*sizeof(int));
+    for(k=0;k<tableSize;k++) table[k]=-1;
+    for(i=0;i<mymodel->nSVs;i++){
+        k=(int) (hashSample(mymodel->x[i]) & (tableSize-1));
+        while(table[k] != -1) k=(k+1) & (tableSize-1);
+        table[k]=i;
+    }
+
+    int length=dataset.maxdim+2;
+    svm_sample *sample = (svm_sample *) malloc(length*sizeof(svm_sample));
+    for(i=0;i<dataset.l;i++){
+        if(sampleLength(dataset,i)+1>length){
+            length=sampleLength(dataset,i)+1;
+            sample = (svm_sample *) realloc(sample,length*sizeof(svm_sample));
+        }
+        copySample(dataset,i,sample);
+        // The first support vector with the same features that has not been matched yet
+        for(k=(int) (hashSample(sample) & (tableSize-1));table[k] != -1;k=(k+1) & (tableSize-1)){
+            if(match[table[k]] == -1 && sameSample(sample,mymodel->x[table[k]])){
+                match[table[k]]=i;
+                break;
+            }
+        }
+    }
+
+    free(sample);
+    free(table);
+    return match;
+}
+
+/**
+ * @brief It creates a dataset with a subset of the samples of other dataset.
+ *
+ * The subset shares the features of the original dataset when they are stored as arrays of samples (x and xs)
+ * and copies them in the CSR and dense layouts, where the rows must be contiguous. The labels and the norms
+ * are copied, so they are not calculated again. The average of every class of the original dataset is also
+ * copied after the last sample. The subset can be released with freeDataset.
+ * @param dataset The original dataset.
+ * @param indexes The indexes of the samples of the subset.
+ * @param n The number of samples of the subset.
+ * @return The subset.
+ */
+
+svm_dataset subsetDataset(svm_dataset dataset, int *indexes, int n){
+    svm_dataset subset = dataset;
+    int samples=n+2, i;
+
+    subset.l = n;
+    subset.y = (double *) malloc(samples*sizeof(double));
+    subset.quadratic_value = (double *) malloc(samples*sizeof(double));
+    subset.x = NULL;
+    subset.features = NULL;
+    subset.xs = NULL;
+    subset.featuresSingle = NULL;
+    subset.rowPtr = NULL;
+    subset.indexes = NULL;
+    subset.values = NULL;
+    subset.matrix = NULL;
+
+    // The sample i of the subset (the last two are the average of every class)
+    int *source = (int *) malloc(samples*sizeof(int));
+    for(i=0;i<n;i++) source[i]=indexes[i];
+    source[n]=dataset.l;
+    source[n+1]=dataset.l+1;
+
+    for(i=0;i<samples;i++){
+        subset.y[i]=dataset.y[source[i]];
+        subset.quadratic_value[i]=dataset.quadratic_value[source[i]];
+    }
+
+    if(dataset.dense==1){
+        void *memory;
+        if(posix_memalign(&memory,64,((size_t) samples)*dataset.stride*sizeof(double)) != 0){
+            fprintf(stderr, "Error: There is not enough memory to store the dense matrix\n");
+            exit(2);
+        }
+        subset.matrix = (double *) memory;
+        #pragma omp parallel for schedule(static) private(i)
+        for(i=0;i<samples;i++){
+            memcpy(&subset.matrix[((size_t) i)*dataset.stride],&dataset.matrix[((size_t) source[i])*dataset.stride],dataset.stride*sizeof(double));
+        }
+    }else if(dataset.csr==1){
+        subset.rowPtr = (int *) malloc((samples+1)*sizeof(int));
+        int elements=0;
+        for(i=0;i<samples;i++){
+            subset.rowPtr[i]=elements;
+            elements+=dataset.rowPtr[source[i]+1]-dataset.rowPtr[source[i]];
+        }
+        subset.rowPtr[samples]=elements;
+        subset.indexes = (unsigned int *) malloc((elements>0 ? elements : 1)*sizeof(unsigned int));
+        subset.values = (double *) malloc((elements>0 ? elements : 1)*sizeof(double));
+        #pragma omp parallel for schedule(static) private(i)
+        for(i=0;i<samples;i++){
+            int length=subset.rowPtr[i+1]-subset.rowPtr[i];
+            memcpy(&subset.indexes[subset.rowPtr[i]],&dataset.indexes[dataset.rowPtr[source[i]]],length*sizeof(unsigned int));
+            memcpy(&subset.values[subset.rowPtr[i]],&dataset.values[dataset.rowPtr[source[i]]],length*sizeof(double));
+        }
+    }else if(dataset.single==1){
+        subset.xs = (svm_sample_single **) malloc(samples*sizeof(svm_sample_single *));
+        for(i=0;i<samples;i++) subset.xs[i]=dataset.xs[source[i]];
+    }else{
+        subset.x = (svm_sample **) malloc(samples*sizeof(svm_sample *));
+        for(i=0;i<samples;i++) subset.x[i]=dataset.x[source[i]];
+    }
+
+    free(source);
+    return subset;
+}
+
+/**
+ * @brief It calculates the average of every class of a subset.
+ *
+ * The averages of the positive and the negative samples of the subset replace the samples l and l+1,
+ * the averages of a dense dataset also store the features whose value is zero.
+ * @param subset A subset created with subsetDataset.
+ */
+
+void subsetClassAverages(svm_dataset *subset){
+    int l=subset->l, dim=subset->maxdim+1;
+    int i, k, c, j=0;
+    double *sum = (double *) calloc(2*dim,sizeof(double));
+    double count[2]={0.0,0.0};
+    double norms[2]={0.0,0.0};
+
+    int length=dim+1;
+    svm_sample *sample = (svm_sample *) malloc(length*sizeof(svm_sample));
+    for(i=0;i<l;i++){
+        if(sampleLength(*subset,i)+1>length){
+            length=sampleLength(*subset,i)+1;
+            sample = (svm_sample *) realloc(sample,length*sizeof(svm_sample));
+        }
+        c=(subset->y[i]==1.0) ? 0 : 1;
+        copySample(*subset,i,sample);
+        for(k=0;sample[k].index != -1;k++) sum[c*dim+sample[k].index]+=sample[k].value;
+        count[c]+=1.0;
+    }
+    free(sample);
+
+    svm_sample *averages = (svm_sample *) malloc(2*(dim+1)*sizeof(svm_sample));
+    svm_sample *x[2];
+    for(c=0;c<2;c++){
+        x[c]=&averages[j];
+        for(k=0;k<dim;k++){
+            double value=(count[c]>0.0) ? sum[c*dim+k]/count[c] : 0.0;
+            if(value != 0.0 || (subset->sparse==0 && k>0)){
+                averages[j].index=k;
+                averages[j].value=value;
+                norms[c]+=value*value;
+                ++j;
+            }
+        }
+        averages[j].index=-1;
+        averages[j].value=0.0;
+        ++j;
+    }
+    free(sum);
+
+    subset->y[l]=1.0;
+    subset->y[l+1]=-1.0;
+
+    if(subset->dense==1){
+        for(c=0;c<2;c++){
+            double *row=&subset->matrix[((size_t) (l+c))*subset->stride];
+            memset(row,0,subset->stride*sizeof(double));
+            for(k=0;x[c][k].index != -1;k++) row[x[c][k].index-1]=x[c][k].value;
+        }
+        free(averages);
+    }else if(subset->csr==1){
+        int elements=subset->rowPtr[l]+(j-2);
+        subset->indexes = (unsigned int *) realloc(subset->indexes,(elements>0 ? elements : 1)*sizeof(unsigned int));
+        subset->values = (double *) realloc(subset->values,(elements>0 ? elements : 1)*sizeof(double));
+        elements=subset->rowPtr[l];
+        for(c=0;c<2;c++){
+            for(k=0;x[c][k].index != -1;k++){
+                subset->indexes[elements]=(unsigned int) x[c][k].index;
+                subset->values[elements]=x[c][k].value;
+                ++elements;
+            }
+            subset->rowPtr[l+c+1]=elements;
+        }
+        free(averages);
+    }else if(subset->single==1){
+        svm_sample_single **xs;
+        svm_sample_single *features;
+        samplesToSingle(x,2,norms,&xs,&features);
+        subset->xs[l]=xs[0];
+        subset->xs[l+1]=xs[1];
+        free(subset->featuresSingle);
+        subset->featuresSingle=features;
+        free(xs);
+        free(averages);
+    }else{
+        // The averages are the only features owned by the subset
+        subset->x[l]=x[0];
+        subset->x[l+1]=x[1];
+        free(subset->features);
+        subset->features=averages;
+    }
+
+    subset->quadratic_value[l]=norms[0];
+    subset->quadratic_value[l+1]=norms[1];
+}
+
+/**
+ * @brief Random assignment of the samples of a dataset to the folds of a cross validation.
+ *
+ * @param l The number of samples.
+ * @param folds The number of folds.
+ * @return The fold of every sample, every fold has l/folds samples (rounded up or down).
+ */
+
+int *crossValidationFolds(int l, int folds){
+    int *fold = (int *) malloc(l*sizeof(int));
+    int *permut = (int *) malloc(l*sizeof(int));
+    int i;
+
+    for(i=0;i<l;i++) permut[i]=i;
+    for(i=l-1;i>0;i--){
+        int j=rand()%(i+1);
+        int temp=permut[i];
+        permut[i]=permut[j];
+        permut[j]=temp;
+    }
+    for(i=0;i<l;i++) fold[permut[i]]=i%folds;
+
+    free(permut);
+    return fold;
+}
+
+/**
+ * @brief It merges the binary classifiers of a multi-class model.
+ *
+ * The distinct support vectors are found with a hash table of their features.
+ * @param mymodel The multi-class model with the classes and the binary problems, the rest of the fields are filled.
+ * @param models The binary classifier of every binary problem (svm_sample layout).
+ */
+
+void mergeModels(multiclassModel *mymodel, model *models){
+    int nModels=mymodel->nModels;
+    int total=0, nDistinct=0, nElem=0, position=0;
+    int i, k, h, length;
+
+    for(k=0;k<nModels;k++) total+=models[k].nSVs;
+
+    mymodel->bias = (double *) malloc(nModels*sizeof(double));
+    mymodel->start = (int *) malloc((nModels+1)*sizeof(int));
+    mymodel->svIndex = (int *) malloc((total>0 ? total : 1)*sizeof(int));
+    mymodel->weights = (double *) malloc((total>0 ? total : 1)*sizeof(double));
+    mymodel->deadline = 0;
+
+    // Open addressing hash table with the distinct support vectors
+    int tableSize=1;
+    while(tableSize<2*total) tableSize*=2;
+    int *table = (int *) malloc(tableSize*sizeof(int));
+    for(h=0;h<tableSize;h++) table[h]=-1;
+    svm_sample **distinct = (svm_sample **) malloc((total>0 ? total : 1)*sizeof(svm_sample *));
+    double *norms = (double *) malloc((total>0 ? total : 1)*sizeof(double));
+
+    model *svs=&mymodel->svs;
+    svs->Kgamma=models[0].Kgamma;
+    svs->kernelType=models[0].kernelType;
+    svs->sparse=models[0].sparse;
+    svs->maxdim=0;
+
+    for(k=0;k<nModels;k++){
+        mymodel->start[k]=position;
+        mymodel->bias[k]=models[k].bias;
+        if(models[k].deadline==1) mymodel->deadline=1;
+        if(models[k].maxdim>svs->maxdim) svs->maxdim=models[k].maxdim;
+        if(models[k].sparse==1) svs->sparse=1;
+        for(i=0;i<models[k].nSVs;i++){
+            h=(int) (hashSample(models[k].x[i]) & (tableSize-1));
+            while(table[h] != -1 && !sameSample(distinct[table[h]],models[k].x[i])) h=(h+1) & (tableSize-1);
+            if(table[h] == -1){
+                table[h]=nDistinct;
+                distinct[nDistinct]=models[k].x[i];
+                norms[nDistinct]=models[k].quadratic_value[i];
+                for(length=0;models[k].x[i][length].index != -1;length++);
+                nElem+=length+1;
+                nDistinct++;
+            }
+            mymodel->svIndex[position]=table[h];
+            mymodel->weights[position]=models[k].weights[i];
+            position++;
+        }
+    }
+    mymodel->start[nModels]=position;
+
+    svs->bias=0.0;
+    svs->deadline=0;
+    svs->nSVs=nDistinct;
+    svs->nElem=nElem;
+    svs->single=0;
+    svs->xs=NULL;
+    svs->featuresSingle=NULL;
+    svs->csr=0;
+    svs->rowPtr=NULL;
+    svs->indexes=NULL;
+    svs->values=NULL;
+    svs->dense=0;
+    svs->matrix=NULL;
+    svs->stride=0;
+    svs->weights = (double *) calloc((nDistinct>0 ? nDistinct : 1),sizeof(double));
+    svs->quadratic_value = (double *) malloc((nDistinct>0 ? nDistinct : 1)*sizeof(double));
+    svs->x = (svm_sample **) malloc((nDistinct>0 ? nDistinct : 1)*sizeof(svm_sample *));
+    svs->features = (svm_sample *) malloc((nElem>0 ? nElem : 1)*sizeof(svm_sample));
+
+    nElem=0;
+    for(i=0;i<nDistinct;i++){
+        svs->quadratic_value[i]=norms[i];
+        svs->x[i]=&svs->features[nElem];
+        for(length=0;distinct[i][length].index != -1;length++);
+        memcpy(svs->x[i],distinct[i],(length+1)*sizeof(svm_sample));
+        nElem+=length+1;
+    }
+
+    free(table);
+    free(distinct);
+    free(norms);
 }
 
 /**
@@ -148,6 +817,16 @@ svm_dataset readTrainFile(char filename[]){
     dataset.x = (svm_sample **) calloc(dataset.l+2,sizeof(svm_sample *));
     dataset.features = (svm_sample *) calloc(elements,sizeof(svm_sample));
     dataset.maxdim=0;
+    dataset.single=0;
+    dataset.xs=NULL;
+    dataset.featuresSingle=NULL;
+    dataset.csr=0;
+    dataset.rowPtr=NULL;
+    dataset.indexes=NULL;
+    dataset.values=NULL;
+    dataset.dense=0;
+    dataset.matrix=NULL;
+    dataset.stride=0;
 
     int max_index = 0;
     int i=0;
@@ -232,13 +911,17 @@ svm_dataset readTrainFile(char filename[]){
 
         dataset.features[j++].index = -1;
 
+        // A sample with less features than the first one.
+        if(dataset.features[dm].index != -1) dataset.sparse=1;
+
 
     }
 
+    // The averages of a dense dataset also store the features whose value is zero.
     dataset.y[dataset.l]=1.0;
     dataset.x[dataset.l] = &dataset.features[j];
     for (i=0;i<=maxindexDS;i++){
-        if (meanPositives[i] != 0.0){
+        if (meanPositives[i] != 0.0 || (dataset.sparse==0 && i>0)){
             dataset.features[j].index = i;
             dataset.features[j].value = meanPositives[i]/sumPositives;
             dataset.quadratic_value[dataset.l] += pow(meanPositives[i]/sumPositives,2);
@@ -253,10 +936,10 @@ svm_dataset readTrainFile(char filename[]){
     dataset.y[dataset.l+1]=-1.0;
     dataset.x[dataset.l+1] = &dataset.features[j];
     for (i=0;i<=maxindexDS;i++){
-        if (meanNegatives[i] != 0.0){
+        if (meanNegatives[i] != 0.0 || (dataset.sparse==0 && i>0)){
             dataset.features[j].index = i;
             dataset.features[j].value = meanNegatives[i]/sumNegatives;
-            dataset.quadratic_value[dataset.l+1] += pow(meanNegatives[i]/sumPositives,2);
+            dataset.quadratic_value[dataset.l+1] += pow(meanNegatives[i]/sumNegatives,2);
             ++j;
         }
     }
@@ -265,6 +948,11 @@ svm_dataset readTrainFile(char filename[]){
     ++j;
 
     dataset.maxdim=max_index;
+
+    // Dense datasets must contain the features 1,...,maxdim of every sample.
+    for(i=0;dataset.sparse==0 && dataset.l>0 && i<max_index;i++){
+        if(dataset.features[i].index != i+1) dataset.sparse=1;
+    }
     fclose(file);
 
     free(meanPositives);
@@ -359,6 +1047,16 @@ svm_dataset readTrainFileCSV(char filename[],char* separator){
     dataset.x = (svm_sample **) calloc(dataset.l+2,sizeof(svm_sample *));
     dataset.features = (svm_sample *) calloc(elements,sizeof(svm_sample));
     dataset.maxdim=0;
+    dataset.single=0;
+    dataset.xs=NULL;
+    dataset.featuresSingle=NULL;
+    dataset.csr=0;
+    dataset.rowPtr=NULL;
+    dataset.indexes=NULL;
+    dataset.values=NULL;
+    dataset.dense=0;
+    dataset.matrix=NULL;
+    dataset.stride=0;
 
     int max_index = 0;
     int i=0;
@@ -450,13 +1148,17 @@ svm_dataset readTrainFileCSV(char filename[],char* separator){
 
         dataset.features[j++].index = -1;
 
+        // A sample with less features than the first one.
+        if(dataset.features[dm].index != -1) dataset.sparse=1;
+
 
     }
 
+    // The averages of a dense dataset also store the features whose value is zero.
     dataset.y[dataset.l]=1.0;
     dataset.x[dataset.l] = &dataset.features[j];
     for (i=0;i<=maxindexDS;i++){
-        if (meanPositives[i] != 0.0){
+        if (meanPositives[i] != 0.0 || (dataset.sparse==0 && i>0)){
             dataset.features[j].index = i;
             dataset.features[j].value = meanPositives[i]/sumPositives;
             dataset.quadratic_value[dataset.l] += pow(meanPositives[i]/sumPositives,2);
@@ -471,10 +1173,10 @@ svm_dataset readTrainFileCSV(char filename[],char* separator){
     dataset.y[dataset.l+1]=-1.0;
     dataset.x[dataset.l+1] = &dataset.features[j];
     for (i=0;i<=maxindexDS;i++){
-        if (meanNegatives[i] != 0.0){
+        if (meanNegatives[i] != 0.0 || (dataset.sparse==0 && i>0)){
             dataset.features[j].index = i;
             dataset.features[j].value = meanNegatives[i]/sumNegatives;
-            dataset.quadratic_value[dataset.l+1] += pow(meanNegatives[i]/sumPositives,2);
+            dataset.quadratic_value[dataset.l+1] += pow(meanNegatives[i]/sumNegatives,2);
             ++j;
         }
     }
@@ -483,6 +1185,11 @@ svm_dataset readTrainFileCSV(char filename[],char* separator){
     ++j;
 
     dataset.maxdim=max_index;
+
+    // Dense datasets must contain the features 1,...,maxdim of every sample.
+    for(i=0;dataset.sparse==0 && dataset.l>0 && i<max_index;i++){
+        if(dataset.features[i].index != i+1) dataset.sparse=1;
+    }
     fclose(file);
 
     free(meanPositives);
@@ -551,6 +1258,16 @@ svm_dataset readUnlabeledFile(char filename[]){
     dataset.x = (svm_sample **) calloc(dataset.l,sizeof(svm_sample *));
     dataset.features = (svm_sample *) calloc(elements,sizeof(svm_sample));
     dataset.maxdim=0;
+    dataset.single=0;
+    dataset.xs=NULL;
+    dataset.featuresSingle=NULL;
+    dataset.csr=0;
+    dataset.rowPtr=NULL;
+    dataset.indexes=NULL;
+    dataset.values=NULL;
+    dataset.dense=0;
+    dataset.matrix=NULL;
+    dataset.stride=0;
 
     int max_index = 0;
     int i=0;
@@ -616,9 +1333,17 @@ svm_dataset readUnlabeledFile(char filename[]){
 
         dataset.features[j++].index = -1;
 
+        // A sample with less features than the first one.
+        if(dataset.features[dm].index != -1) dataset.sparse=1;
+
     }
 
     dataset.maxdim=max_index;
+
+    // Dense datasets must contain the features 1,...,maxdim of every sample.
+    for(i=0;dataset.sparse==0 && dataset.l>0 && i<max_index;i++){
+        if(dataset.features[i].index != i+1) dataset.sparse=1;
+    }
     fclose(file);
     return dataset;
 
@@ -689,6 +1414,16 @@ svm_dataset readUnlabeledFileCSV(char filename[],char* separator){
     dataset.x = (svm_sample **) calloc(dataset.l,sizeof(svm_sample *));
     dataset.features = (svm_sample *) calloc(elements,sizeof(svm_sample));
     dataset.maxdim=0;
+    dataset.single=0;
+    dataset.xs=NULL;
+    dataset.featuresSingle=NULL;
+    dataset.csr=0;
+    dataset.rowPtr=NULL;
+    dataset.indexes=NULL;
+    dataset.values=NULL;
+    dataset.dense=0;
+    dataset.matrix=NULL;
+    dataset.stride=0;
 
     int max_index = 0;
     int i=0;
@@ -742,6 +1477,8 @@ svm_dataset readUnlabeledFileCSV(char filename[],char* separator){
                     exit(2);
                 }
                 ++j;
+            }else{
+                dataset.sparse=1;
             }
             val = strtok(NULL,separator);
 
@@ -753,9 +1490,17 @@ svm_dataset readUnlabeledFileCSV(char filename[],char* separator){
 
         dataset.features[j++].index = -1;
 
+        // A sample with a different number of features than the previous one.
+        if(i>0 && (dataset.x[i]-dataset.x[i-1]) != (&dataset.features[j]-dataset.x[i])) dataset.sparse=1;
+
     }
 
     dataset.maxdim=max_index;
+
+    // Dense datasets must contain the features 1,...,maxdim of every sample.
+    for(i=0;dataset.sparse==0 && dataset.l>0 && i<max_index;i++){
+        if(dataset.features[i].index != i+1) dataset.sparse=1;
+    }
     fclose(file);
     return dataset;
 
@@ -773,7 +1518,7 @@ svm_dataset readUnlabeledFileCSV(char filename[],char* separator){
 void storeModel(model * mod, FILE *Output){
 
     //This procedures write in the file every element of the model struct.
-    int aux;
+    int aux, i;
     aux=fwrite(&mod->Kgamma, sizeof(double), 1, Output);    
     aux=fwrite(&mod->bias, sizeof(double), 1, Output);
     aux=fwrite(&mod->maxdim, sizeof(int), 1, Output);
@@ -783,7 +1528,35 @@ void storeModel(model * mod, FILE *Output){
     aux=fwrite(&mod->nElem, sizeof(int), 1, Output);
 	aux=fwrite(mod->weights, sizeof(double), mod->nSVs, Output);
     aux=fwrite(mod->quadratic_value, (mod->nSVs)*sizeof(double), 1, Output);
-    aux=fwrite(mod->x[0], (mod->nElem)*sizeof(svm_sample), 1, Output);
+    if(mod->single==0 && mod->csr==0 && mod->dense==0){
+        aux=fwrite(mod->x[0], (mod->nElem)*sizeof(svm_sample), 1, Output);
+    }else{
+        // The support vectors are converted to the svm_sample layout so the file format does not change.
+        svm_dataset view;
+        view.l=mod->nSVs;
+        view.single=mod->single;
+        view.xs=mod->xs;
+        view.csr=mod->csr;
+        view.rowPtr=mod->rowPtr;
+        view.indexes=mod->indexes;
+        view.values=mod->values;
+        view.dense=mod->dense;
+        view.matrix=mod->matrix;
+        view.stride=mod->stride;
+        view.maxdim=mod->maxdim;
+        svm_sample *sample = (svm_sample *) malloc((mod->maxdim+2)*sizeof(svm_sample));
+        for(i=0;i<mod->nSVs;i++){
+            copySample(view,i,sample);
+            aux=fwrite(sample, (sampleLength(view,i)+1)*sizeof(svm_sample), 1, Output);
+        }
+        free(sample);
+    }
+
+    // Metadata trailer, the models stored before it was added end after the features
+    int version = MODEL_METADATA_VERSION;
+    aux=fwrite(MODEL_METADATA_MAGIC, sizeof(char), 8, Output);
+    aux=fwrite(&version, sizeof(int), 1, Output);
+    aux=fwrite(&mod->deadline, sizeof(int), 1, Output);
     fflush(Output);
 }
 
@@ -810,6 +1583,16 @@ void readModel(model * mod, FILE *Input){
     mod->quadratic_value = (double *)malloc((mod->nSVs)*sizeof(double));
     aux=fread(mod->weights, sizeof(double), mod->nSVs, Input);	
     aux=fread(mod->quadratic_value, (mod->nSVs)*sizeof(double), 1, Input); 
+    mod->single = 0;
+    mod->xs = NULL;
+    mod->featuresSingle = NULL;
+    mod->csr = 0;
+    mod->rowPtr = NULL;
+    mod->indexes = NULL;
+    mod->values = NULL;
+    mod->dense = 0;
+    mod->matrix = NULL;
+    mod->stride = 0;
     mod->x = (svm_sample **)malloc((mod->nSVs)*sizeof(svm_sample *));    
     mod->features = (svm_sample *) calloc((mod->nElem),sizeof(svm_sample));    
     aux=fread(mod->features, (mod->nElem)*sizeof(svm_sample), 1, Input);
@@ -822,6 +1605,117 @@ void readModel(model * mod, FILE *Input){
             ++iterSV;
         }
     }
+
+    // Metadata trailer (it does not exist in old model files)
+    char magic[8];
+    int version;
+    mod->deadline = 0;
+    if(fread(magic, sizeof(char), 8, Input) == 8 && memcmp(magic,MODEL_METADATA_MAGIC,8) == 0){
+        aux=fread(&version, sizeof(int), 1, Input);
+        aux=fread(&mod->deadline, sizeof(int), 1, Input);
+    }
+}
+
+/**
+ * @brief It stores a multi-class model into a file.
+ *
+ * @param mod The multi-class model to store.
+ * @param Output The file.
+ * @return 0 if the model was written, 1 on a write error.
+ */
+
+int storeMulticlassModel(multiclassModel *mod, FILE *Output){
+    size_t aux = 0, expected = 0;
+    int version = MULTICLASS_MODEL_VERSION;
+    int nCoefficients = mod->start[mod->nModels];
+    aux+=fwrite(MULTICLASS_MODEL_MAGIC, sizeof(char), 8, Output); expected+=8;
+    aux+=fwrite(&version, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&mod->nClasses, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&mod->strategy, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&mod->nModels, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&mod->deadline, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(mod->labels, sizeof(double), mod->nClasses, Output); expected+=mod->nClasses;
+    aux+=fwrite(mod->positive, sizeof(int), mod->nModels, Output); expected+=mod->nModels;
+    aux+=fwrite(mod->negative, sizeof(int), mod->nModels, Output); expected+=mod->nModels;
+    aux+=fwrite(mod->bias, sizeof(double), mod->nModels, Output); expected+=mod->nModels;
+    aux+=fwrite(mod->start, sizeof(int), mod->nModels+1, Output); expected+=mod->nModels+1;
+    aux+=fwrite(mod->svIndex, sizeof(int), nCoefficients, Output); expected+=nCoefficients;
+    aux+=fwrite(mod->weights, sizeof(double), nCoefficients, Output); expected+=nCoefficients;
+    // storeModel does not check its writes, the error indicator of the stream is checked instead
+    storeModel(&mod->svs, Output);
+    if(fflush(Output) != 0 || ferror(Output)) return 1;
+    return (aux != expected);
+}
+
+/**
+ * @brief It loads a multi-class model from a file.
+ *
+ * @param mod The pointer with the struct to load results.
+ * @param Input The file.
+ */
+
+void readMulticlassModel(multiclassModel *mod, FILE *Input){
+    int aux, version, nCoefficients;
+    char magic[8];
+    aux=fread(magic, sizeof(char), 8, Input);
+    if(aux != 8 || memcmp(magic,MULTICLASS_MODEL_MAGIC,8) != 0){
+        fprintf(stderr, "The file does not contain a multi-class model\n");
+        exit(2);
+    }
+    aux=fread(&version, sizeof(int), 1, Input);
+    aux=fread(&mod->nClasses, sizeof(int), 1, Input);
+    aux=fread(&mod->strategy, sizeof(int), 1, Input);
+    aux=fread(&mod->nModels, sizeof(int), 1, Input);
+    aux=fread(&mod->deadline, sizeof(int), 1, Input);
+    mod->labels = (double *) malloc(mod->nClasses*sizeof(double));
+    mod->positive = (int *) malloc(mod->nModels*sizeof(int));
+    mod->negative = (int *) malloc(mod->nModels*sizeof(int));
+    mod->bias = (double *) malloc(mod->nModels*sizeof(double));
+    mod->start = (int *) malloc((mod->nModels+1)*sizeof(int));
+    aux=fread(mod->labels, sizeof(double), mod->nClasses, Input);
+    aux=fread(mod->positive, sizeof(int), mod->nModels, Input);
+    aux=fread(mod->negative, sizeof(int), mod->nModels, Input);
+    aux=fread(mod->bias, sizeof(double), mod->nModels, Input);
+    aux=fread(mod->start, sizeof(int), mod->nModels+1, Input);
+    nCoefficients = mod->start[mod->nModels];
+    mod->svIndex = (int *) malloc((nCoefficients>0 ? nCoefficients : 1)*sizeof(int));
+    mod->weights = (double *) malloc((nCoefficients>0 ? nCoefficients : 1)*sizeof(double));
+    aux=fread(mod->svIndex, sizeof(int), nCoefficients, Input);
+    aux=fread(mod->weights, sizeof(double), nCoefficients, Input);
+    readModel(&mod->svs, Input);
+}
+
+/**
+ * @brief It tells if a model file contains a multi-class model.
+ *
+ * @param Input The file.
+ * @return 1 if the file contains a multi-class model and 0 otherwise.
+ */
+
+int isMulticlassModel(FILE *Input){
+    char magic[8];
+    long position = ftell(Input);
+    int multiclass = (fread(magic, sizeof(char), 8, Input) == 8 && memcmp(magic,MULTICLASS_MODEL_MAGIC,8) == 0);
+    fseek(Input, position, SEEK_SET);
+    return multiclass;
+}
+
+/**
+ * @brief Free multi-class model memory
+ *
+ * Free memory allocated by a multi-class model.
+ * @param mod The model
+ */
+
+void freeMulticlassModel(multiclassModel mod){
+    free(mod.labels);
+    free(mod.positive);
+    free(mod.negative);
+    free(mod.bias);
+    free(mod.start);
+    free(mod.svIndex);
+    free(mod.weights);
+    freeModel(mod.svs);
 }
 
 /**
@@ -57,19 +57,23 @@ double *softTest(svm_dataset dataset, model mymodel,predictProperties props){
 
     int i,j;		
     double *predictions=(double *) malloc((dataset.l)*sizeof(double));
+    kernelEvaluator kernel = testEvaluator(dataset,mymodel);
 
     #pragma omp parallel default(shared) private(i,j)
     {	
+    double *Krow=(double *) malloc((mymodel.nSVs)*sizeof(double));
     #pragma omp for schedule(static)
     for (i=0;i<dataset.l;i++){
         // Iteration over all the training elements
         double pred=mymodel.bias;
+        kernelEvaluatorRow(&kernel, i, NULL, mymodel.nSVs, props.FastExp, Krow);
         for (j=0;j<mymodel.nSVs;j++){
             // Iteration over the Support Vectors
-            pred+=(mymodel.weights[j])*kernelTest(dataset, i,  mymodel, j);
+            pred+=(mymodel.weights[j])*Krow[j];
         }
         predictions[i]=pred;
     }	
+    free(Krow);
     }
 
     // Obtaining accuracy (only for labeled test dataset)
@@ -100,21 +104,25 @@ double *test(svm_dataset dataset, model mymodel,predictProperties props){
 
     int i,j;		
     double *predictions=(double *) malloc((dataset.l)*sizeof(double));
+    kernelEvaluator kernel = testEvaluator(dataset,mymodel);
 
     #pragma omp parallel default(shared) private(i,j)
     {	
+    double *Krow=(double *) malloc((mymodel.nSVs)*sizeof(double));
     #pragma omp for schedule(static)
     for (i=0;i<dataset.l;i++){
         // Iteration over all the training elements
         double pred=mymodel.bias;
+        kernelEvaluatorRow(&kernel, i, NULL, mymodel.nSVs, props.FastExp, Krow);
         for (j=0;j<mymodel.nSVs;j++){
             // Iteration over the Support Vectors
-            pred+=(mymodel.weights[j])*kernelTest(dataset, i,  mymodel, j);
+            pred+=(mymodel.weights[j])*Krow[j];
         }
         predictions[i]=pred;
         if(predictions[i]>=0.0) predictions[i]=1.0;
         else predictions[i]=-1.0;
     }	
+    free(Krow);
     }
 
     // Obtaining accuracy (only for labeled test dataset)
@@ -131,6 +139,97 @@ double *test(svm_dataset dataset, model mymodel,predictProperties props){
 }
 
 
+/**
+ * @brief Function to classify data with a multi-class model.
+ *
+ * Function to classify data with a multi-class model and to obtain the accuracy in labeled datasets.
+ * @param dataset The test set.
+ * @param mymodel A trained multi-class model.
+ * @param props The test properties.
+ * @return The label of the class of every test sample.
+ */
+
+double *multiclassTest(svm_dataset dataset, multiclassModel mymodel,predictProperties props){
+
+    int i;
+    double *predictions=(double *) malloc((dataset.l)*sizeof(double));
+    kernelEvaluator kernel = testEvaluator(dataset,mymodel.svs);
+
+    #pragma omp parallel default(shared) private(i)
+    {
+    double *Krow=(double *) malloc((mymodel.svs.nSVs>0 ? mymodel.svs.nSVs : 1)*sizeof(double));
+    int *votes=(int *) malloc((mymodel.nClasses)*sizeof(int));
+    int j, k, best;
+    double output, bestOutput=0.0;
+    #pragma omp for schedule(static)
+    for (i=0;i<dataset.l;i++){
+        // The kernel function of every distinct support vector is evaluated once
+        kernelEvaluatorRow(&kernel, i, NULL, mymodel.svs.nSVs, props.FastExp, Krow);
+        memset(votes,0,(mymodel.nClasses)*sizeof(int));
+        best=0;
+        for (k=0;k<mymodel.nModels;k++){
+            output=mymodel.bias[k];
+            for (j=mymodel.start[k];j<mymodel.start[k+1];j++){
+                output+=(mymodel.weights[j])*Krow[mymodel.svIndex[j]];
+            }
+            if(mymodel.strategy==0){
+                if(output>=0.0) votes[mymodel.positive[k]]++;
+                else votes[mymodel.negative[k]]++;
+            }else if(k==0 || output>bestOutput){
+                bestOutput=output;
+                best=mymodel.positive[k];
+            }
+        }
+        if(mymodel.strategy==0){
+            for (k=1;k<mymodel.nClasses;k++){
+                if(votes[k]>votes[best]) best=k;
+            }
+        }
+        predictions[i]=mymodel.labels[best];
+    }
+    free(Krow);
+    free(votes);
+    }
+
+    // Obtaining accuracy (only for labeled test dataset)
+    double aciertos=0.0;
+    double total=(double)dataset.l;
+    if(props.Labels==1){
+        for (i=0;i<dataset.l;i++){
+            if(predictions[i]==dataset.y[i]) aciertos++;
+        }
+        printf("Accuracy: %f\n",aciertos/total);
+    }
+    return predictions;
+}
+
+/**
+ * @brief Accuracy of a model on a labeled dataset.
+ *
+ * The support vectors of the model are converted to the layout of the dataset before the classification.
+ * @param dataset The labeled test set.
+ * @param mymodel A trained SVM model (svm_sample layout, as it is built by the training functions).
+ * @param props The test properties.
+ * @return The fraction of samples that are correctly classified.
+ */
+
+double modelAccuracy(svm_dataset dataset, model *mymodel,predictProperties props){
+    int i;
+    if(dataset.single==1) modelToSingle(mymodel);
+    if(dataset.csr==1) modelToCSR(mymodel);
+    if(dataset.dense==1) modelToDense(mymodel);
+
+    props.Labels=0;
+    double *predictions = softTest(dataset,*mymodel,props);
+    double hits=0.0;
+    for (i=0;i<dataset.l;i++){
+        if(predictions[i]>0 && dataset.y[i]>0) hits++;
+        if(predictions[i]<=0 && dataset.y[i]<=0) hits++;
+    }
+    free(predictions);
+    return hits/dataset.l;
+}
+
 /**
  * @brief It shows the command line instructions in the standard output.
  *
@@ -149,6 +248,7 @@ void printPredictInstructions(void) {
     fprintf(stderr, "  -s Soft output: (default 0)\n");
     fprintf(stderr, "       0 -- Obtains the class of every data (It takes values of +1 or -1).\n");
     fprintf(stderr, "       1 -- The output before the class decision (Useful to combine in ensembles with other algorithms).\n");
+    fprintf(stderr, "       Multi-class models always obtain the label of the class.\n");
     fprintf(stderr, "  -f file format: (default 1)\n"); 
     fprintf(stderr, "       0 -- CSV format (comma separator)\n");
     fprintf(stderr, "       1 -- libsvm format\n");   
@@ -156,6 +256,15 @@ void printPredictInstructions(void) {
     fprintf(stderr, "  -v verbose: (default 1)\n");        
     fprintf(stderr, "       0 -- No screen messages\n");
     fprintf(stderr, "       1 -- Screen messages\n");
+    fprintf(stderr, "  -x exponential of the rbf kernel: (default 0)\n");
+    fprintf(stderr, "       0 -- Math library\n");
+    fprintf(stderr, "       1 -- Vectorized approximation (relative error below 1e-7)\n");
+    fprintf(stderr, "  -P precision: storage of the features (default double)\n");
+    fprintf(stderr, "       double -- Double precision\n");
+    fprintf(stderr, "       single -- Single precision (half of the memory, kernels are accumulated in double precision)\n");
+    fprintf(stderr, "  -L layout: layout of the features in memory (default samples)\n");
+    fprintf(stderr, "       samples -- Array of (index, value) structs per sample, dense datasets use an aligned dense matrix\n");
+    fprintf(stderr, "       csr -- CSR format, indexes and values in separate arrays (only double precision)\n");
 }
 
 /**
@@ -176,6 +285,9 @@ predictProperties parsePredictParameters(int* argc, char*** argv) {
     props.file = 1;
     props.separator = ",";
     props.verbose = 1;
+    props.FastExp = 0;
+    props.Single = 0;
+    props.CSR = 0;
 	
     int i;
     for (i = 1; i < *argc; ++i) {
@@ -196,6 +308,26 @@ predictProperties parsePredictParameters(int* argc, char*** argv) {
             props.separator = param_value;
         } else if (strcmp(param_name, "v") == 0) {
             props.verbose = atoi(param_value);
+        } else if (strcmp(param_name, "x") == 0) {
+            props.FastExp = atoi(param_value);
+        } else if (strcmp(param_name, "P") == 0) {
+            if (strcmp(param_value, "single") == 0) {
+                props.Single = 1;
+            } else if (strcmp(param_value, "double") == 0) {
+                props.Single = 0;
+            } else {
+                fprintf(stderr, "Unknown precision %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "L") == 0) {
+            if (strcmp(param_value, "csr") == 0) {
+                props.CSR = 1;
+            } else if (strcmp(param_value, "samples") == 0) {
+                props.CSR = 0;
+            } else {
+                fprintf(stderr, "Unknown layout %s\n",param_value);
+                exit(2);
+            }
         } else if (strcmp(param_name, "l") == 0) {
             props.Labels = atoi(param_value);
             if(props.Labels !=0 && props.Labels !=1){
@@ -214,6 +346,11 @@ predictProperties parsePredictParameters(int* argc, char*** argv) {
             exit(2);
         }
     }
+
+    if (props.Single==1 && props.CSR==1) {
+        fprintf(stderr, "The csr layout is only available in double precision\n");
+        exit(2);
+    }
 	  int j;
     for (j = 1; i + j - 1 < *argc; ++j) {
         (*argv)[j] = (*argv)[i + j - 1];
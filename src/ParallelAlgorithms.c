@@ -68,89 +68,88 @@ extern void dtrmm_(char *side, char *uplo, char *transA, char *diag,
                    int *m, int *n, double *alpha, double *A, int *ldA,
                    double *B, int *ldB);
 
+extern void dtrsv_(char *uplo, char *trans, char *diag, int *n, double *A, int *lda,
+                   double *x, int *incx);
 
-/** @brief Auxiliar memory to perform temporal results in the parallel algebra operations. */
-double **auxmemory1;
-/** @brief Auxiliar memory to perform temporal results in the parallel algebra operations. */
-double **auxmemory2;
-/** @brief Auxiliar memory to perform temporal results in the parallel algebra operations. */
-double **auxmemory3;
 
 /**
- * @brief Function to allocate auxiliar memory to be used in the algebra operations.
+ * @brief Function to create a context with the auxiliar memory used in the algebra operations.
  *
- * 
  * The parallel lineal algebra functions of this module require some memory for every thead to
- * allocate temporal results. This function must be called before any other function.
+ * allocate temporal results. Every solver owns its context, so different trainings can run at the same time.
  *
  * @param Threads The number of threads to parallelize the linear algebra functions.
  * @param size The size of the dimensions of the matrices that will be handle. If a matrix has a rows and b columns, then n=max(a,b).
- * @see updateMemory()
+ * @return The context.
+ * @see updateSolverContext()
  */
 
-void initMemory(int Threads, int size){
+solverContext *initSolverContext(int Threads, int size){
 
-    auxmemory1=(double **) calloc(Threads,sizeof(double*));
-    auxmemory2=(double **) calloc(Threads,sizeof(double*));
-    auxmemory3=(double **) calloc(Threads,sizeof(double*));
+    solverContext *context = (solverContext *) calloc(1,sizeof(solverContext));
+    context->Threads=Threads;
+    context->size=size;
+    context->auxmemory1=(double **) calloc(Threads,sizeof(double*));
+    context->auxmemory2=(double **) calloc(Threads,sizeof(double*));
+    context->auxmemory3=(double **) calloc(Threads,sizeof(double*));
 
     int i;
     for(i=0;i<Threads;i++){
-        auxmemory1[i]=(double *) calloc(pow(ceil(1.0*(size)),2),sizeof(double));
-        auxmemory2[i]=(double *) calloc(pow(ceil(1.0*(size)),2),sizeof(double));
-        auxmemory3[i]=(double *) calloc(pow(ceil(1.0*(size)),2),sizeof(double));
+        context->auxmemory1[i]=(double *) calloc(pow(ceil(1.0*(size)),2),sizeof(double));
+        context->auxmemory2[i]=(double *) calloc(pow(ceil(1.0*(size)),2),sizeof(double));
+        context->auxmemory3[i]=(double *) calloc(pow(ceil(1.0*(size)),2),sizeof(double));
     }            
 
+    return context;
 }
 
 
 /**
- * @brief Function to free auxiliar memory to be used in the algebra operations.
- *
- * 
- * The parallel lineal algebra functions of this module require some memory for every thead to
- * allocate temporal results. This function must be called after any other function.
+ * @brief Function to free a context of the algebra operations.
  *
- * @param Threads The number of threads to parallelize the linear algebra functions.
- * @see updateMemory()
+ * @param context The context.
+ * @see initSolverContext()
  */
 
-void freeMemory(int Threads){
+void freeSolverContext(solverContext *context){
 
     int i;
 
-    for(i=0;i<Threads;i++){
-        free(auxmemory1[i]);
-        free(auxmemory2[i]);
-        free(auxmemory3[i]);
+    for(i=0;i<context->Threads;i++){
+        free(context->auxmemory1[i]);
+        free(context->auxmemory2[i]);
+        free(context->auxmemory3[i]);
     } 
 
-    free(auxmemory1);
-    free(auxmemory2);
-    free(auxmemory3);
+    free(context->auxmemory1);
+    free(context->auxmemory2);
+    free(context->auxmemory3);
+    free(context);
 }
 
 
 
 
 /**
- * @brief Function to update auxiliar memory to be used in the algebra operations.
+ * @brief Function to enlarge the auxiliar memory of a context.
  *
- * The parallel lineal algebra functions of this module require some memory for every thead to
- * allocate temporal results. This function must be called if we allocated the memory using the function initMemory and we are going to work with bigger matrices.
+ * This function must be called if we are going to work with bigger matrices than the size of the context.
  *
- * @param Threads The number of threads to parallelize the linear algebra functions.
+ * @param context The context.
  * @param size The size of the dimensions of the matrices that will be handle. If a matrix has a rows and b columns, then n=max(a,b).
- * @see initMemory()
+ * @see initSolverContext()
  */
 
-void updateMemory(int Threads, int size){
+void updateSolverContext(solverContext *context, int size){
+
+    if(size<=context->size) return;
+    context->size=size;
 
     int i;
-    for(i=0;i<Threads;i++){
-        auxmemory1[i]=realloc(auxmemory1[i],pow(ceil(1.0*(size)),2)*sizeof(double));
-        auxmemory2[i]=realloc(auxmemory2[i],pow(ceil(1.0*(size)),2)*sizeof(double));
-        auxmemory3[i]=realloc(auxmemory3[i],pow(ceil(1.0*(size)),2)*sizeof(double));
+    for(i=0;i<context->Threads;i++){
+        context->auxmemory1[i]=realloc(context->auxmemory1[i],pow(ceil(1.0*(size)),2)*sizeof(double));
+        context->auxmemory2[i]=realloc(context->auxmemory2[i],pow(ceil(1.0*(size)),2)*sizeof(double));
+        context->auxmemory3[i]=realloc(context->auxmemory3[i],pow(ceil(1.0*(size)),2)*sizeof(double));
     }
 
 }
@@ -222,10 +221,11 @@ void putSubMatrix(double *matrix,int size1,int size2,int O1,int O2,double *A, in
  * @param n The order of the square submatrix
  * @param nCores The number of threads to perform the task.
  * @param deep It is a recursive function, this parameter tell the recursion deep to use.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see Chol()
  */
 
-void ParallelChol(double *matrix,int r,int c, int ro, int co, int n,int nCores, int deep){    
+void ParallelChol(double *matrix,int r,int c, int ro, int co, int n,int nCores, int deep, solverContext *context){    
     double *memaux = (double *)calloc(2*pow(ceil(0.5*n),2),sizeof(double));
     int blockSize = pow(ceil(0.5*n),2)/nCores;    
     
@@ -234,7 +234,7 @@ void ParallelChol(double *matrix,int r,int c, int ro, int co, int n,int nCores,
     {    
     #pragma omp for schedule(static)    
     for (i=0;i<nCores;i++){
-        Chol(matrix,r,c,ro,co,n,nCores,i,deep,0,memaux,blockSize);
+        Chol(matrix,r,c,ro,co,n,nCores,i,deep,0,memaux,blockSize,context);
     }
     }
     free(memaux);        
@@ -261,16 +261,16 @@ void ParallelChol(double *matrix,int r,int c, int ro, int co, int n,int nCores,
  * @param memaux The auxiliar memory.
  * @param blockSize The size of its memory to save temporal results.
  * @param deep It is a recursive function, this parameter tell the recursion deep to use.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see ParallelChol()
- * @see initMemory()
- * @see updateMemory()
+ * @see initSolverContext()
  */
 
-void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh, int deep,int posIni,double *memaux, int blockSize){    
+void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh, int deep,int posIni,double *memaux, int blockSize, solverContext *context){    
     if(deep<=1 | n < 8){    
         if(numTh==posIni & n>0){
            
-            double *m=auxmemory1[numTh];        
+            double *m=context->auxmemory1[numTh];        
             getSubMatrix(matrix,r,c,ro,co,m, n,n,1);
             int info;
             char s='L';
@@ -296,22 +296,22 @@ void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh
         int size1=ceil(0.5*n);
         int size2=n-size1;
 
-        Chol(matrix,r,c,ro,co,size1,nCores,numTh,deep-1,posIni,memaux,blockSize);
+        Chol(matrix,r,c,ro,co,size1,nCores,numTh,deep-1,posIni,memaux,blockSize,context);
 
         #pragma omp barrier            
-        MoveMatrix(matrix,r,ro,c,co,&memaux[posIni*blockSize],size1,0,size1,0,size1,size1, nCores,posIni,numTh);
+        MoveMatrix(matrix,r,ro,c,co,&memaux[posIni*blockSize],size1,0,size1,0,size1,size1, nCores,posIni,numTh,context);
 
         #pragma omp barrier                
-        TriangleInversion(&memaux[posIni*blockSize],size1, size1, 0, 0, size1, nCores,posIni,numTh,&memaux[size1*size1],blockSize);
+        TriangleInversion(&memaux[posIni*blockSize],size1, size1, 0, 0, size1, nCores,posIni,numTh,&memaux[size1*size1],blockSize,context);
 
         #pragma omp barrier            
-        MoveMatrix(matrix,r,ro+size1,c,co,&memaux[posIni*blockSize+size1*size1],size2,0,size1,0,size2,size1, nCores,posIni,numTh);
+        MoveMatrix(matrix,r,ro+size1,c,co,&memaux[posIni*blockSize+size1*size1],size2,0,size1,0,size2,size1, nCores,posIni,numTh,context);
 
         #pragma omp barrier            
-        NLTProduct(&memaux[posIni*blockSize],size1,0,size1,0,&memaux[posIni*blockSize+size1*size1],size2,0,size1,0,size1,size2,1.0,matrix,r,ro+size1,c, co, nCores,posIni,numTh);
+        NLTProduct(&memaux[posIni*blockSize],size1,0,size1,0,&memaux[posIni*blockSize+size1*size1],size2,0,size1,0,size1,size2,1.0,matrix,r,ro+size1,c, co, nCores,posIni,numTh,context);
 
         #pragma omp barrier            
-        AATProduct(matrix,r,ro+size1,c,co,size2,size1,-1.0,1.0,matrix,r,ro+size1,c, co+size1, nCores,posIni,numTh);
+        AATProduct(matrix,r,ro+size1,c,co,size2,size1,-1.0,1.0,matrix,r,ro+size1,c, co+size1, nCores,posIni,numTh,context);
 
         #pragma omp barrier            
         if(numTh==posIni){
@@ -321,7 +321,7 @@ void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh
         }
 
         #pragma omp barrier            
-        Chol(matrix,r,c,ro+size1,co+size1,size2,nCores,numTh,deep-1,posIni,memaux,blockSize);        
+        Chol(matrix,r,c,ro+size1,co+size1,size2,nCores,numTh,deep-1,posIni,memaux,blockSize,context);        
         
         #pragma omp barrier                            
         
@@ -355,14 +355,39 @@ void Chol(double *matrix,int r,int c, int ro, int co, int n,int nCores,int numTh
  * @param ror The row where the result submatrix starts.
  * @param cor The column where the result submatrix starts.
  * @param nCores The number of threads to launch to solve the task.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
 
-void ParallelLinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores){
+void ParallelLinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, solverContext *context){
+    ParallelLinearSystemBuffer(matrix1,r1,c1,ro1,co1,matrix2,r2,c2,ro2,co2,n,m,result,rr,cr,ror,cor,nCores,NULL,context);
+}
+
+/**
+ * @brief Parallel linear system with a given temporal memory.
+ *
+ * Like ParallelLinearSystem(), but the temporal memory of the parallel Cholesky factorization is
+ * given by the caller, so a solver that solves many systems allocates it only once.
+ *
+ * @param memaux The temporal memory, it must have space for 2*ceil(n/2)^2 elements (if it is NULL the
+ * function allocates it).
+ * @param context The context of the solver with the temporal memory of every thread.
+ * @see ParallelLinearSystem()
+ */
+
+void ParallelLinearSystemBuffer(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, double *memaux, solverContext *context){
 
-    if(n>nCores){
+    // With a single thread LAPACK solves the system without the shared temporal memory,
+    // so independent trainings can run concurrently (one per thread).
+    if(n>nCores && nCores>1){
     
-        double *memaux = (double *)calloc(2*pow(ceil(0.5*n),2),sizeof(double));
+        int ownMemory = (memaux==NULL);
+        int memSize = 2*pow(ceil(0.5*n),2);
+        if(ownMemory==1){
+            memaux = (double *)calloc(memSize,sizeof(double));
+        }else{
+            memset(memaux,0,memSize*sizeof(double));
+        }
         int blockSize = pow(ceil(0.5*n),2)/nCores;    
         
         int i;
@@ -371,10 +396,10 @@ void ParallelLinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double
         {    
         #pragma omp for schedule(static)    
         for (i=0;i<nCores;i++){
-            LinearSystem(matrix1,r1,c1,ro1,co1,matrix2,r2,c2,ro2,co2,n,m,result,rr,cr,ror,cor,nCores,i,0,memaux,blockSize);
+            LinearSystem(matrix1,r1,c1,ro1,co1,matrix2,r2,c2,ro2,co2,n,m,result,rr,cr,ror,cor,nCores,i,0,memaux,blockSize,context);
         }
         }
-        free(memaux);
+        if(ownMemory==1) free(memaux);
     }else{
 
         int info;
@@ -416,14 +441,15 @@ void ParallelLinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double
  * @param posIni Variable to know what task to do by this thread.
  * @param memaux The auxiliar memory.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see ParallelLinearSystem()
  */
 
-void LinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, int numTh,int posIni,double *memaux, int blockSize){    
+void LinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix2,int r2,int c2, int ro2, int co2,int n, int m,double *result,int rr,int cr, int ror, int cor, int nCores, int numTh,int posIni,double *memaux, int blockSize, solverContext *context){    
          
 
     int deep=2;
-    Chol(matrix1,r1,c1,ro1,co1,n,nCores,numTh,deep,posIni,memaux,blockSize);
+    Chol(matrix1,r1,c1,ro1,co1,n,nCores,numTh,deep,posIni,memaux,blockSize,context);
 
     #pragma omp barrier    
         
@@ -467,17 +493,18 @@ void LinearSystem(double *matrix1,int r1,int c1, int ro1, int co1,double *matrix
  * @param numTh Thread identifier.
  * @param memaux The auxiliar memory.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see DiagInversion()
  * @see InversionNLProducts()
  * @see InversionLNProducts()
  */
 
 
-void TriangleInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni, int numTh,double *memaux,int blockSize){
+void TriangleInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni, int numTh,double *memaux,int blockSize, solverContext *context){
 
     #pragma omp barrier            
         
-    DiagInversion(matrix,r,c,ro,co,n,nCores,posIni,numTh);
+    DiagInversion(matrix,r,c,ro,co,n,nCores,posIni,numTh,context);
         
     #pragma omp barrier            
     
@@ -488,11 +515,11 @@ void TriangleInversion(double *matrix,int r, int c, int ro, int co, int n,int nC
     
     for (o=deep;o>=1;o--){
             
-        InversionNLProducts(matrix,r,c,ro,co,n,nCores,posIni,o,numTh,memaux,blockSize);
+        InversionNLProducts(matrix,r,c,ro,co,n,nCores,posIni,o,numTh,memaux,blockSize,context);
             
         #pragma omp barrier            
             
-        InversionLNProducts(matrix,r,c,ro,co,n,nCores,posIni,o,numTh,memaux,blockSize);
+        InversionLNProducts(matrix,r,c,ro,co,n,nCores,posIni,o,numTh,memaux,blockSize,context);
             
         #pragma omp barrier            
     }    
@@ -515,13 +542,14 @@ void TriangleInversion(double *matrix,int r, int c, int ro, int co, int n,int nC
  * @param nCores The number of threads to perform the matrix inversion.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh Thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see TriangleInversion()
  */
 
-void DiagInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int numTh){
+void DiagInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){        
         if(n>0){
-            double *m=auxmemory1[numTh];
+            double *m=context->auxmemory1[numTh];
             getSubMatrix(matrix,r,c,ro,co,m, n,n,1);
             int info;
             char s1='L';
@@ -535,9 +563,9 @@ void DiagInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores
         int size2=n-size1;
 
         if(numTh<posIni+nCores/2)
-            DiagInversion(matrix,r,c,ro,co,size1,nCores/2,posIni,numTh);
+            DiagInversion(matrix,r,c,ro,co,size1,nCores/2,posIni,numTh,context);
         else
-            DiagInversion(matrix,r,c,ro+size1,co+size1, size2,nCores/2,posIni+nCores/2,numTh);
+            DiagInversion(matrix,r,c,ro+size1,co+size1, size2,nCores/2,posIni+nCores/2,numTh,context);
     }    
     
 }
@@ -561,22 +589,23 @@ void DiagInversion(double *matrix,int r, int c, int ro, int co, int n,int nCores
  * @param numTh Thread identifier.
  * @param memaux The auxiliar memory for this task.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see TriangleInversion()
  */
 
-void InversionNLProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize){
+void InversionNLProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize, solverContext *context){
 
         int size1=ceil(0.5*n);
         int size2=n-size1;
         
         if(deep==1){
             double *C1=&memaux[posIni*blockSize];
-            NLProduct(matrix,r,ro,c,co,matrix,r,ro+size1,c,co,size1,size2,-1.0,C1,size2,0,size1,0, nCores,posIni,numTh);
+            NLProduct(matrix,r,ro,c,co,matrix,r,ro+size1,c,co,size1,size2,-1.0,C1,size2,0,size1,0, nCores,posIni,numTh,context);
         }else{
             if(numTh<posIni+nCores/2)
-                InversionNLProducts(matrix,r,c,ro,co,size1,nCores/2,posIni,deep-1,numTh,memaux,blockSize);
+                InversionNLProducts(matrix,r,c,ro,co,size1,nCores/2,posIni,deep-1,numTh,memaux,blockSize,context);
             else
-                InversionNLProducts(matrix,r,c,ro+size1,co+size1,size2,nCores/2,posIni+nCores/2,deep-1,numTh,memaux,blockSize);
+                InversionNLProducts(matrix,r,c,ro+size1,co+size1,size2,nCores/2,posIni+nCores/2,deep-1,numTh,memaux,blockSize,context);
         }    
 
 }
@@ -600,22 +629,23 @@ void InversionNLProducts(double *matrix,int r, int c, int ro, int co, int n,int
  * @param numTh Thread identifier.
  * @param memaux The auxiliar memory for this task.
  * @param blockSize The size of its memory to save temporal results.
+ * @param context The context of the solver with the temporal memory of every thread.
  * @see TriangleInversion()
  */
 
-void InversionLNProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize){
+void InversionLNProducts(double *matrix,int r, int c, int ro, int co, int n,int nCores,int posIni,int deep,int numTh, double *memaux, int blockSize, solverContext *context){
 
         int size1=ceil(0.5*n);
         int size2=n-size1;
         
         if(deep==1){
             double *C1=&memaux[posIni*blockSize];
-            LNProduct(matrix,r,ro+size1,c,co+size1,C1,size2,0,size1,0,size2,size1,1.0,matrix,r,ro+size1,c,co, nCores,posIni,numTh);
+            LNProduct(matrix,r,ro+size1,c,co+size1,C1,size2,0,size1,0,size2,size1,1.0,matrix,r,ro+size1,c,co, nCores,posIni,numTh,context);
         }else{
             if(numTh<posIni+nCores/2)
-                InversionLNProducts(matrix,r,c,ro,co,size1,nCores/2,posIni,deep-1,numTh,memaux,blockSize);
+                InversionLNProducts(matrix,r,c,ro,co,size1,nCores/2,posIni,deep-1,numTh,memaux,blockSize,context);
             else
-                InversionLNProducts(matrix,r,c,ro+size1,co+size1,size2,nCores/2,posIni+nCores/2,deep-1,numTh,memaux,blockSize);
+                InversionLNProducts(matrix,r,c,ro+size1,co+size1,size2,nCores/2,posIni+nCores/2,deep-1,numTh,memaux,blockSize,context);
         }    
 
 }
@@ -650,18 +680,19 @@ void InversionLNProducts(double *matrix,int r, int c, int ro, int co, int n,int
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
  * @param orientation Auxiliar variable to know the next task to perform.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh,int orientation){
+void NNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh,int orientation, solverContext *context){
     if(nCores <= 1){
         if(n1 >0 & n3>0){            
-            double *mresultT=auxmemory2[numTh];            
+            double *mresultT=context->auxmemory2[numTh];            
             getSubMatrix(result,rr,cr,ror,cor,mresultT, n1,n3,nCores);
             
             if(n2 > 0){
                                             
-                double *m1T=auxmemory1[numTh];
-                double *m2T=auxmemory3[numTh];
+                double *m1T=context->auxmemory1[numTh];
+                double *m2T=context->auxmemory3[numTh];
 
                 getSubMatrix(m1,r1,c1,ro1,co1,m1T, n1,n2,nCores);                
                 getSubMatrix(m2,r2,c2,ro2,co2,m2T, n2,n3,nCores);   
@@ -693,28 +724,28 @@ void NNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
 
 
         if(numTh<posIni+nCores/2){
-                NNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,cols2A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh,orientation);            
-                NNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1A,cols1B,cols2A,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh,orientation);
+                NNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,cols2A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh,orientation,context);            
+                NNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1A,cols1B,cols2A,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh,orientation,context);
 
                 if(orientation==1){
-                    NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,cols2A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores/2,posIni,numTh,orientation);
-                    NNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1B,cols2A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores/2,posIni,numTh,orientation);                
+                    NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,cols2A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores/2,posIni,numTh,orientation,context);
+                    NNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1B,cols2A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores/2,posIni,numTh,orientation,context);                
                 }else{
-                    NNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1A,cols2B,K1,K2,result,rr,ror,cr,cor+cols2A, nCores/2,posIni,numTh,orientation);
-                    NNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1A,cols1B,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A, nCores/2,posIni,numTh,orientation);
+                    NNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1A,cols2B,K1,K2,result,rr,ror,cr,cor+cols2A, nCores/2,posIni,numTh,orientation,context);
+                    NNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1A,cols1B,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A, nCores/2,posIni,numTh,orientation,context);
                 }
                                 
         }else{
                 if(orientation==2){
-                    NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,cols2A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores/2,posIni+nCores/2,numTh,orientation);
-                    NNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1B,cols2A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores/2,posIni+nCores/2,numTh,orientation);                
+                    NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,cols2A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores/2,posIni+nCores/2,numTh,orientation,context);
+                    NNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1B,cols2A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores/2,posIni+nCores/2,numTh,orientation,context);                
                 }else{
-                    NNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1A,cols2B,K1,K2,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation);
-                    NNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1A,cols1B,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation);
+                    NNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1A,cols2B,K1,K2,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation,context);
+                    NNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1A,cols1B,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation,context);
                 }
                 
-                NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,K2,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation);
-                NNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1B,cols2B,K1,1.0,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation);
+                NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,K2,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation,context);
+                NNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1B,cols2B,K1,1.0,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,orientation,context);
             
         }
     }
@@ -740,12 +771,13 @@ void NNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
  * @param numTh The thread identifier.
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void MoveMatrix(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2, int n1, int n2, int nCores,int posIni,int numTh){
+void MoveMatrix(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2, int n1, int n2, int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){
         if(n1 >0 & n2>0){            
-            double *mmv=auxmemory2[numTh];
+            double *mmv=context->auxmemory2[numTh];
             getSubMatrix(m1,r1,c1,ro1,co1,mmv, n1,n2,nCores);
             putSubMatrix(m2,r2,c2,ro2,co2,mmv, n1,n2,nCores);
         }        
@@ -756,11 +788,11 @@ void MoveMatrix(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
         int cols1B=n2-cols1A;
 
         if(numTh<posIni+nCores/2){
-                MoveMatrix(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,nCores/2,posIni,numTh);            
-                MoveMatrix(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows1A,c2,co2,rows1B,cols1A,nCores/2,posIni,numTh);                                            
+                MoveMatrix(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,nCores/2,posIni,numTh,context);            
+                MoveMatrix(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows1A,c2,co2,rows1B,cols1A,nCores/2,posIni,numTh,context);                                            
         }else{
-                MoveMatrix(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols1A,rows1A,cols1B,nCores/2,posIni+nCores/2,numTh);            
-                MoveMatrix(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows1A,c2,co2+cols1A,rows1B,cols1B,nCores/2,posIni+nCores/2,numTh);                                            
+                MoveMatrix(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols1A,rows1A,cols1B,nCores/2,posIni+nCores/2,numTh,context);            
+                MoveMatrix(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows1A,c2,co2+cols1A,rows1B,cols1B,nCores/2,posIni+nCores/2,numTh,context);                                            
         }
     }
 }
@@ -795,19 +827,20 @@ void MoveMatrix(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void TNNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh){
+void TNNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){
         if(n2 >0 & n3>0){    
                                             
-            double *mresultT=auxmemory2[numTh];        
+            double *mresultT=context->auxmemory2[numTh];        
             getSubMatrix(result,rr,cr,ror,cor,mresultT, n2,n3,nCores);
             
             if(n1 >0){
                                             
-                double *m1T=auxmemory1[numTh];
-                double *m2T=auxmemory3[numTh];        
+                double *m1T=context->auxmemory1[numTh];
+                double *m2T=context->auxmemory3[numTh];        
                 getSubMatrix(m1,r1,c1,ro1,co1,m1T, n1,n2,nCores);            
                 getSubMatrix(m2,r2,c2,ro2,co2,m2T, n1,n3,nCores); 
                 
@@ -835,17 +868,17 @@ void TNNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
         int cols2B=n3-cols2A;
         
         if(numTh<posIni+nCores/2){
-                TNNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,cols2A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
-                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1A,cols2A,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
+                TNNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,cols2A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
+                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1A,cols2A,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
 
-                TNNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2,rows1A,cols1B,cols2A,K1,K2,result,rr,ror+cols1A,cr,cor,nCores/2,posIni,numTh);
-                TNNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1B,cols2A,K1,1.0,result,rr,ror+cols1A,cr,cor, nCores/2,posIni,numTh);
+                TNNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2,rows1A,cols1B,cols2A,K1,K2,result,rr,ror+cols1A,cr,cor,nCores/2,posIni,numTh,context);
+                TNNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1B,cols2A,K1,1.0,result,rr,ror+cols1A,cr,cor, nCores/2,posIni,numTh,context);
         }else{
-                TNNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1A,cols2B,K1,K2,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);
-                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);
+                TNNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1A,cols2B,K1,K2,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);
+                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);
 
-                TNNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1B,cols2B,K1,K2,result,rr,ror+cols1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);
-                TNNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1B,cols2B,K1,1.0,result,rr,ror+cols1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);
+                TNNProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1B,cols2B,K1,K2,result,rr,ror+cols1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);
+                TNNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1B,cols2B,K1,1.0,result,rr,ror+cols1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);
             
         }                
 
@@ -881,17 +914,18 @@ void TNNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NNTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh){
+void NNTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,int n3,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){
         if(n1 >0 & n3>0){                                
-            double *mresultT=auxmemory2[numTh];        
+            double *mresultT=context->auxmemory2[numTh];        
             getSubMatrix(result,rr,cr,ror,cor,mresultT, n1,n3,nCores);
             if(n2 > 0){
                                             
-                double *m1T=auxmemory1[numTh];
-                double *m2T=auxmemory3[numTh];    
+                double *m1T=context->auxmemory1[numTh];
+                double *m2T=context->auxmemory3[numTh];    
                 getSubMatrix(m1,r1,c1,ro1,co1,m1T, n1,n2,nCores);
                 getSubMatrix(m2,r2,c2,ro2,co2,m2T, n3,n2,nCores);
                 
@@ -918,19 +952,19 @@ void NNTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
         int cols2B=n2-cols2A;
     
         if(numTh<posIni+nCores/2){
-                NNTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,rows2A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
-                NNTProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1B,rows2A,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
+                NNTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols1A,rows2A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
+                NNTProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1A,cols1B,rows2A,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
 
-                NNTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1A,cols1A,rows2B,K1,K2,result,rr,ror,cr,cor+rows2A, nCores/2,posIni,numTh);
-                NNTProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1A,cols1B,rows2B,K1,1.0,result,rr,ror,cr,cor+rows2A, nCores/2,posIni,numTh);
+                NNTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1A,cols1A,rows2B,K1,K2,result,rr,ror,cr,cor+rows2A, nCores/2,posIni,numTh,context);
+                NNTProduct(m1,r1,ro1,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1A,cols1B,rows2B,K1,1.0,result,rr,ror,cr,cor+rows2A, nCores/2,posIni,numTh,context);
                 
         }else{                
 
-                NNTProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1A,rows2B,K1,K2,result,rr,ror+rows1A,cr,cor+rows2A, nCores/2,posIni+nCores/2,numTh);
-                NNTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1B,rows2B,K1,1.0,result,rr,ror+rows1A,cr,cor+rows2A, nCores/2,posIni+nCores/2,numTh);
+                NNTProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1A,rows2B,K1,K2,result,rr,ror+rows1A,cr,cor+rows2A, nCores/2,posIni+nCores/2,numTh,context);
+                NNTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1B,rows2B,K1,1.0,result,rr,ror+rows1A,cr,cor+rows2A, nCores/2,posIni+nCores/2,numTh,context);
                 
-                NNTProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,rows2A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores/2,posIni+nCores/2,numTh);
-                NNTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1B,cols1B,rows2A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores/2,posIni+nCores/2,numTh);                
+                NNTProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,rows2A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores/2,posIni+nCores/2,numTh,context);
+                NNTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1B,cols1B,rows2A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores/2,posIni+nCores/2,numTh,context);                
             
         }            
     }
@@ -959,9 +993,10 @@ void NNTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void AATProduct(double *m1,int r1,int ro1,int c1, int co1,int n1,int n2,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh){
+void AATProduct(double *m1,int r1,int ro1,int c1, int co1,int n1,int n2,double K1,double K2,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){        
         if(n1 >0 & n2>0){
         double *m1T = (double *) malloc(n1*n2*sizeof(double));            
@@ -990,15 +1025,15 @@ void AATProduct(double *m1,int r1,int ro1,int c1, int co1,int n1,int n2,double K
         int cols1B=n2-cols1A;
         
         if(numTh<posIni+nCores/2){
-                AATProduct(m1,r1,ro1,c1,co1,rows1A,cols1A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
-                AATProduct(m1,r1,ro1,c1,co1+cols1A,rows1A,cols1B,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
+                AATProduct(m1,r1,ro1,c1,co1,rows1A,cols1A,K1,K2,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
+                AATProduct(m1,r1,ro1,c1,co1+cols1A,rows1A,cols1B,K1,1.0,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
         }else{
-                AATProduct(m1,r1,ro1+rows1A,c1,co1,rows1B,cols1A,K1,K2,result,rr,ror+rows1A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh);
-                AATProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,rows1B,cols1B,K1,1.0,result,rr,ror+rows1A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh);
+                AATProduct(m1,r1,ro1+rows1A,c1,co1,rows1B,cols1A,K1,K2,result,rr,ror+rows1A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh,context);
+                AATProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,rows1B,cols1B,K1,1.0,result,rr,ror+rows1A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh,context);
             
         }                
-        NNTProduct(m1,r1,ro1+rows1A,c1,co1,m1,r1,ro1,c1,co1,rows1B,cols1A,rows1A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores,posIni,numTh);
-        NNTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m1,r1,ro1,c1,co1+cols1A,rows1B,cols1B,rows1A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores,posIni,numTh);
+        NNTProduct(m1,r1,ro1+rows1A,c1,co1,m1,r1,ro1,c1,co1,rows1B,cols1A,rows1A,K1,K2,result,rr,ror+rows1A,cr,cor,nCores,posIni,numTh,context);
+        NNTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m1,r1,ro1,c1,co1+cols1A,rows1B,cols1B,rows1A,K1,1.0,result,rr,ror+rows1A,cr,cor, nCores,posIni,numTh,context);
         
     }
 }
@@ -1031,13 +1066,14 @@ void AATProduct(double *m1,int r1,int ro1,int c1, int co1,int n1,int n2,double K
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void LNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh){
+void LNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){
         if(n1 >0 & n2>0){
-            double *m1T=auxmemory2[numTh];
-            double *mresultT=auxmemory1[numTh];
+            double *m1T=context->auxmemory2[numTh];
+            double *mresultT=context->auxmemory1[numTh];
             getSubMatrix(m1,r1,c1,ro1,co1,m1T, n1,n1,nCores);        
             getSubMatrix(m2,r2,c2,ro2,co2,mresultT, n1,n2,nCores); 
             char side = 'L';
@@ -1061,15 +1097,15 @@ void LNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
         
         
         if(numTh<posIni+nCores/2){            
-                LNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols2A,K1,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
+                LNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols2A,K1,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
                 
-                LNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols2A,K1,result,rr,ror+rows1A,cr,cor, nCores/2,posIni,numTh);
-                NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,cols2A,K1,1.0,result,rr,ror+rows1A,cr,cor,nCores/2,posIni,numTh,1);
+                LNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols2A,K1,result,rr,ror+rows1A,cr,cor, nCores/2,posIni,numTh,context);
+                NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2,rows1B,cols1A,cols2A,K1,1.0,result,rr,ror+rows1A,cr,cor,nCores/2,posIni,numTh,1,context);
         }else{
-                LNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols2B,K1,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);
+                LNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols2B,K1,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);
                 
-                LNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols2B,K1,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);
-                NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,1,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,1);
+                LNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols2B,K1,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);
+                NNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,1,result,rr,ror+rows1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,1,context);
             
         }        
             
@@ -1104,15 +1140,16 @@ void LNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
 
-void LTNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh){    
+void LTNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context){    
     if(nCores <= 1){
         if(n1 >0 & n2>0){
             int in;
-            double *m1T=auxmemory1[numTh];
-            double *m2T=auxmemory2[numTh];
+            double *m1T=context->auxmemory1[numTh];
+            double *m2T=context->auxmemory2[numTh];
             getSubMatrix(m1,r1,c1,ro1,co1,m1T, n1,n1,1);
             getSubMatrix(result,rr,cr,ror,cor,m2T, n1,n2,1);
             char side = 'L';
@@ -1135,16 +1172,16 @@ void LTNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
         
                         
         if(numTh<posIni+nCores/2){                            
-                LTNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols2A,K1,result,rr,ror+cols1A,cr,cor, nCores/2,posIni,numTh);                
+                LTNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2,rows1B,cols2A,K1,result,rr,ror+cols1A,cr,cor, nCores/2,posIni,numTh,context);                
                 
-                LTNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols2A,K1,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
-                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1A,cols2A,K1,1.0,result,rr,ror,cr,cor,nCores/2,posIni,numTh);            
+                LTNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,cols2A,K1,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
+                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1B,cols1A,cols2A,K1,1.0,result,rr,ror,cr,cor,nCores/2,posIni,numTh,context);            
 
         }else{    
-                LTNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols2B,K1,result,rr,ror+cols1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);
+                LTNProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols2B,K1,result,rr,ror+cols1A,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);
                 
-                LTNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols2B,K1,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh);            
-                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A,nCores/2,posIni+nCores/2,numTh);                                    
+                LTNProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2+cols2A,rows1A,cols2B,K1,result,rr,ror,cr,cor+cols2A, nCores/2,posIni+nCores/2,numTh,context);            
+                TNNProduct(m1,r1,ro1+rows1A,c1,co1,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,cols1A,cols2B,K1,1.0,result,rr,ror,cr,cor+cols2A,nCores/2,posIni+nCores/2,numTh,context);                                    
                 
 
         }                
@@ -1179,13 +1216,14 @@ void LTNProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NLProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh){
+void NLProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){
         if(n1 >0 & n2>0){
-            double *m1T=auxmemory1[numTh];
-            double *mresultT=auxmemory2[numTh];
+            double *m1T=context->auxmemory1[numTh];
+            double *mresultT=context->auxmemory2[numTh];
             getSubMatrix(m1,r1,c1,ro1,co1,m1T, n1,n1,nCores);        
             getSubMatrix(m2,r2,c2,ro2,co2,mresultT, n2,n1,nCores);
             char side = 'R';
@@ -1210,15 +1248,15 @@ void NLProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
         
         
         if(numTh<posIni+nCores/2){
-                NLProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,rows2A,K1,result,rr,ror,cr,cor, nCores/2,posIni,numTh);
-                NNProduct(m2,r2,ro2,c2,co2+cols2A,m1,r1,ro1+rows1A,c1,co1,rows2A,cols2B,cols1A,K1,1,result,rr,ror,cr,cor, nCores/2,posIni,numTh,2);
+                NLProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,rows2A,K1,result,rr,ror,cr,cor, nCores/2,posIni,numTh,context);
+                NNProduct(m2,r2,ro2,c2,co2+cols2A,m1,r1,ro1+rows1A,c1,co1,rows2A,cols2B,cols1A,K1,1,result,rr,ror,cr,cor, nCores/2,posIni,numTh,2,context);
                 
-                NLProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1B,rows2A,K1,result,rr,ror,cr,cor+cols1A, nCores/2,posIni,numTh);                
+                NLProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1B,rows2A,K1,result,rr,ror,cr,cor+cols1A, nCores/2,posIni,numTh,context);                
         }else{
-                NLProduct(m1,r1,ro1,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1A,rows2B,K1,result,rr,ror+rows2A,cr,cor,nCores/2,posIni+nCores/2,numTh);
-              NNProduct(m2,r2,ro2+rows2A,c2,co2+cols2A,m1,r1,ro1+rows1A,c1,co1,rows2B,cols2B,cols1A,K1,1,result,rr,ror+rows2A,cr,cor, nCores/2,posIni+nCores/2,numTh,2);                        
+                NLProduct(m1,r1,ro1,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1A,rows2B,K1,result,rr,ror+rows2A,cr,cor,nCores/2,posIni+nCores/2,numTh,context);
+              NNProduct(m2,r2,ro2+rows2A,c2,co2+cols2A,m1,r1,ro1+rows1A,c1,co1,rows2B,cols2B,cols1A,K1,1,result,rr,ror+rows2A,cr,cor, nCores/2,posIni+nCores/2,numTh,2,context);                        
                 
-                NLProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,rows2B,K1,result,rr,ror+rows2A,cr,cor+cols1A, nCores/2,posIni+nCores/2,numTh);            
+                NLProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,rows2B,K1,result,rr,ror+rows2A,cr,cor+cols1A, nCores/2,posIni+nCores/2,numTh,context);            
         }                        
 
     }
@@ -1252,13 +1290,14 @@ void NLProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int r
  * @param nCores The total number of threads.
  * @param posIni Variable to know what task to do by this thread.
  * @param numTh The thread identifier.
+ * @param context The context of the solver with the temporal memory of every thread.
  */
 
-void NLTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh){
+void NLTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int ro2,int c2, int co2,int n1,int n2,double K1,double *result,int rr,int ror,int cr, int cor, int nCores,int posIni,int numTh, solverContext *context){
     if(nCores <= 1){
         if(n1 >0 & n2>0){
-            double *m1T=auxmemory1[numTh];
-            double *m2T=auxmemory2[numTh];
+            double *m1T=context->auxmemory1[numTh];
+            double *m2T=context->auxmemory2[numTh];
             getSubMatrix(m1,r1,c1,ro1,co1,m1T, n1,n1,nCores);        
             getSubMatrix(m2,r2,c2,ro2,co2,m2T, n2,n1,nCores);
             char side = 'R';
@@ -1281,18 +1320,18 @@ void NLTProduct(double *m1,int r1,int ro1,int c1, int co1,double *m2,int r2,int
         int cols2B=n1-cols2A;
 
         if(numTh<posIni+nCores/2){
-                NLTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,rows2A,K1,result,rr,ror,cr,cor,nCores/2,posIni,numTh);
+                NLTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2,c2,co2,rows1A,rows2A,K1,result,rr,ror,cr,cor,nCores/2,posIni,numTh,context);
                 
-                NLTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1B,rows2A,K1,result,rr,ror,cr,cor+rows1A,nCores/2,posIni,numTh);
-                NNTProduct(m2,r2,ro2,c2,co2,m1,r1,ro1+rows1A,c1,co1,rows2A,cols2A,rows1B,K1,1.0,result,rr,ror,cr,cor+rows1A,nCores/2,posIni,numTh);
+                NLTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2,c2,co2+cols2A,rows1B,rows2A,K1,result,rr,ror,cr,cor+rows1A,nCores/2,posIni,numTh,context);
+                NNTProduct(m2,r2,ro2,c2,co2,m1,r1,ro1+rows1A,c1,co1,rows2A,cols2A,rows1B,K1,1.0,result,rr,ror,cr,cor+rows1A,nCores/2,posIni,numTh,context);
 
 
         }else{            
 
-                NLTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1A,rows2B,K1,result,rr,ror+rows2A,cr,cor, nCores/2,posIni+nCores/2,numTh);        
+                NLTProduct(m1,r1,ro1,c1,co1,m2,r2,ro2+rows2A,c2,co2,rows1A,rows2B,K1,result,rr,ror+rows2A,cr,cor, nCores/2,posIni+nCores/2,numTh,context);        
 
-                NLTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,rows2B,K1,result,rr,ror+rows2A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh);                
-                NNTProduct(m2,r2,ro2+rows2A,c2,co2,m1,r1,ro1+rows1A,c1,co1,rows2B,cols2A,rows1B,K1,1.0,result,rr,ror+rows2A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh);                                        
+                NLTProduct(m1,r1,ro1+rows1A,c1,co1+cols1A,m2,r2,ro2+rows2A,c2,co2+cols2A,rows1B,rows2B,K1,result,rr,ror+rows2A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh,context);                
+                NNTProduct(m2,r2,ro2+rows2A,c2,co2,m1,r1,ro1+rows1A,c1,co1,rows2B,cols2A,rows1B,K1,1.0,result,rr,ror+rows2A,cr,cor+rows1A, nCores/2,posIni+nCores/2,numTh,context);                                        
                                     
                 
             
@@ -1370,6 +1409,141 @@ void ParallelVectorMatrix(double *m1,int size,double *m2,double *result, int num
     }    
 }
 
+/**
+ * @brief Rank one update or downdate of a Cholesky factorization.
+ *
+ * Given the lower triangular factor L of a matrix A=LL' (column-major order), it obtains the
+ * factor of A+sign*xx'. The first p elements of x must be zero, so only the columns p,...,n-1
+ * of the factor change. The vector x is overwritten.
+ *
+ * @param L The lower triangular factor (column-major, leading dimension n).
+ * @param n The order of the matrix.
+ * @param p The first element of x distinct than zero.
+ * @param x The vector of the update.
+ * @param sign 1.0 to update (A+xx') or -1.0 to downdate (A-xx').
+ * @return 0 if the new matrix is positive definite, 1 if a downdate failed (the factor is not valid anymore).
+ */
+
+int CholeskyRankOneUpdate(double *L, int n, int p, double *x, double sign){
+    int i, k;
+    double r, c, s, Lkk;
+    for(k=p;k<n;k++){
+        Lkk = L[k*n+k];
+        r = Lkk*Lkk+sign*x[k]*x[k];
+        if(r<=0.0 || Lkk<=0.0) return 1;
+        r = sqrt(r);
+        c = r/Lkk;
+        s = x[k]/Lkk;
+        L[k*n+k] = r;
+        for(i=k+1;i<n;i++){
+            L[k*n+i] = (L[k*n+i]+sign*s*x[i])/c;
+            x[i] = c*x[i]-s*L[k*n+i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Cholesky factorization of a matrix after removing a row and a column.
+ *
+ * Given the factor of a matrix of order n, it obtains the factor of the matrix without the row and
+ * the column p. The result is stored in L with leading dimension n-1.
+ *
+ * @param L The lower triangular factor (column-major, leading dimension n).
+ * @param n The order of the matrix.
+ * @param p The row and column to remove.
+ * @param work Auxiliar array of length n.
+ */
+
+void CholeskyDeleteRow(double *L, int n, int p, double *work){
+    int i, j, m=n-1;
+
+    // The elements of the removed column below the diagonal update the last block
+    for(i=p+1;i<n;i++) work[i-1]=L[p*n+i];
+
+    // Every destination is before its source, so the matrix can be moved in place
+    for(j=0;j<n;j++){
+        if(j==p) continue;
+        for(i=0;i<n;i++){
+            if(i==p) continue;
+            L[(j<p ? j : j-1)*m+(i<p ? i : i-1)]=L[j*n+i];
+        }
+    }
+
+    // Adding a positive semidefinite term never fails
+    if(p<m) CholeskyRankOneUpdate(L,m,p,work,1.0);
+}
+
+/**
+ * @brief Cholesky factorization of a matrix after adding a last row and column.
+ *
+ * Given the factor of a matrix of order n, it obtains the factor of the matrix with a new last row
+ * and column. The result is stored in L with leading dimension n+1, so L must have space for (n+1)^2 elements.
+ *
+ * @param L The lower triangular factor (column-major, leading dimension n).
+ * @param n The order of the matrix.
+ * @param column The first n elements of the new column (they are overwritten).
+ * @param diag The new diagonal element.
+ * @return 0 if the new matrix is positive definite, 1 otherwise (the factor is not valid anymore).
+ */
+
+int CholeskyAppendRow(double *L, int n, double *column, double diag){
+    int i, j, m=n+1, inc=1;
+    char uplo='L', trans='N', unit='N';
+    double d=diag;
+
+    // Every destination is after its source, so the matrix is moved in place starting by the end
+    for(j=n-1;j>=0;j--){
+        for(i=n-1;i>=0;i--) L[j*m+i]=L[j*n+i];
+        L[j*m+n]=0.0;
+    }
+
+    // The new row is L^-1 column
+    if(n>0) dtrsv_(&uplo,&trans,&unit,&n,L,&m,column,&inc);
+    for(j=0;j<n;j++){
+        L[j*m+n]=column[j];
+        L[n*m+j]=0.0;
+        d-=column[j]*column[j];
+    }
+    if(d<=0.0) return 1;
+    L[n*m+n]=sqrt(d);
+    return 0;
+}
+
+/**
+ * @brief It solves a bordered linear system using the Cholesky factor of its first block.
+ *
+ * It solves the system of order n+1 [A y; y' 0] x = b where the factor of A is known. The last pivot of this
+ * matrix is not positive, so it uses the same factor that dpotrf leaves in ParallelLinearSystem when this
+ * pivot fails, [L 0; l' -l'l] with l=L^-1 y, and the result is the same that ParallelLinearSystem obtains.
+ *
+ * @param L The lower triangular factor of A (column-major, leading dimension n).
+ * @param n The order of A.
+ * @param y The border of the matrix (length n).
+ * @param b The independent term (length n+1), it is overwritten with the solution.
+ * @param work Auxiliar array of length n.
+ */
+
+void BorderedCholeskySolve(double *L, int n, double *y, double *b, double *work){
+    int i, inc=1;
+    char uplo='L', notrans='N', trans='T', unit='N';
+    double q=0.0, z=0.0;
+
+    memcpy(work,y,n*sizeof(double));
+    dtrsv_(&uplo,&notrans,&unit,&n,L,&n,work,&inc);
+    for(i=0;i<n;i++) q+=work[i]*work[i];
+
+    // Forward substitution with [L 0; l' -q]
+    dtrsv_(&uplo,&notrans,&unit,&n,L,&n,b,&inc);
+    for(i=0;i<n;i++) z+=work[i]*b[i];
+    b[n]=(b[n]-z)/(-q);
+
+    // Backward substitution with [L' l; 0 -q]
+    b[n]=b[n]/(-q);
+    for(i=0;i<n;i++) b[i]-=work[i]*b[n];
+    dtrsv_(&uplo,&trans,&unit,&n,L,&n,b,&inc);
+}
+
 /**
  * @endcond
  */
@@ -46,6 +46,7 @@
 #include "budgeted-train.h"
 #include "kernels.h"
 #include "ParallelAlgorithms.h"
+#include "LIBIRWLS-predict.h"
 
 
 /**
@@ -100,6 +101,78 @@ int* randomCentroids(svm_dataset dataset,properties props){
 }
 
 
+/** @brief Weights used to sort the centroids in modelCentroids. */
+static double *centroidWeight;
+#pragma omp threadprivate(centroidWeight)
+
+/**
+ * @brief It compares two centroids by the absolute value of their weights (largest first).
+ */
+
+static int compareCentroids(const void *a, const void *b){
+    double wa=fabs(centroidWeight[*((const int *) a)]), wb=fabs(centroidWeight[*((const int *) b)]);
+    if(wa>wb) return -1;
+    if(wa<wb) return 1;
+    return (*((const int *) a)>*((const int *) b))-(*((const int *) a)<*((const int *) b));
+}
+
+/**
+ * @brief Selection of centroids from a trained budgeted model.
+ *
+ * The centroids of the model are matched with the samples of the training set by their features. If there are more
+ * centroids than the budget, the centroids with the largest weights are selected. If there are less, the rest are
+ * selected at random.
+ *
+ * @param dataset The training set.
+ * @param mymodel The trained model (svm_sample layout, as it is loaded by readModel).
+ * @param props The struct with the training parameters.
+ * @param init Array of props.size elements to store the initial weight of every centroid.
+ * @return The indexes of the centroids.
+ */
+
+int* modelCentroids(svm_dataset dataset, model *mymodel, properties props, double *init){
+    // The average of every class (samples l and l+1) can also be a centroid
+    svm_dataset withAverages = dataset;
+    withAverages.l = dataset.l+2;
+    int *match = matchSupportVectors(withAverages,mymodel);
+    int *order = (int *) malloc(mymodel->nSVs*sizeof(int));
+    char *used = (char *) calloc(dataset.l+2,sizeof(char));
+    int* centroids = (int *) malloc(props.size*sizeof(int));
+    int i, nMatched=0, nCentroids=0;
+
+    for (i=0;i<mymodel->nSVs;i++) if(match[i] != -1) order[nMatched++]=i;
+    centroidWeight=mymodel->weights;
+    qsort(order,nMatched,sizeof(int),compareCentroids);
+
+    for (i=0;i<nMatched && nCentroids<props.size;i++){
+        centroids[nCentroids]=match[order[i]];
+        init[nCentroids]=mymodel->weights[order[i]];
+        used[match[order[i]]]=1;
+        nCentroids++;
+    }
+    if(props.verbose==1) printf("Initial model: %d of %d centroids found in the training set\n",nMatched,mymodel->nSVs);
+
+    // The rest of the budget is filled with random samples
+    if(nCentroids<props.size){
+        properties allSamples=props;
+        allSamples.size=dataset.l;
+        int *permut = randomCentroids(dataset,allSamples);
+        for (i=0;i<dataset.l && nCentroids<props.size;i++){
+            if(used[permut[i]]==0){
+                centroids[nCentroids]=permut[i];
+                init[nCentroids]=0.0;
+                nCentroids++;
+            }
+        }
+        free(permut);
+    }
+
+    free(match);
+    free(order);
+    free(used);
+    return centroids;
+}
+
 /**
  * @brief Sparse Greedy Matrix Approximation algorithm
  *
@@ -142,7 +215,9 @@ int* SGMA(svm_dataset dataset,properties props){
     double *miKSM;
     double *miKNC;
     double *miZ;
+    double *KSCrow;
     double value,L3,IL3;
+    kernelEvaluator kernel = trainEvaluator(dataset,props);
     double *tmp1,*tmp2;
     int indexSample=0;
 
@@ -177,10 +252,10 @@ int* SGMA(svm_dataset dataset,properties props){
             miKSM=KSM[i];
             miZ=Z[i];
 
-            for(e=0;e<dataset.l;e++) miKSM[e]=kernelFunction(dataset,indexes[i],e,props);            
+            kernelBlock(dataset,&indexes[i],1,NULL,dataset.l,props,&miKSM);
 
             for(e=0;e<size;e++){
-                value=kernelFunction(dataset,indexes[i],centroids[e],props);
+                value=kernelEvaluate(&kernel,indexes[i],centroids[e]);
                 miKNC[e]=value;
                 miZ[e]=value;
             }
@@ -224,7 +299,7 @@ int* SGMA(svm_dataset dataset,properties props){
                 centroids[size]=dataset.l;
             }else{
                 centroids[size]=dataset.l+1;
-                KNC[0][0]=kernelFunction(dataset,centroids[0],centroids[1],props);
+                KNC[0][0]=kernelEvaluate(&kernel,centroids[0],centroids[1]);
             }
             value=1.0;
             bestBasis=0;
@@ -238,18 +313,15 @@ int* SGMA(svm_dataset dataset,properties props){
             if(size>1) printf("Best Error Descent %f, Data with index %d is centroid %d\n",value,centroids[size],size);
         }
 
-        #pragma omp parallel default(shared) private(i)
-        {
-        #pragma omp for schedule(static)	
-        for(i=0;i<dataset.l;i++) KSC[size*(dataset.l)+i]=kernelFunction(dataset,i,centroids[size],props);
-        }
+        KSCrow=&KSC[size*(dataset.l)];
+        kernelBlock(dataset,&centroids[size],1,NULL,dataset.l,props,&KSCrow);
 
         if(size==0){
-            iKCTmp[0]=pow(kernelFunction(dataset,centroids[size],centroids[size],props)+0.000001,0.5);
+            iKCTmp[0]=pow(kernelEvaluate(&kernel,centroids[size],centroids[size])+0.000001,0.5);
             invKCTmp[0]=1.0/iKCTmp[0];
         }else{
             ParallelVectorMatrixT(KNC[bestBasis],size,invKC,L2,props.Threads);
-            L3=kernelFunction(dataset,centroids[size],centroids[size],props)+0.00001;
+            L3=kernelEvaluate(&kernel,centroids[size],centroids[size])+0.00001;
             for(i=0;i<size;i++) L3 = L3 - (L2[i]*L2[i]);
             L3=pow(L3,0.5);
             IL3=1.0/L3;
@@ -318,43 +390,46 @@ int* SGMA(svm_dataset dataset,properties props){
  * @param dataset The training set.
  * @param indexes The indexes of the centroids selected by the SGMA algorithm.
  * @param props The struct with the training parameters.
+ * @param init The initial weights of every centroid (NULL to start from zero).
+ * @param deadline It returns 1 if the training stopped on props.Deadline and 0 otherwise (NULL if it is not needed).
  * @return The weights of every centroid.
  */
 
-double* IRWLSpar(svm_dataset dataset, int* indexes,properties props){
+double* IRWLSpar(svm_dataset dataset, int* indexes,properties props,double *init,int *deadline,solverContext *context){
 
+    double trainingStart = omp_get_wtime();
+    int deadlineReached = 0;
     int i;
-    double kernelvalue;
+
+    // Temporal memory of the linear algebra functions, a private context is created if none is given
+    solverContext *ownContext = NULL;
+    if(context == NULL){
+        ownContext = initSolverContext(props.Threads,props.size);
+        context = ownContext;
+    }
 
     double *KC=(double *) calloc(props.size*props.size,sizeof(double));
     double *KSC=(double *) calloc(dataset.l*props.size,sizeof(double));
     double *KSCA=(double *) calloc(dataset.l*props.size,sizeof(double));
     double *Da=(double *) calloc(dataset.l,sizeof(double));
     double *Day=(double *) calloc(dataset.l,sizeof(double));
+    double **Krows=(double **) calloc(dataset.l,sizeof(double *));
 
 
-    #pragma omp parallel for
-    for (i=0;i<props.size;i++){
-        int j=0;
-        for (j=0;j<props.size;j++){
-            KC[i*(props.size)+j]=kernelFunction(dataset,indexes[i], indexes[j], props);
-            if(i==j) KC[i*(props.size)+j]+=pow(10,-5);
-        }
-    }
+    for (i=0;i<props.size;i++) Krows[i]=&KC[i*(props.size)];
+    kernelBlock(dataset,indexes,props.size,indexes,props.size,props,Krows);
+    for (i=0;i<props.size;i++) KC[i*(props.size)+i]+=pow(10,-5);
 
 
     double M=10000.0;
 
-    #pragma omp parallel for
+    for (i=0;i<dataset.l;i++) Krows[i]=&KSC[i*(props.size)];
+    kernelBlock(dataset,NULL,dataset.l,indexes,props.size,props,Krows);
+    memcpy(KSCA,KSC,dataset.l*(props.size)*sizeof(double));
+
     for (i=0;i<dataset.l;i++){
         Da[i]=M;
         Day[i]=dataset.y[i]*M;
-        int j = 0;
-        for (j=0;j<props.size;j++){
-            kernelvalue=kernelFunction(dataset,i, indexes[j], props);
-            KSC[i*(props.size)+j]=kernelvalue;
-            KSCA[i*(props.size)+j]=kernelvalue;
-        }
     }
     
 
@@ -370,6 +445,14 @@ double* IRWLSpar(svm_dataset dataset, int* indexes,properties props){
     double *e = (double *) calloc(dataset.l,sizeof(double));
     int *indKSCA = (int *) calloc(dataset.l,sizeof(int));
 
+    int warm=0;
+    if(init != NULL){
+        memcpy(beta,init,(props.size)*sizeof(double));
+        memcpy(betaNew,init,(props.size)*sizeof(double));
+        memcpy(betaBest,init,(props.size)*sizeof(double));
+        warm=1;
+    }
+
 
     char notrans='N';
     char trans='T';
@@ -397,38 +480,42 @@ double* IRWLSpar(svm_dataset dataset, int* indexes,properties props){
 	trueSVs=dataset.l;
 	
     while( (iter<max_iter) && (deltaW/normW > 1e-6) && (itersSinceBestDW<5) ){
-
-        memcpy(K1,KC,(props.size)*(props.size)*sizeof(double));
-
-		if(trueSVs>0){
-			#pragma omp parallel for
-			for (i=0;i<tamDgemm;i++){
-				int InitCol=round(i*props.size/tamDgemm);
-				int FinalCol=round((i+1)*props.size/tamDgemm)-1;			
-				int lengthCol=FinalCol-InitCol+1;
-				if(lengthCol>0){
-					dgemm_(&notrans, &notrans, &(lengthCol), &(row), &(trueSVs), &factor, &KSCA[InitCol], &(props.size), Day, &trueSVs, &zfactor, &K2[InitCol], &(props.size));
-					dgemm_(&notrans, &trans, &(lengthCol), &(props.size), &(trueSVs), &factor, &KSCA[InitCol], &(props.size), KSCA, &props.size, &factor, &K1[InitCol], &(props.size));
+        // With initial weights the first iteration only calculates the error of those weights
+        if(warm==0){
+
+            memcpy(K1,KC,(props.size)*(props.size)*sizeof(double));
+
+			if(trueSVs>0){
+				#pragma omp parallel for
+				for (i=0;i<tamDgemm;i++){
+					int InitCol=round(i*props.size/tamDgemm);
+					int FinalCol=round((i+1)*props.size/tamDgemm)-1;			
+					int lengthCol=FinalCol-InitCol+1;
+					if(lengthCol>0){
+						dgemm_(&notrans, &notrans, &(lengthCol), &(row), &(trueSVs), &factor, &KSCA[InitCol], &(props.size), Day, &trueSVs, &zfactor, &K2[InitCol], &(props.size));
+						dgemm_(&notrans, &trans, &(lengthCol), &(props.size), &(trueSVs), &factor, &KSCA[InitCol], &(props.size), KSCA, &props.size, &factor, &K1[InitCol], &(props.size));
+					}
 				}
+			}else{
+				memset(K2,0.0,props.size*sizeof(double));
 			}
-		}else{
-			memset(K2,0.0,props.size*sizeof(double));
-		}
 
-        memset(betaNew,0.0,props.size*sizeof(double));
+            memset(betaNew,0.0,props.size*sizeof(double));
 
-        omp_set_num_threads(thLS);
-        ParallelLinearSystem(K1,props.size,props.size,0,0,K2,props.size,1,0,0,props.size,1,betaNew,props.size,1,0,0,thLS);
-        omp_set_num_threads(props.Threads);
-        deltaW=0.0;        
-        normW=0.0;
+            omp_set_num_threads(thLS);
+            ParallelLinearSystem(K1,props.size,props.size,0,0,K2,props.size,1,0,0,props.size,1,betaNew,props.size,1,0,0,thLS,context);
+            omp_set_num_threads(props.Threads);
+            deltaW=0.0;        
+            normW=0.0;
 
-        for (i=0;i<props.size;i++){
-            deltaW += pow(betaNew[i]-beta[i],2);
-            normW += pow(betaNew[i],2);
-            beta[i]=betaNew[i];
-        }
+            for (i=0;i<props.size;i++){
+                deltaW += pow(betaNew[i]-beta[i],2);
+                normW += pow(betaNew[i],2);
+                beta[i]=betaNew[i];
+            }
 
+        }
+        warm=0;
 
         memcpy(e,dataset.y,dataset.l*sizeof(double));
 
@@ -486,13 +573,22 @@ double* IRWLSpar(svm_dataset dataset, int* indexes,properties props){
         }else{
             itersSinceBestDW+=1;
         }
+
+        // Deadline: the training stops and the best weights found so far are returned
+        if(props.Deadline>0.0 && omp_get_wtime()-trainingStart>=props.Deadline){
+            deadlineReached=1;
+            if(props.verbose==1) printf("The deadline has been reached\n");
+            break;
+        }
     }
+    if(deadline != NULL) *deadline=deadlineReached;
 
     free(KC);
     free(KSC);
     free(KSCA);
     free(Da);
     free(Day);
+    free(Krows);
 
     free(K1);
     free(K2);
@@ -500,6 +596,7 @@ double* IRWLSpar(svm_dataset dataset, int* indexes,properties props){
     free(betaNew);
     free(e);
     free(indKSCA);
+    if(ownContext != NULL) freeSolverContext(ownContext);
 
     return betaBest;
 }
@@ -522,21 +619,24 @@ model calculateBudgetedModel(properties props, svm_dataset dataset, int *centroi
     classifier.sparse = dataset.sparse;
     classifier.maxdim = dataset.maxdim;
     classifier.nSVs = props.size;
+    classifier.deadline = 0;
     classifier.bias=0.0;
     classifier.kernelType = props.kernelType;
         
+    classifier.single = 0;
+    classifier.xs = NULL;
+    classifier.featuresSingle = NULL;
+    classifier.csr = 0;
+    classifier.rowPtr = NULL;
+    classifier.indexes = NULL;
+    classifier.values = NULL;
+    classifier.dense = 0;
+    classifier.matrix = NULL;
+    classifier.stride = 0;
+        
     int nElem=0;
-    svm_sample *iteratorSample;
-    svm_sample *classifierSample;
     int i;
-    for (i =0;i<props.size;i++){
-        iteratorSample = dataset.x[centroids[i]];
-        while (iteratorSample->index != -1){
-        	  ++iteratorSample;
-            ++nElem;
-        }
-        ++nElem;
-    }
+    for (i =0;i<props.size;i++) nElem += sampleLength(dataset,centroids[i])+1;
 
     classifier.nElem = nElem;
     classifier.weights = (double *) calloc(props.size,sizeof(double));
@@ -551,24 +651,91 @@ model calculateBudgetedModel(properties props, svm_dataset dataset, int *centroi
     for (i =0;i<props.size;i++){
         classifier.quadratic_value[i]=dataset.quadratic_value[centroids[i]];
         classifier.x[i] = &classifier.features[featureIt];
-        iteratorSample = dataset.x[centroids[i]];
-        classifierSample = classifier.x[i];
-        while (iteratorSample->index != -1){
-            classifierSample->index = iteratorSample->index;
-            classifierSample->value = iteratorSample->value;
-            ++classifierSample;
-            ++iteratorSample;
-            ++featureIt;
-        }
-
-        classifierSample->index = iteratorSample->index;
-            
-        ++featureIt;
+        copySample(dataset,centroids[i],classifier.x[i]);
+        featureIt += sampleLength(dataset,centroids[i])+1;
     }
 
     return classifier;
 }
 
+/**
+ * @brief k-fold cross validation of the budgeted SVM.
+ *
+ * The dataset is loaded once and every fold is a subset of it that shares its features and norms.
+ * The folds are trained one after another, every one of them using all the threads. It prints the
+ * accuracy and the training time of every fold and the average accuracy.
+ *
+ * @param dataset The training set.
+ * @param props The values of the training parameters (props.Folds is the number of folds).
+ * @return The average accuracy.
+ */
+
+double crossValidationBudgeted(svm_dataset dataset,properties props){
+    int *fold = crossValidationFolds(dataset.l,props.Folds);
+    int *trainIndexes = (int *) malloc(dataset.l*sizeof(int));
+    int *testIndexes = (int *) malloc(dataset.l*sizeof(int));
+    int f, i;
+    double average=0.0;
+
+    properties foldProps = props;
+    foldProps.verbose = 0;
+
+    predictProperties testProps;
+    testProps.Labels = 1;
+    testProps.Threads = props.Threads;
+    testProps.Soft = 0;
+    testProps.file = props.file;
+    testProps.separator = props.separator;
+    testProps.verbose = 0;
+    testProps.FastExp = props.FastExp;
+    testProps.Single = props.Single;
+    testProps.CSR = props.CSR;
+
+    // The folds are trained one after another with the same context
+    solverContext *context = initSolverContext(props.Threads,props.size);
+
+    for (f=0;f<props.Folds;f++){
+        int nTrain=0, nTest=0;
+        for (i=0;i<dataset.l;i++){
+            if(fold[i]==f) testIndexes[nTest++]=i;
+            else trainIndexes[nTrain++]=i;
+        }
+        svm_dataset trainSet = subsetDataset(dataset,trainIndexes,nTrain);
+        svm_dataset testSet = subsetDataset(dataset,testIndexes,nTest);
+
+        struct timeval time1, time2;
+        gettimeofday(&time1, NULL);
+        int *centroids;
+        if (props.algorithm==0){
+            centroids=randomCentroids(trainSet,foldProps);
+        }else{
+            centroids=SGMA(trainSet,foldProps);
+        }
+        omp_set_num_threads(props.Threads);
+        double *W = IRWLSpar(trainSet,centroids,foldProps,NULL,NULL,context);
+        model classifier = calculateBudgetedModel(foldProps,trainSet,centroids,W);
+        free(centroids);
+        free(W);
+        gettimeofday(&time2, NULL);
+
+        double accuracy = modelAccuracy(testSet,&classifier,testProps);
+        average += accuracy/props.Folds;
+        printf("Fold %d: accuracy %f, %d support vectors, trained in %ld miliseconds\n",f+1,accuracy,classifier.nSVs,((time2.tv_sec-time1.tv_sec)*1000+(time2.tv_usec-time1.tv_usec)/1000));
+
+        freeModel(classifier);
+        freeDataset(trainSet);
+        freeDataset(testSet);
+    }
+    printf("Cross validation accuracy: %f\n",average);
+
+    freeSolverContext(context);
+
+    free(fold);
+    free(trainIndexes);
+    free(testIndexes);
+    return average;
+}
+
 /**
  * @brief It parses input command line to extract the parameters of the budgeted algorithm.
  *
@@ -592,6 +759,22 @@ properties parseTrainParameters(int* argc, char*** argv) {
     props.file = 1;
     props.separator = ",";
     props.verbose = 1;
+    props.CacheSize = 0.0;
+    props.Shrinking = 0;
+    props.WorkingSetPolicy = 0;
+    props.AdaptiveSize = 0;
+    props.InitModel = NULL;
+    props.Checkpoint = NULL;
+    props.CheckpointInterval = 10;
+    props.CheckpointSeconds = 0.0;
+    props.Resume = NULL;
+    props.Deadline = 0.0;
+    props.Multiclass = 0;
+    props.CPath = NULL;
+    props.Folds = 0;
+    props.FastExp = 0;
+    props.Single = 0;
+    props.CSR = 0;
 
     int i,j;
     for (i = 1; i < *argc; ++i) {
@@ -625,13 +808,58 @@ properties parseTrainParameters(int* argc, char*** argv) {
             props.separator = param_value;
         } else if (strcmp(param_name, "v") == 0) {
             props.verbose = atoi(param_value);
+        } else if (strcmp(param_name, "V") == 0) {
+            props.Folds = atoi(param_value);
+        } else if (strcmp(param_name, "i") == 0) {
+            props.InitModel = param_value;
+        } else if (strcmp(param_name, "T") == 0) {
+            props.Deadline = atof(param_value);
+        } else if (strcmp(param_name, "M") == 0) {
+            if (strcmp(param_value, "ovo") == 0) {
+                props.Multiclass = 0;
+            } else if (strcmp(param_value, "ovr") == 0) {
+                props.Multiclass = 1;
+            } else {
+                fprintf(stderr, "Unknown multi-class decomposition %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "x") == 0) {
+            props.FastExp = atoi(param_value);
+        } else if (strcmp(param_name, "P") == 0) {
+            if (strcmp(param_value, "single") == 0) {
+                props.Single = 1;
+            } else if (strcmp(param_value, "double") == 0) {
+                props.Single = 0;
+            } else {
+                fprintf(stderr, "Unknown precision %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "L") == 0) {
+            if (strcmp(param_value, "csr") == 0) {
+                props.CSR = 1;
+            } else if (strcmp(param_value, "samples") == 0) {
+                props.CSR = 0;
+            } else {
+                fprintf(stderr, "Unknown layout %s\n",param_value);
+                exit(2);
+            }
         } else {
             fprintf(stderr, "Unknown parameter %s\n",param_name);
             printBudgetedInstructions();
             exit(2);
         }
     }
+
+    if (props.Single==1 && props.CSR==1) {
+        fprintf(stderr, "The csr layout is only available in double precision\n");
+        exit(2);
+    }
   
+    if (props.Folds>0 && (props.InitModel != NULL || props.CPath != NULL)) {
+        fprintf(stderr, "The cross validation can not be used with an initial model or a list of costs\n");
+        exit(2);
+    }
+
     for (j = 1; i + j - 1 < *argc; ++j) {
         (*argv)[j] = (*argv)[i + j - 1];
     }
@@ -650,7 +878,8 @@ properties parseTrainParameters(int* argc, char*** argv) {
 void printBudgetedInstructions(void) {
     fprintf(stderr, "budgeted-train: This software train the sparse SVM on the given training set ");
     fprintf(stderr, "and generages a model for futures prediction use.\n\n");
-    fprintf(stderr, "Usage: budgeted-train [options] training_set_file model_file\n\n");
+    fprintf(stderr, "Usage: budgeted-train [options] training_set_file model_file\n");
+    fprintf(stderr, "       budgeted-train -V folds [options] training_set_file\n\n");
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -k kernel type: (default 1)\n");
     fprintf(stderr, "       0 -- Linear kernel u'*v\n");
@@ -663,6 +892,22 @@ void printBudgetedInstructions(void) {
     fprintf(stderr, "  -a Algorithm: Algorithm for centroids selection (default 1)\n");
     fprintf(stderr, "       0 -- Random Selection\n");
     fprintf(stderr, "       1 -- SGMA (Sparse Greedy Matrix Approximation)\n");
+    fprintf(stderr, "  -V folds: k-fold cross validation, it prints the accuracy of every fold and no model is saved (default 0)\n");
+    fprintf(stderr, "  -i initial model: model file whose centroids and weights are the starting point (default none)\n");
+    fprintf(stderr, "       its centroids are found in the training set by their features\n");
+    fprintf(stderr, "  -T deadline: maximum training time in seconds, the best weights found so far are saved (default 0, no limit)\n");
+    fprintf(stderr, "  -M multi-class decomposition: used when the training set has more than two classes (default ovo)\n");
+    fprintf(stderr, "       ovo -- One-vs-one, a binary classifier for every pair of classes\n");
+    fprintf(stderr, "       ovr -- One-vs-rest, a binary classifier for every class against the rest\n");
+    fprintf(stderr, "  -x exponential of the rbf kernel: (default 0)\n");
+    fprintf(stderr, "       0 -- Math library\n");
+    fprintf(stderr, "       1 -- Vectorized approximation (relative error below 1e-7)\n");
+    fprintf(stderr, "  -P precision: storage of the features (default double)\n");
+    fprintf(stderr, "       double -- Double precision\n");
+    fprintf(stderr, "       single -- Single precision (half of the memory, kernels are accumulated in double precision)\n");
+    fprintf(stderr, "  -L layout: layout of the features in memory (default samples)\n");
+    fprintf(stderr, "       samples -- Array of (index, value) structs per sample, dense datasets use an aligned dense matrix\n");
+    fprintf(stderr, "       csr -- CSR format, indexes and values in separate arrays (only double precision)\n");
     fprintf(stderr, "  -f file format: (default 1)\n"); 
     fprintf(stderr, "       0 -- CSV format (comma separator)\n");
     fprintf(stderr, "       1 -- libsvm format\n");   
@@ -0,0 +1,297 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @brief Implementation of the checkpoints of the full IRWLS solver.
+ *
+ * It implements the interface defined by checkpoint.h. See checkpoint.h for a detailed description of its functions.
+ *
+ * @file checkpoint.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ *
+ * @see checkpoint.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "checkpoint.h"
+
+/**
+ * @cond
+ */
+
+/** @brief First bytes of a checkpoint file. */
+#define CHECKPOINT_MAGIC "IRWLSCK"
+
+/** @brief Version of the checkpoint file format. */
+#define CHECKPOINT_VERSION 1
+
+/**
+ * @brief It creates a checkpoint writer.
+ *
+ * @param file The checkpoint file.
+ * @param l The number of samples of the training set.
+ * @return The writer.
+ */
+
+checkpointWriter *initCheckpointWriter(char *file, int l){
+    checkpointWriter *writer = (checkpointWriter *) calloc(1,sizeof(checkpointWriter));
+    writer->file = file;
+    writer->temporary = (char *) malloc((strlen(file)+5)*sizeof(char));
+    sprintf(writer->temporary,"%s.tmp",file);
+    writer->state.beta = (double *) malloc((l+1)*sizeof(double));
+    writer->state.betaBest = (double *) malloc((l+1)*sizeof(double));
+    writer->state.e = (double *) malloc(l*sizeof(double));
+    writer->state.SW = (int *) malloc(l*sizeof(int));
+    writer->state.active = (int *) malloc(l*sizeof(int));
+    writer->state.stable = (int *) malloc(l*sizeof(int));
+    writer->state.shrunk = (char *) malloc(l*sizeof(char));
+    writer->running = 0;
+    writer->written = 0;
+    return writer;
+}
+
+/**
+ * @brief Body of the thread that writes a checkpoint.
+ */
+
+static void *writeCheckpoint(void *arg){
+    checkpointWriter *writer = (checkpointWriter *) arg;
+    FILE *Out = fopen(writer->temporary, "wb");
+    int failed = (Out == NULL);
+    if(Out != NULL){
+        failed = storeCheckpoint(&writer->state,Out);
+        if(fclose(Out) != 0) failed = 1;
+    }
+    if(failed==0 && rename(writer->temporary,writer->file) != 0) failed = 1;
+    if(failed==1){
+        fprintf(stderr, "Warning: the checkpoint could not be written in %s\n",writer->file);
+    }else{
+        writer->written++;
+    }
+    return NULL;
+}
+
+/**
+ * @brief It writes a checkpoint in the background.
+ *
+ * The state is copied and a thread writes it to the file. If the previous checkpoint is still
+ * being written, it waits for it first.
+ *
+ * @param writer The writer.
+ * @param state The state of the solver.
+ */
+
+void saveCheckpoint(checkpointWriter *writer, trainCheckpoint *state){
+    if(writer->running==1){
+        pthread_join(writer->thread,NULL);
+        writer->running=0;
+    }
+
+    trainCheckpoint *copy = &writer->state;
+    int l = state->l;
+    copy->l = l;
+    copy->C = state->C;
+    copy->Kgamma = state->Kgamma;
+    copy->kernelType = state->kernelType;
+    copy->iter = state->iter;
+    copy->SinceBest = state->SinceBest;
+    copy->bestNorm = state->bestNorm;
+    copy->MaxWorkingSize = state->MaxWorkingSize;
+    copy->nSW = state->nSW;
+    copy->nSIn = state->nSIn;
+    copy->shrinking = state->shrinking;
+    copy->nActive = state->nActive;
+    copy->nShrunk = state->nShrunk;
+    copy->seed = state->seed;
+    memcpy(copy->beta,state->beta,(l+1)*sizeof(double));
+    memcpy(copy->betaBest,state->betaBest,(l+1)*sizeof(double));
+    memcpy(copy->e,state->e,l*sizeof(double));
+    memcpy(copy->SW,state->SW,state->nSW*sizeof(int));
+    memcpy(copy->active,state->active,state->nActive*sizeof(int));
+    memcpy(copy->stable,state->stable,l*sizeof(int));
+    memcpy(copy->shrunk,state->shrunk,l*sizeof(char));
+
+    if(pthread_create(&writer->thread,NULL,writeCheckpoint,writer) == 0){
+        writer->running=1;
+    }else{
+        // Without a thread the checkpoint is written synchronously
+        writeCheckpoint(writer);
+    }
+}
+
+/**
+ * @brief It waits for the last write and frees the writer.
+ *
+ * @param writer The writer.
+ * @return The number of checkpoints that have been written.
+ */
+
+int freeCheckpointWriter(checkpointWriter *writer){
+    if(writer->running==1) pthread_join(writer->thread,NULL);
+    int written = writer->written;
+    free(writer->temporary);
+    free(writer->state.beta);
+    free(writer->state.betaBest);
+    free(writer->state.e);
+    free(writer->state.SW);
+    free(writer->state.active);
+    free(writer->state.stable);
+    free(writer->state.shrunk);
+    free(writer);
+    return written;
+}
+
+/**
+ * @brief It stores a checkpoint into a file.
+ *
+ * @param state The state of the solver.
+ * @param Output The file.
+ * @return 0 if the checkpoint was written, 1 on a write error.
+ */
+
+int storeCheckpoint(trainCheckpoint *state, FILE *Output){
+    int version = CHECKPOINT_VERSION;
+    size_t aux = 0, expected = 0;
+    int l = state->l;
+
+    aux+=fwrite(CHECKPOINT_MAGIC, sizeof(char), 8, Output); expected+=8;
+    aux+=fwrite(&version, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->l, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->C, sizeof(double), 1, Output); expected++;
+    aux+=fwrite(&state->Kgamma, sizeof(double), 1, Output); expected++;
+    aux+=fwrite(&state->kernelType, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->iter, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->SinceBest, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->bestNorm, sizeof(double), 1, Output); expected++;
+    aux+=fwrite(&state->MaxWorkingSize, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->nSW, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->nSIn, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->shrinking, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->nActive, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->nShrunk, sizeof(int), 1, Output); expected++;
+    aux+=fwrite(&state->seed, sizeof(unsigned int), 1, Output); expected++;
+    aux+=fwrite(state->beta, sizeof(double), l+1, Output); expected+=l+1;
+    aux+=fwrite(state->betaBest, sizeof(double), l+1, Output); expected+=l+1;
+    aux+=fwrite(state->e, sizeof(double), l, Output); expected+=l;
+    aux+=fwrite(state->SW, sizeof(int), state->nSW, Output); expected+=state->nSW;
+    aux+=fwrite(state->active, sizeof(int), state->nActive, Output); expected+=state->nActive;
+    aux+=fwrite(state->stable, sizeof(int), l, Output); expected+=l;
+    aux+=fwrite(state->shrunk, sizeof(char), l, Output); expected+=l;
+    if(fflush(Output) != 0) return 1;
+    return (aux != expected);
+}
+
+/**
+ * @brief It reads count elements or it stops the program if the file is truncated.
+ */
+
+static void readCheckpointField(void *ptr, size_t size, size_t count, FILE *Input){
+    if(fread(ptr, size, count, Input) != count){
+        fprintf(stderr, "Error: The checkpoint file is truncated\n");
+        exit(2);
+    }
+}
+
+/**
+ * @brief It loads a checkpoint from a file.
+ *
+ * It allocates the arrays of the state, they must be released with freeCheckpoint.
+ *
+ * @param state The struct to load the state.
+ * @param Input The file.
+ */
+
+void readCheckpoint(trainCheckpoint *state, FILE *Input){
+    char magic[8];
+    int version;
+
+    readCheckpointField(magic, sizeof(char), 8, Input);
+    if(memcmp(magic,CHECKPOINT_MAGIC,8) != 0){
+        fprintf(stderr, "Error: The file is not a checkpoint\n");
+        exit(2);
+    }
+    readCheckpointField(&version, sizeof(int), 1, Input);
+    if(version != CHECKPOINT_VERSION){
+        fprintf(stderr, "Error: Unknown checkpoint version %d\n",version);
+        exit(2);
+    }
+    readCheckpointField(&state->l, sizeof(int), 1, Input);
+    readCheckpointField(&state->C, sizeof(double), 1, Input);
+    readCheckpointField(&state->Kgamma, sizeof(double), 1, Input);
+    readCheckpointField(&state->kernelType, sizeof(int), 1, Input);
+    readCheckpointField(&state->iter, sizeof(int), 1, Input);
+    readCheckpointField(&state->SinceBest, sizeof(int), 1, Input);
+    readCheckpointField(&state->bestNorm, sizeof(double), 1, Input);
+    readCheckpointField(&state->MaxWorkingSize, sizeof(int), 1, Input);
+    readCheckpointField(&state->nSW, sizeof(int), 1, Input);
+    readCheckpointField(&state->nSIn, sizeof(int), 1, Input);
+    readCheckpointField(&state->shrinking, sizeof(int), 1, Input);
+    readCheckpointField(&state->nActive, sizeof(int), 1, Input);
+    readCheckpointField(&state->nShrunk, sizeof(int), 1, Input);
+    readCheckpointField(&state->seed, sizeof(unsigned int), 1, Input);
+
+    int l = state->l;
+    if(l<=0 || state->nSW<0 || state->nSW>l || state->nActive<0 || state->nActive>l){
+        fprintf(stderr, "Error: The checkpoint file is corrupted\n");
+        exit(2);
+    }
+    state->beta = (double *) malloc((l+1)*sizeof(double));
+    state->betaBest = (double *) malloc((l+1)*sizeof(double));
+    state->e = (double *) malloc(l*sizeof(double));
+    state->SW = (int *) malloc(l*sizeof(int));
+    state->active = (int *) malloc(l*sizeof(int));
+    state->stable = (int *) malloc(l*sizeof(int));
+    state->shrunk = (char *) malloc(l*sizeof(char));
+    readCheckpointField(state->beta, sizeof(double), l+1, Input);
+    readCheckpointField(state->betaBest, sizeof(double), l+1, Input);
+    readCheckpointField(state->e, sizeof(double), l, Input);
+    readCheckpointField(state->SW, sizeof(int), state->nSW, Input);
+    readCheckpointField(state->active, sizeof(int), state->nActive, Input);
+    readCheckpointField(state->stable, sizeof(int), l, Input);
+    readCheckpointField(state->shrunk, sizeof(char), l, Input);
+}
+
+/**
+ * @brief Free checkpoint memory
+ *
+ * Free the arrays allocated by readCheckpoint.
+ * @param state The state.
+ */
+
+void freeCheckpoint(trainCheckpoint state){
+    free(state.beta);
+    free(state.betaBest);
+    free(state.e);
+    free(state.SW);
+    free(state.active);
+    free(state.stable);
+    free(state.shrunk);
+}
+
+/**
+ * @endcond
+ */
@@ -47,6 +47,10 @@
 #include "ParallelAlgorithms.h"
 #include "full-train.h"
 #include "kernels.h"
+#include "kernelCache.h"
+#include "checkpoint.h"
+#include "linear-train.h"
+#include "LIBIRWLS-predict.h"
 
 
 /**
@@ -54,28 +58,412 @@
  */
 
 /**
- * @brief Random permutation of n elements.
- *
- * It crates a random permutation of n elements.
+ * @brief Random permutation of n elements stored in a given array.
  *
+ * @param a The array where the permutation is stored (n elements).
  * @param n The number of elementos in the permutation.
- * @return The permutation.
+ * @param seed The state of the random number generator (rand_r), it is updated.
  */
 
-int * rpermute(int n) {
-    int *a = (int *) malloc(n*sizeof(int));
+static void randomPermutation(int *a, int n, unsigned int *seed) {
     int k;
     for (k = 0; k < n; k++)
 	a[k] = k;
         for (k = n-1; k > 0; k--) {
-		int j = rand() % (k+1);
+		int j = rand_r(seed) % (k+1);
 		int temp = a[j];
 		a[j] = a[k];
 		a[k] = temp;
         }
+}
+
+/**
+ * @brief Random permutation of n elements.
+ *
+ * It crates a random permutation of n elements.
+ *
+ * @param n The number of elementos in the permutation.
+ * @return The permutation.
+ */
+
+int * rpermute(int n) {
+    int *a = (int *) malloc(n*sizeof(int));
+    unsigned int seed = (unsigned int) rand();
+    randomPermutation(a,n,&seed);
     return a;
 }
 
+/**
+ * @brief It moves the k largest values of a list of elements to its beginning.
+ *
+ * Partial quickselect over the list of elements (the values are not moved). Every pass splits the
+ * elements in three groups (larger, equal and smaller than the pivot), so the many equal values of
+ * the free samples are settled in a single pass.
+ *
+ * @param list The elements.
+ * @param value The value of every element.
+ * @param n The length of the list.
+ * @param k The number of largest elements.
+ */
+
+static void selectLargest(int *list, double *value, int n, int k){
+    int left=0, right=n-1, i, larger, smaller, tmp;
+    double pivot;
+    while(right>left && k>left && k<=right){
+        // Median of three as pivot
+        int mid=left+(right-left)/2;
+        if(value[list[mid]]>value[list[left]]){ tmp=list[mid]; list[mid]=list[left]; list[left]=tmp; }
+        if(value[list[right]]>value[list[left]]){ tmp=list[right]; list[right]=list[left]; list[left]=tmp; }
+        if(value[list[right]]>value[list[mid]]){ tmp=list[right]; list[right]=list[mid]; list[mid]=tmp; }
+        pivot=value[list[mid]];
+
+        // [left,larger) larger than the pivot, [larger,i) equal, (smaller,right] smaller
+        larger=left;
+        smaller=right;
+        i=left;
+        while(i<=smaller){
+            if(value[list[i]]>pivot){
+                tmp=list[i]; list[i]=list[larger]; list[larger]=tmp;
+                larger++;
+                i++;
+            }else if(value[list[i]]<pivot){
+                tmp=list[i]; list[i]=list[smaller]; list[smaller]=tmp;
+                smaller--;
+            }else{
+                i++;
+            }
+        }
+
+        if(k>=larger && k<=smaller+1) return;
+        if(k<larger) right=larger-1;
+        else left=smaller+1;
+    }
+}
+
+/** @brief Values used to sort the selected elements in largestFirst. */
+static double *sortValue;
+#pragma omp threadprivate(sortValue)
+
+/**
+ * @brief It compares two elements by their value (largest first, ties by index).
+ */
+
+static int compareLargest(const void *a, const void *b){
+    int ia=*((const int *) a), ib=*((const int *) b);
+    if(sortValue[ia]>sortValue[ib]) return -1;
+    if(sortValue[ia]<sortValue[ib]) return 1;
+    return (ia>ib)-(ia<ib);
+}
+
+/**
+ * @brief Permutation of n elements that starts by the k elements with the largest value, stored in given arrays.
+ *
+ * @param value The value of every element.
+ * @param n The number of elements.
+ * @param k The number of largest elements to select.
+ * @param nThreads The number of threads.
+ * @param perm The array where the permutation is stored (n elements).
+ * @param candidates Auxiliar array of n elements.
+ * @param selected Auxiliar array of n elements.
+ * @see largestFirst()
+ */
+
+static void largestFirstBuffer(double *value, int n, int k, int nThreads, int *perm, int *candidates, char *selected){
+    int nCandidates=0, t, i, o;
+
+    if(k>n) k=n;
+    if(nThreads<1) nThreads=1;
+    for(i=0;i<n;i++) perm[i]=i;
+
+    // Every thread selects the k largest values of its part
+    #pragma omp parallel for schedule(static) private(t)
+    for(t=0;t<nThreads;t++){
+        int start=(int) (((long long) n)*t/nThreads);
+        int end=(int) (((long long) n)*(t+1)/nThreads);
+        selectLargest(&perm[start],value,end-start,(k<end-start) ? k : end-start);
+    }
+
+    for(t=0;t<nThreads;t++){
+        int start=(int) (((long long) n)*t/nThreads);
+        int end=(int) (((long long) n)*(t+1)/nThreads);
+        int length=(k<end-start) ? k : end-start;
+        memcpy(&candidates[nCandidates],&perm[start],length*sizeof(int));
+        nCandidates+=length;
+    }
+
+    selectLargest(candidates,value,nCandidates,k);
+    sortValue=value;
+    qsort(candidates,k,sizeof(int),compareLargest);
+
+    memcpy(perm,candidates,k*sizeof(int));
+    memset(selected,0,n*sizeof(char));
+    for(i=0;i<k;i++) selected[candidates[i]]=1;
+    o=k;
+    for(i=0;i<n;i++) if(selected[i]==0) perm[o++]=i;
+}
+
+/**
+ * @brief Permutation of n elements that starts by the k elements with the largest value.
+ *
+ * It finds the k largest values in parallel (every thread selects the k largest values of a part of the
+ * array and the candidates of every thread are merged). The first k elements of the permutation are
+ * sorted from the largest value, the rest of elements follow in an arbitrary order.
+ *
+ * @param value The value of every element.
+ * @param n The number of elements.
+ * @param k The number of largest elements to select.
+ * @param nThreads The number of threads.
+ * @return The permutation.
+ */
+
+int * largestFirst(double *value, int n, int k, int nThreads){
+    int *perm = (int *) malloc(n*sizeof(int));
+    int *candidates = (int *) malloc(n*sizeof(int));
+    char *selected = (char *) malloc(n*sizeof(char));
+
+    largestFirstBuffer(value,n,k,nThreads,perm,candidates,selected);
+
+    free(candidates);
+    free(selected);
+    return perm;
+}
+
+/**
+ * @brief It allocates a buffer of a workspace aligned to 64 bytes and filled with zeros.
+ *
+ * @param bytes The size of the buffer.
+ * @return The buffer.
+ */
+
+static void *workspaceAlloc(size_t bytes){
+    void *memory;
+    if(bytes==0) bytes=1;
+    if(posix_memalign(&memory,64,bytes) != 0){
+        fprintf(stderr, "Error: There is not enough memory to allocate the workspace of the training\n");
+        exit(2);
+    }
+    memset(memory,0,bytes);
+    return memory;
+}
+
+/**
+ * @brief It allocates the buffers of the working set of a workspace.
+ *
+ * @param workspace The workspace.
+ * @param capacity The maximum size of the working set.
+ */
+
+static void allocWorkingSetBuffers(fullWorkspace *workspace, int capacity){
+    size_t n = ((size_t) capacity)+1;
+    workspace->capacity=capacity;
+    workspace->a = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->elementGroup = (int *) workspaceAlloc(n*sizeof(int));
+    workspace->betaNew = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->betaAux = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->betaBest = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->S1comp = (int *) workspaceAlloc(n*sizeof(int));
+    workspace->S3comp = (int *) workspaceAlloc(n*sizeof(int));
+    workspace->H = (double *) workspaceAlloc(n*n*sizeof(double));
+    workspace->Hrows = (double **) workspaceAlloc(n*sizeof(double *));
+    workspace->et = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->G13 = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->L = (double *) workspaceAlloc(n*n*sizeof(double));
+    workspace->Lindex = (int *) workspaceAlloc(n*sizeof(int));
+    workspace->Ldiag = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->Lmember = (char *) workspaceAlloc(n*sizeof(char));
+    workspace->S1position = (int *) workspaceAlloc(n*sizeof(int));
+    workspace->Lrhs = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->Lborder = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->Lwork = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->memaux = (double *) workspaceAlloc(((size_t) (2*pow(ceil(0.5*n),2)))*sizeof(double));
+    workspace->changed = (int *) workspaceAlloc(n*sizeof(int));
+    workspace->delta = (double *) workspaceAlloc(n*sizeof(double));
+    workspace->changedRows = (double **) workspaceAlloc(n*sizeof(double *));
+    workspace->cacheBuffers = initKernelCacheBuffers((int) n);
+}
+
+/**
+ * @brief It frees the buffers of the working set of a workspace.
+ *
+ * @param workspace The workspace.
+ */
+
+static void freeWorkingSetBuffers(fullWorkspace *workspace){
+    free(workspace->a);
+    free(workspace->elementGroup);
+    free(workspace->betaNew);
+    free(workspace->betaAux);
+    free(workspace->betaBest);
+    free(workspace->S1comp);
+    free(workspace->S3comp);
+    free(workspace->H);
+    free(workspace->Hrows);
+    free(workspace->et);
+    free(workspace->G13);
+    free(workspace->L);
+    free(workspace->Lindex);
+    free(workspace->Ldiag);
+    free(workspace->Lmember);
+    free(workspace->S1position);
+    free(workspace->Lrhs);
+    free(workspace->Lborder);
+    free(workspace->Lwork);
+    free(workspace->memaux);
+    free(workspace->changed);
+    free(workspace->delta);
+    free(workspace->changedRows);
+    freeKernelCacheBuffers(workspace->cacheBuffers);
+}
+
+fullWorkspace *initFullWorkspace(int capacity, int l){
+    fullWorkspace *workspace = (fullWorkspace *) calloc(1,sizeof(fullWorkspace));
+    allocWorkingSetBuffers(workspace,capacity);
+    workspace->l=l;
+    workspace->perm = (int *) workspaceAlloc(((size_t) l)*sizeof(int));
+    workspace->permAux = (int *) workspaceAlloc(((size_t) l)*sizeof(int));
+    workspace->candidates = (int *) workspaceAlloc(((size_t) l)*sizeof(int));
+    workspace->selected = (char *) workspaceAlloc(((size_t) l)*sizeof(char));
+    workspace->values = (double *) workspaceAlloc(((size_t) l)*sizeof(double));
+    workspace->previous = (char *) workspaceAlloc(((size_t) l)*sizeof(char));
+    return workspace;
+}
+
+void resizeFullWorkspace(fullWorkspace *workspace, int capacity){
+    if(capacity<=workspace->capacity) return;
+    freeWorkingSetBuffers(workspace);
+    allocWorkingSetBuffers(workspace,capacity);
+}
+
+void freeFullWorkspace(fullWorkspace *workspace){
+    freeWorkingSetBuffers(workspace);
+    free(workspace->perm);
+    free(workspace->permAux);
+    free(workspace->candidates);
+    free(workspace->selected);
+    free(workspace->values);
+    free(workspace->previous);
+    free(workspace);
+}
+
+/**
+ * @brief Kernel function of two samples of the working set.
+ *
+ * It returns the kernel function of two samples of the working set. It reads the value from
+ * the rows of the kernel cache when they are available and evaluates the kernel function otherwise.
+ *
+ * @param kernel The kernel evaluator of the working set.
+ * @param index1 The index of the first sample in the working set.
+ * @param index2 The index of the second sample in the working set.
+ * @param indexes The index in the training set of every sample of the working set.
+ * @param Krows The cached kernel row of every sample of the working set (NULL if it is not cached).
+ * @return The kernel function of both samples.
+ */
+
+static inline double workingSetKernel(kernelEvaluator *kernel, int index1, int index2, int *indexes, double **Krows){
+    if(Krows != NULL){
+        if(Krows[index1] != NULL) return Krows[index1][indexes[index2]];
+        if(Krows[index2] != NULL) return Krows[index2][indexes[index1]];
+    }
+    return kernelEvaluate(kernel,index1,index2);
+}
+
+/** @brief Number of samples of every tile of the updates of the error. */
+#define ERROR_TILE 256
+
+/**
+ * @brief Update of the error of the working set.
+ *
+ * It updates the error of every sample of the working set with the weights that changed:
+ *
+ * e[i] -= sum_j K(i,changed[j])*delta[j] + bias
+ *
+ * The samples are processed by tiles of ERROR_TILE elements in parallel, so the error of a tile stays
+ * in the cache while the columns that changed are added. The terms are added in the same order for
+ * every sample, so the result does not depend on the number of threads.
+ *
+ * @param kernel The kernel evaluator of the working set.
+ * @param l The number of samples of the working set.
+ * @param indexes The index in the training set of every sample of the working set.
+ * @param Krows The cached kernel row of every sample of the working set (NULL if it is not cached).
+ * @param changed The samples of the working set whose weights changed.
+ * @param delta The change of the weight of every sample of changed.
+ * @param nChanged The number of samples whose weights changed.
+ * @param bias The change of the bias term.
+ * @param e The error of every sample of the working set.
+ */
+
+static void workingSetErrorUpdate(kernelEvaluator *kernel, int l, int *indexes, double **Krows, int *changed, double *delta, int nChanged, double bias, double *e){
+    int t, tiles=(l+ERROR_TILE-1)/ERROR_TILE;
+
+    #pragma omp parallel for default(shared) private(t) schedule(static)
+    for (t=0;t<tiles;t++){
+        int i, j, start=t*ERROR_TILE, end=(start+ERROR_TILE<l) ? start+ERROR_TILE : l;
+        for (j=0;j<nChanged;j++){
+            for (i=start;i<end;i++) e[i]-=workingSetKernel(kernel,i,changed[j],indexes,Krows)*delta[j];
+        }
+        for (i=start;i<end;i++) e[i]-=bias;
+    }
+}
+
+/**
+ * @brief Update of the error with cached kernel rows.
+ *
+ * It updates the error of the active samples of the training set with the cached kernel rows of the
+ * samples whose weights changed:
+ *
+ * e[active[o]] -= sum_j rows[j][active[o]]*delta[j] + bias
+ *
+ * It is the product of the block of the kernel matrix of the changed samples and the vector of changes.
+ * The active samples are processed by tiles of ERROR_TILE elements in parallel, every row is read
+ * sequentially in a tile and the error of the tile stays in the cache. The terms are added in the same
+ * order for every sample, so the result does not depend on the number of threads.
+ *
+ * @param rows The cached kernel row of every sample whose weight changed.
+ * @param delta The change of the weight of every row.
+ * @param nRows The number of rows.
+ * @param active The active samples of the training set (NULL to use the samples 0,...,nActive-1).
+ * @param nActive The number of active samples.
+ * @param bias The change of the bias term.
+ * @param e The error of every sample of the training set.
+ */
+
+static void cachedRowsErrorUpdate(double **rows, double *delta, int nRows, int *active, int nActive, double bias, double *e){
+    int t, tiles=(nActive+ERROR_TILE-1)/ERROR_TILE;
+
+    #pragma omp parallel for default(shared) private(t) schedule(static)
+    for (t=0;t<tiles;t++){
+        int o, j, start=t*ERROR_TILE, end=(start+ERROR_TILE<nActive) ? start+ERROR_TILE : nActive;
+        if(active==NULL){
+            for (j=0;j<nRows;j++){
+                double *row=rows[j], d=delta[j];
+                for (o=start;o<end;o++) e[o]-=row[o]*d;
+            }
+            for (o=start;o<end;o++) e[o]-=bias;
+        }else{
+            for (j=0;j<nRows;j++){
+                double *row=rows[j], d=delta[j];
+                for (o=start;o<end;o++) e[active[o]]-=row[active[o]]*d;
+            }
+            for (o=start;o<end;o++) e[active[o]]-=bias;
+        }
+    }
+}
+
+/** @brief Fraction of the working set kept for the samples of the previous one in the largest violations policy. */
+#define VIOLATION_KEPT_RATIO 0.25
+
+/** @brief Maximum number of changes of S1 (relative to its size) to update the Cholesky factor instead of calculating it again. */
+#define CHOLESKY_UPDATE_RATIO 0.1
+
+/** @brief Relative change of the diagonal term 1/a of a sample that is updated in the Cholesky factor, smaller changes are corrected by iterative refinement (that converges at least at this rate). */
+#define CHOLESKY_DIAGONAL_TOLERANCE 0.5
+
+/** @brief Maximum number of steps of iterative refinement of the solution obtained with the updated Cholesky factor. */
+#define CHOLESKY_REFINEMENT_STEPS 30
+
+/** @brief Relative change of the solution that stops the iterative refinement. */
+#define CHOLESKY_REFINEMENT_TOLERANCE 1e-12
+
 /**
  * @brief IRWLS procedure on a Working Set.
  *
@@ -90,28 +478,33 @@ int * rpermute(int n) {
  * @param GIN The classification effect of the inactive set.
  * @param e The current error on every training data.
  * @param beta The bias term of the classification function.
+ * @param indexes The index in the training set of every sample of the working set.
+ * @param Krows The cached kernel row of every sample of the working set (NULL if it is not cached).
  * @return The new weights vector of the classifier.
  */
 
-double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, double *beta){
+double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, double *beta, int *indexes, double **Krows, fullWorkspace *workspace, solverContext *context){
     
+    //Kernel function of the samples of the working set
+    kernelEvaluator kernel = trainEvaluator(dataset,props);
 
     //Auxiliary variables of the elements of the training set
-    double *a = (double *) calloc(dataset.l,sizeof(double));
-    int *elementGroup = (int *) calloc(dataset.l,sizeof(int));
+    double *a = workspace->a;
+    int *elementGroup = workspace->elementGroup;
     
     //Classifier weights
-    double *betaNew=(double *) calloc((dataset.l+1),sizeof(double));
-    double *betaAux=(double *) calloc((dataset.l+1),sizeof(double));    
-    double *betaBest=(double *) calloc((dataset.l+1),sizeof(double));
+    double *betaNew=workspace->betaNew;
+    double *betaAux=workspace->betaAux;
+    double *betaBest=workspace->betaBest;
+    memset(betaBest,0,(dataset.l+1)*sizeof(double));
 
     //Max y min weight
     double maxbeta=0.0;
     double minbeta=0.0;
     
     //Classes of samples
-    int *S1comp = (int *) calloc((dataset.l+1),sizeof(int));
-    int *S3comp = (int *) calloc((dataset.l),sizeof(int));
+    int *S1comp = workspace->S1comp;
+    int *S3comp = workspace->S3comp;
     
     //Stop conditions
     int  iter=0, max_iter=100;
@@ -122,9 +515,29 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
     int i, o, ind=0, ind2=0,nS1=0, nS3=0, thLS=0;
     
     //Variables for least square problems
-    double *H   = (double *) calloc((dataset.l+1)*(dataset.l+1),sizeof(double));
-    double *et  = (double *) calloc((dataset.l+1),sizeof(double));
-    double *G13 = (double *) calloc((dataset.l+1),sizeof(double));    
+    double *H   = workspace->H;
+    double **Hrows = workspace->Hrows;
+    int cachedH;
+    double *et  = workspace->et;
+    double *G13 = workspace->G13;
+    memset(G13,0,(dataset.l+1)*sizeof(double));
+
+    //Weights that change in every iteration
+    int *changed = workspace->changed;
+    double *delta = workspace->delta;
+    int nChanged;
+
+    //Cholesky factor of the kernel block of S1 that is updated while S1 and its weights change little
+    double *L = workspace->L;
+    int *Lindex = workspace->Lindex;
+    double *Ldiag = workspace->Ldiag;
+    char *Lmember = workspace->Lmember;
+    int *S1position = workspace->S1position;
+    double *Lrhs = workspace->Lrhs;
+    double *Lborder = workspace->Lborder;
+    double *Lwork = workspace->Lwork;
+    int nL=0, validL=0, updatesL=0, updateL, changesL, k, step;
+    double refinement, solutionSize;
     
     //Initialization
 
@@ -159,23 +572,125 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
         
         iter++;
         
+        memset(betaAux,0.0,(nS1+1)*sizeof(double));        
+        for (i=0;i<nS1;i++) et[i]=1.0-G13[i]-GIN[S1comp[i]];
+        et[nS1]=-G13[nS1]-GIN[dataset.l];
+
+        ///////////////////////////////////////////////////////
+        //UPDATING THE CHOLESKY FACTOR OF THE PREVIOUS ITERATION
+        ///////////////////////////////////////////////////////
+
+        // The factor is updated when few samples have entered or left S1 or changed their weight a
+        // by more than CHOLESKY_DIAGONAL_TOLERANCE, otherwise the matrix H is generated and factorized again.
+        updateL=0;
+        if(validL==1 && nS1>0){
+            for (i=0;i<dataset.l;i++) S1position[i]=-1;
+            for (i=0;i<nS1;i++) S1position[S1comp[i]]=i;
+
+            // Every removed, added or changed sample is a rank one modification of the factor
+            changesL=nS1-nL;
+            for (k=0;k<nL;k++){
+                if(S1position[Lindex[k]]==-1) changesL+=2;
+                else if(fabs(1.0/a[Lindex[k]]-Ldiag[k]) > CHOLESKY_DIAGONAL_TOLERANCE*Ldiag[k]) changesL++;
+            }
+
+            if(updatesL+changesL <= CHOLESKY_UPDATE_RATIO*nS1) updateL=1;
+        }
+
+        if(updateL==1){
+            updatesL+=changesL;
+
+            // Samples that left S1
+            for (k=nL-1;k>=0 && nL>0;k--){
+                if(S1position[Lindex[k]]==-1){
+                    CholeskyDeleteRow(L,nL,k,Lwork);
+                    memmove(&Lindex[k],&Lindex[k+1],(nL-k-1)*sizeof(int));
+                    memmove(&Ldiag[k],&Ldiag[k+1],(nL-k-1)*sizeof(double));
+                    nL--;
+                }
+            }
+
+            // Samples whose weight a has changed
+            for (k=0;k<nL && updateL==1;k++){
+                double change=1.0/a[Lindex[k]]-Ldiag[k];
+                if(fabs(change) > CHOLESKY_DIAGONAL_TOLERANCE*Ldiag[k]){
+                    memset(Lwork,0,nL*sizeof(double));
+                    Lwork[k]=sqrt(fabs(change));
+                    if(CholeskyRankOneUpdate(L,nL,k,Lwork,(change>0.0) ? 1.0 : -1.0) != 0) updateL=0;
+                    Ldiag[k]=1.0/a[Lindex[k]];
+                }
+            }
+
+            // Samples that entered S1
+            memset(Lmember,0,dataset.l*sizeof(char));
+            for (k=0;k<nL;k++) Lmember[Lindex[k]]=1;
+            for (i=0;i<nS1 && updateL==1;i++){
+                if(Lmember[S1comp[i]]==0){
+                    for (k=0;k<nL;k++) Lrhs[k]=workingSetKernel(&kernel,S1comp[i],Lindex[k],indexes,Krows)*dataset.y[S1comp[i]]*dataset.y[Lindex[k]];
+                    if(CholeskyAppendRow(L,nL,Lrhs,workingSetKernel(&kernel,S1comp[i],S1comp[i],indexes,Krows)+1.0/a[S1comp[i]]) != 0) updateL=0;
+                    Lindex[nL]=S1comp[i];
+                    Ldiag[nL]=1.0/a[S1comp[i]];
+                    nL++;
+                }
+            }
+
+            if(updateL==1){
+                // The factor solves the system whose diagonal is Ldiag, the small differences with 1/a are
+                // moved to the right hand side with the previous solution until it does not change.
+                for (k=0;k<nL;k++) Lborder[k]=dataset.y[Lindex[k]];
+                for (step=0;step<=CHOLESKY_REFINEMENT_STEPS;step++){
+                    for (k=0;k<nL;k++) Lrhs[k]=et[S1position[Lindex[k]]]-(1.0/a[Lindex[k]]-Ldiag[k])*betaAux[S1position[Lindex[k]]];
+                    Lrhs[nL]=et[nS1];
+                    BorderedCholeskySolve(L,nL,Lborder,Lrhs,Lwork);
+                    refinement=0.0;
+                    solutionSize=0.0;
+                    for (k=0;k<nL;k++){
+                        if(fabs(Lrhs[k]-betaAux[S1position[Lindex[k]]]) > refinement) refinement=fabs(Lrhs[k]-betaAux[S1position[Lindex[k]]]);
+                        if(fabs(Lrhs[k]) > solutionSize) solutionSize=fabs(Lrhs[k]);
+                        betaAux[S1position[Lindex[k]]]=Lrhs[k];
+                    }
+                    betaAux[nS1]=Lrhs[nL];
+                    if(step>0 && refinement <= CHOLESKY_REFINEMENT_TOLERANCE*solutionSize) break;
+                }
+                // If the refinement does not converge the system is solved again from H
+                if(step>CHOLESKY_REFINEMENT_STEPS){
+                    updateL=0;
+                    validL=0;
+                    memset(betaAux,0.0,(nS1+1)*sizeof(double));
+                }
+            }else{
+                validL=0;
+            }
+        }
+
+        if(updateL==0){
+
         ///////////////////////////////////////////////////////
         //GENERATING MATRIX H and VECTOR FOR THE LINEAR SYSTEM
         ///////////////////////////////////////////////////////
-        memset(betaAux,0.0,(nS1+1)*sizeof(double));        
-        memset(et,0.0,(nS1+1)*sizeof(double));        
         memset(H,0.0,(nS1+1)*(nS1+1)*sizeof(double));        
+
+        // The kernel block of S1 is calculated at once if any row is not in the cache
+        cachedH = (Krows != NULL);
+        for (i=0;i<nS1 && cachedH==1;i++) if(Krows[S1comp[i]]==NULL) cachedH=0;
+
+        if(cachedH==0){
+            for (i=0;i<nS1;i++) Hrows[i]=&H[i*(nS1+1)];
+            kernelBlock(dataset,S1comp,nS1,S1comp,nS1,props,Hrows);
+        }
         
         #pragma omp parallel default(shared) private(i)
         {
         #pragma omp for schedule(static)
             for (i=0;i<nS1;i++){
                 int j;
+                double kernelValue;
                 H[i*(nS1+1)+nS1]=dataset.y[S1comp[i]];
                 H[nS1*(nS1+1)+i]=dataset.y[S1comp[i]];
-                et[i]=1.0-G13[i]-GIN[S1comp[i]];
                 for (j=0;j<nS1;j++){
-                    H[i*(nS1+1)+j]=kernelFunction(dataset,S1comp[i], S1comp[j], props)*dataset.y[S1comp[i]]*dataset.y[S1comp[j]];
+                    if(cachedH==1) kernelValue=Krows[S1comp[i]][indexes[S1comp[j]]];
+                    else kernelValue=H[i*(nS1+1)+j];
+                    H[i*(nS1+1)+j]=kernelValue*dataset.y[S1comp[i]]*dataset.y[S1comp[j]];
                     if(i==j) H[i*(nS1+1)+j]+=(1.0/(a[S1comp[i]]));
                 }
             }
@@ -183,7 +698,6 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
 
 
         H[nS1*(nS1+1)+(nS1)]=0.0;
-        et[nS1]=-G13[nS1]-GIN[dataset.l];
       
        
         ///////////////////////////////////////////////////////
@@ -195,9 +709,22 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
         
 
         omp_set_num_threads(thLS);
-        ParallelLinearSystem(H,(nS1+1),(nS1+1),0,0,et,(nS1+1),1,0,0,(nS1+1),1,betaAux,(nS1+1),1,0,0,thLS);
+        ParallelLinearSystemBuffer(H,(nS1+1),(nS1+1),0,0,et,(nS1+1),1,0,0,(nS1+1),1,betaAux,(nS1+1),1,0,0,thLS,workspace->memaux,context);
         omp_set_num_threads(props.Threads);
 
+        // The first block of the factor of H is the factor of the kernel block of S1
+        nL=nS1;
+        validL=(nS1>0);
+        updatesL=0;
+        for (k=0;k<nS1;k++){
+            Lindex[k]=S1comp[k];
+            Ldiag[k]=1.0/a[S1comp[k]];
+            memcpy(&L[k*nS1+k],&H[k*(nS1+1)+k],(nS1-k)*sizeof(double));
+            if(!(L[k*nS1+k]>0.0)) validL=0;
+        }
+
+        }
+
         ///////////////////////////////////////////////////////
         //UPDATING SVM WEIGHTS
         ///////////////////////////////////////////////////////
@@ -233,21 +760,17 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
         //UPDATING THE ERROR OF THE TRAINING SET
         ////////////////////////////////////////
         
-        #pragma omp parallel default(shared) private(i)
-        {
-        #pragma omp for schedule(static)
-            for (i=0;i<dataset.l;i++){
-                int j;
-                for (j=0;j<dataset.l;j++){
-                    if(betaNew[j] != beta[j]){
-                        e[i]=e[i]-kernelFunction(dataset,i,j,props)*(betaNew[j]-beta[j]);
-                    }
-                }
-                e[i]=e[i]-(betaNew[dataset.l]-beta[dataset.l]);
-
+        // Only the columns of the weights that changed are used
+        nChanged=0;
+        for (i=0;i<dataset.l;i++){
+            if(betaNew[i] != beta[i]){
+                changed[nChanged]=i;
+                delta[nChanged]=betaNew[i]-beta[i];
+                nChanged++;
             }
         }
-        
+        workingSetErrorUpdate(&kernel,dataset.l,indexes,Krows,changed,delta,nChanged,betaNew[dataset.l]-beta[dataset.l],e);
+
         if(deltaW/normW<bestDW){
             bestDW=deltaW/normW;
             itersSinceBestDW=0;
@@ -333,7 +856,7 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
                 for (i=0;i<(nS1+1);i++){
                     int o;
                     if(i<nS1){
-                        for (o=0;o<nS3;o++) G13[i] += et[o]*kernelFunction(dataset,S1comp[i], S3comp[o], props)*dataset.y[S1comp[i]]*dataset.y[S3comp[o]];
+                        for (o=0;o<nS3;o++) G13[i] += et[o]*workingSetKernel(&kernel,S1comp[i], S3comp[o], indexes, Krows)*dataset.y[S1comp[i]]*dataset.y[S3comp[o]];
                     }else{
                         for (o=0;o<nS3;o++) G13[nS1]+=et[o]*dataset.y[S3comp[o]];	
                         
@@ -345,20 +868,56 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
 
     }
 
-    free(a);
-    free(elementGroup);
+    return betaBest;
+}
 
-    free(betaAux);
-    free(betaNew);
+/** @brief Number of consecutive iterations that an inactive sample must stay at a bound to be shrunk. */
+#define SHRINK_ITERATIONS 10
 
-    free(S3comp);
-    free(S1comp);
-        
-    free(et);
-    free(G13);
-    free(H);
+/** @brief Minimum size of the working set in the adaptive mode. */
+#define ADAPTIVE_MIN_SIZE 50
 
-    return betaBest;
+/** @brief Factor that multiplies the size of the working set when it grows in the adaptive mode. */
+#define ADAPTIVE_GROWTH 1.5
+
+/** @brief Factor that multiplies the size of the working set when it shrinks in the adaptive mode. */
+#define ADAPTIVE_REDUCTION 0.75
+
+/** @brief Iterations without improving the stop criterion after which the working set grows in the adaptive mode. */
+#define ADAPTIVE_STALL 10
+
+/**
+ * @brief Initial weights of a training set from a trained model.
+ *
+ * The support vectors of the model are matched with the samples of the training set by their features.
+ * The weights of the matched samples are clipped to the box constraints of the current cost.
+ *
+ * @param dataset The training set.
+ * @param mymodel The trained model (svm_sample layout, as it is loaded by readModel).
+ * @param props The values of the training parameters.
+ * @return The weight of every sample and the bias in the last position.
+ */
+
+double* initialFULLWeights(svm_dataset dataset, model *mymodel, properties props){
+    double *init = (double *) calloc(dataset.l+1,sizeof(double));
+    int *match = matchSupportVectors(dataset,mymodel);
+    int i, found=0;
+
+    for(i=0;i<mymodel->nSVs;i++){
+        if(match[i] == -1) continue;
+        int s=match[i];
+        double weight=mymodel->weights[i]*dataset.y[s];
+        if(weight<0.0) weight=0.0;
+        if(weight>(double)props.C) weight=(double)props.C;
+        init[s]=weight*dataset.y[s];
+        found++;
+    }
+    init[dataset.l]=mymodel->bias;
+
+    if(props.verbose==1) printf("Initial model: %d of %d support vectors found in the training set\n",found,mymodel->nSVs);
+
+    free(match);
+    return init;
 }
 
 /**
@@ -367,13 +926,83 @@ double* subIRWLS(svm_dataset dataset,properties props, double *GIN, double *e, d
  * It trains a full SVM using a training set and the training parameters.
  * @param dataset The training set.
  * @param props The values of the training parameters.
+ * @param init The initial weights of every sample and the bias in the last position (NULL to start from zero).
+ * @param deadline It returns 1 if the training stopped on props.Deadline and 0 otherwise (NULL if it is not needed).
+ * @return The weights of every Support Vector of the SVM.
+ */
+
+double* trainFULL(svm_dataset dataset,properties props,double *init,int *deadline,solverContext *context){
+    kernelCache *cache = initKernelCache(dataset.l,props.CacheSize);
+    double *beta = trainFULLWarm(dataset,props,init,NULL,NULL,cache,deadline,context);
+    if(cache != NULL){
+        if(props.verbose==1){
+            printf("Kernel cache: %d rows of %d, %lld hits, %lld misses (hit rate %.2f%%)\n",cache->nSlots,cache->capacity,cache->hits,cache->misses,100.0*cache->hits/(cache->hits+cache->misses));
+        }
+        freeKernelCache(cache);
+    }
+    return beta;
+}
+
+/**
+ * @brief It trains a full SVM with a training set from an initial solution.
+ *
+ * It trains a full SVM using a training set and the training parameters. The error of the initial
+ * weights and the kernel cache can be kept between consecutive trainings of the same training set.
+ * @param dataset The training set.
+ * @param props The values of the training parameters.
+ * @param init The initial weights of every sample and the bias in the last position (NULL to start from zero).
+ * The weights must satisfy the box constraints of props.C.
+ * @param initError The error of every sample for the initial weights e[i]=y[i]-sum_j init[j]K(i,j)-b
+ * (NULL to calculate it). It is ignored if init is NULL.
+ * @param error Array to store the error of every sample for the returned weights (NULL if it is not needed).
+ * It can be the same array as initError.
+ * @param cache The kernel cache (NULL to train without cache).
+ * @param deadline It returns 1 if the training stopped on props.Deadline and 0 otherwise (NULL if it is not needed).
+ * When the deadline is reached the best weights found so far are returned.
  * @return The weights of every Support Vector of the SVM.
  */
 
-double* trainFULL(svm_dataset dataset,properties props){
+double* trainFULLWarm(svm_dataset dataset,properties props,double *init,double *initError,double *error,kernelCache *cache,int *deadline,solverContext *context){
 
+    double trainingStart = omp_get_wtime();
+    int deadlineReached = 0;
     if(props.verbose==1) printf("\n");
     int MaxWorkingSize = props.MaxSize;
+
+    // The solver has its own random number generator, so its state can be stored in the checkpoints
+    unsigned int seed = (unsigned int) rand();
+
+    // Temporal memory of the linear algebra functions, a private context is created if none is given
+    solverContext *ownContext = NULL;
+    if(context == NULL){
+        ownContext = initSolverContext(props.Threads,MaxWorkingSize+1);
+        context = ownContext;
+    }
+
+    // State of an interrupted training, the working set keeps the size that it had in the adaptive mode
+    trainCheckpoint resume;
+    if(props.Resume != NULL){
+        FILE *ResumeIn = fopen(props.Resume, "rb");
+        if (ResumeIn == NULL) {
+            fprintf(stderr, "Checkpoint file not found: %s\n",props.Resume);
+            exit(2);
+        }
+        readCheckpoint(&resume,ResumeIn);
+        fclose(ResumeIn);
+        if(resume.l != dataset.l || resume.C != props.C || resume.kernelType != props.kernelType || (props.kernelType != 0 && resume.Kgamma != props.Kgamma)){
+            fprintf(stderr, "The checkpoint %s was created with a different training set or parameters\n",props.Resume);
+            exit(2);
+        }
+        if(resume.MaxWorkingSize>MaxWorkingSize){
+            MaxWorkingSize=resume.MaxWorkingSize;
+            updateSolverContext(context,MaxWorkingSize+1);
+        }
+    }
+
+    if(MaxWorkingSize>dataset.l) MaxWorkingSize=dataset.l;
+    // Allocated length of the arrays of the working set, it only changes in the adaptive mode
+    int capacity = MaxWorkingSize;
+    int minWorkingSize = (ADAPTIVE_MIN_SIZE<MaxWorkingSize) ? ADAPTIVE_MIN_SIZE : MaxWorkingSize;
     double epsilon=1e6;
     double epsilonTmp=0.0;
     double epsilonThreshold=0.001;
@@ -384,6 +1013,27 @@ double* trainFULL(svm_dataset dataset,properties props){
     subdataset.y=(double *) calloc(MaxWorkingSize,sizeof(double));
     subdataset.quadratic_value=(double *) calloc(MaxWorkingSize,sizeof(double));
     subdataset.x = (svm_sample **) calloc(MaxWorkingSize,sizeof(svm_sample *));
+    subdataset.single = dataset.single;
+    subdataset.xs = (svm_sample_single **) calloc(MaxWorkingSize,sizeof(svm_sample_single *));
+    subdataset.features = NULL;
+    subdataset.featuresSingle = NULL;
+    subdataset.csr = dataset.csr;
+    subdataset.rowPtr = NULL;
+    subdataset.indexes = NULL;
+    subdataset.values = NULL;
+    subdataset.dense = dataset.dense;
+    subdataset.matrix = NULL;
+    subdataset.stride = dataset.stride;
+    if(dataset.dense==1){
+        void *memory;
+        if(posix_memalign(&memory,64,((size_t) MaxWorkingSize)*dataset.stride*sizeof(double)) != 0){
+            fprintf(stderr, "Error: There is not enough memory to store the working set\n");
+            exit(2);
+        }
+        subdataset.matrix = (double *) memory;
+    }
+    int subdatasetCapacity = 0;
+    if(dataset.csr==1) subdataset.rowPtr = (int *) calloc(MaxWorkingSize+1,sizeof(int));
     
     int found10,found11, found12, found00, found01, found02;
     
@@ -391,7 +1041,6 @@ double* trainFULL(svm_dataset dataset,properties props){
     double *beta=(double *) calloc((dataset.l+1),sizeof(double));
     double *betaNew=(double *) calloc((dataset.l+1),sizeof(double));
     double *betaBest=(double *) calloc((dataset.l+1),sizeof(double));
-    double *betaTmp;
 
     int *SW = (int *) calloc(MaxWorkingSize,sizeof(int));
     int *SIN = (int *) calloc(dataset.l,sizeof(int));
@@ -401,9 +1050,40 @@ double* trainFULL(svm_dataset dataset,properties props){
     double *esub=(double *) calloc((MaxWorkingSize+1),sizeof(double));
     double *betasub=(double *) calloc((MaxWorkingSize+1),sizeof(double));
 
+    // Rows of the kernel matrix of the working set
+    double **Krows = (double **) calloc(MaxWorkingSize,sizeof(double *));
+
+    // Samples of the working set whose kernel row is not in the cache
+    int *uncached = (int *) calloc(MaxWorkingSize,sizeof(int));
+    int *uncachedIndex = (int *) calloc(MaxWorkingSize,sizeof(int));
+    double *uncachedValue = (double *) calloc(MaxWorkingSize,sizeof(double));
+    int nUncached=0;
+    int nChanged=0;
+
+    // Samples of the working set with a weight distinct than zero
+    int *SWNZ = (int *) calloc(MaxWorkingSize,sizeof(int));
+    double *betaSWNZ = (double *) calloc(MaxWorkingSize,sizeof(double));
+    int nSWNZ=0;
+
+    // Shrinking: the samples that stay inactive at a bound during SHRINK_ITERATIONS iterations are removed
+    // from the error update and from the working set selection. Their error is recalculated before stopping.
+    int shrinking = props.Shrinking;
+    int *active = (int *) calloc(dataset.l,sizeof(int));
+    int *stable = (int *) calloc(dataset.l,sizeof(int));
+    char *shrunk = (char *) calloc(dataset.l,sizeof(char));
+    double *eUpdate = (double *) calloc(dataset.l,sizeof(double));
+    int nActive=dataset.l, nShrunk=0;
+
     int nSW=0, nSIn=0, nSC=0;
     int i, o, ind=0, ind2=0;
 
+    int outerIterations=0;
+    double timeIteration=0.0, timeSubproblem=0.0;
+    double *violation = (double *) calloc(dataset.l,sizeof(double));
+
+    // Buffers of subIRWLS and of the selection of the working set, they are reused by every iteration
+    fullWorkspace *workspace = initFullWorkspace(capacity,dataset.l);
+
     double lambeq, mil, mal;
     int neq=0;
 
@@ -421,6 +1101,55 @@ double* trainFULL(svm_dataset dataset,properties props){
         }
         e[i]=dataset.y[i];		
     }	
+    for (i=0;i<dataset.l;i++) active[i]=i;
+
+    // Warm start: the error of the initial weights is e[i]=y[i]-sum_j beta[j]K(i,j)-b
+    if(init != NULL){
+        memcpy(beta,init,(dataset.l+1)*sizeof(double));
+        memcpy(betaNew,init,(dataset.l+1)*sizeof(double));
+        int *nonZero = (int *) calloc(dataset.l,sizeof(int));
+        if(initError != NULL){
+            memcpy(e,initError,dataset.l*sizeof(double));
+        }else{
+            double *minusBeta = (double *) calloc(dataset.l,sizeof(double));
+            int nNonZero=0;
+            for (i=0;i<dataset.l;i++){
+                e[i]=dataset.y[i]-init[dataset.l];
+                if(init[i] != 0.0){
+                    nonZero[nNonZero]=i;
+                    minusBeta[nNonZero]=-init[i];
+                    nNonZero++;
+                }
+            }
+            if(nNonZero>0) kernelBlockProduct(dataset,NULL,dataset.l,nonZero,nNonZero,props,minusBeta,e);
+            free(minusBeta);
+        }
+
+        // The initial working set is a random subset of the samples that violate the KKT conditions and
+        // the samples between the bounds.
+        int nCandidates=0;
+        for (i=0;i<dataset.l;i++){
+            double weight=init[i]*dataset.y[i];
+            epsilonTmp=e[i]*dataset.y[i];
+            if((weight==0.0 && epsilonTmp>epsilonThreshold) || (weight==((double)props.C) && epsilonTmp<-1.0*epsilonThreshold) || (weight>0.0 && weight<((double)props.C))){
+                nonZero[nCandidates++]=i;
+            }
+        }
+        if(nCandidates>0){
+            int *perm = rpermute(nCandidates);
+            char *inSW = (char *) calloc(dataset.l,sizeof(char));
+            nSW=(nCandidates<MaxWorkingSize) ? nCandidates : MaxWorkingSize;
+            for (i=0;i<nSW;i++){
+                SW[i]=nonZero[perm[i]];
+                inSW[SW[i]]=1;
+            }
+            nSIn=0;
+            for (i=0;i<dataset.l;i++) if(inSW[i]==0) SIN[nSIn++]=i;
+            free(perm);
+            free(inSW);
+        }
+        free(nonZero);
+    }
 
 
     int iter=0;
@@ -428,30 +1157,91 @@ double* trainFULL(svm_dataset dataset,properties props){
     double bestNorm=1e20;
     int SinceBest=0;
 
+    if(props.Resume != NULL){
+        memcpy(beta,resume.beta,(dataset.l+1)*sizeof(double));
+        memcpy(betaNew,resume.beta,(dataset.l+1)*sizeof(double));
+        memcpy(betaBest,resume.betaBest,(dataset.l+1)*sizeof(double));
+        memcpy(e,resume.e,dataset.l*sizeof(double));
+        nSW=resume.nSW;
+        memcpy(SW,resume.SW,nSW*sizeof(int));
+        nSIn=resume.nSIn;
+        shrinking=resume.shrinking;
+        nActive=resume.nActive;
+        memcpy(active,resume.active,nActive*sizeof(int));
+        memcpy(stable,resume.stable,dataset.l*sizeof(int));
+        memcpy(shrunk,resume.shrunk,dataset.l*sizeof(char));
+        nShrunk=resume.nShrunk;
+        iter=resume.iter;
+        outerIterations=iter;
+        SinceBest=resume.SinceBest;
+        bestNorm=resume.bestNorm;
+        seed=resume.seed;
+        freeCheckpoint(resume);
+        if(props.verbose==1) printf("Training resumed from iteration %d\n",iter);
+    }
+
+    // The checkpoints are written in the background
+    checkpointWriter *writer = NULL;
+    if(props.Checkpoint != NULL) writer = initCheckpointWriter(props.Checkpoint,dataset.l);
+    double lastCheckpoint = omp_get_wtime();
+
     while( (endNorm==0) && (SinceBest<300)){
         iter+=1;
+        timeIteration=omp_get_wtime();
+
+        // KERNEL ROWS OF THE WORKING SET
+
+        if(cache != NULL) kernelCacheRows(cache,dataset,SW,nSW,props,Krows,workspace->cacheBuffers);
 
         // CONSTRUCT GIN AND GBIN
+
+        // The error e[i]=y[i]-sum_j beta[j]K(i,j)-b already contains the effect of every sample, so the
+        // effect of the inactive samples is obtained subtracting the effect of the working set. It only
+        // needs the kernel of the working set against itself instead of against the inactive set.
         
-        if(nSIn>0){
+        if(nSIn>0 || nShrunk>0){
 
             memset(GIN,0.0,(nSW+1)*sizeof(double));
+
+            nSWNZ=0;
+            for (o=0;o<nSW;o++) if (betaNew[SW[o]] != 0.0){
+                SWNZ[nSWNZ]=SW[o];
+                betaSWNZ[nSWNZ]=betaNew[SW[o]];
+                nSWNZ++;
+            }
+
+            nUncached=0;
+            for (i=0;i<nSW;i++) if (Krows[i] == NULL){
+                uncached[nUncached]=i;
+                uncachedIndex[nUncached]=SW[i];
+                uncachedValue[nUncached]=0.0;
+                nUncached++;
+            }
         	  
             #pragma omp parallel default(shared) private(i,o)
             {
             #pragma omp for schedule(static)
-                for (i=0;i<(nSW+1);i++){
+                for (i=0;i<nSW;i++){
                     int o;
-                    if(i<nSW){
-                        for (o=0;o<nSIn;o++) if (betaNew[SIN[o]] != 0.0){
-                            GIN[i] += betaNew[SIN[o]]*kernelFunction(dataset,SW[i], SIN[o], props)*dataset.y[SW[i]];
-                        }
-                        
-                    }else{
-                        for (o=0;o<nSIn;o++) GIN[nSW]+=betaNew[SIN[o]];
+                    if(Krows[i] != NULL){
+                        for (o=0;o<nSWNZ;o++) GIN[i] += betaSWNZ[o]*Krows[i][SWNZ[o]];
                     }
                 }
             }
+
+            // The rows that are not in the cache are calculated by blocks
+            if(nUncached>0){
+                kernelBlockProduct(dataset,uncachedIndex,nUncached,SWNZ,nSWNZ,props,betaSWNZ,uncachedValue);
+                for (i=0;i<nUncached;i++) GIN[uncached[i]]=uncachedValue[i];
+            }
+
+            for (i=0;i<nSW;i++){
+                GIN[i]=(dataset.y[SW[i]]-e[SW[i]]-betaNew[dataset.l]-GIN[i])*dataset.y[SW[i]];
+            }
+
+            // The sum of the inactive weights is the sum of every weight minus the weights of the working set.
+            for (i=0;i<dataset.l;i++) GIN[nSW]+=betaNew[i];
+            for (i=0;i<nSWNZ;i++) GIN[nSW]-=betaSWNZ[i];
             
         }
 
@@ -464,12 +1254,40 @@ double* trainFULL(svm_dataset dataset,properties props){
         for(i=0;i<nSW;i++){
             subdataset.y[i]=dataset.y[SW[i]];
             subdataset.quadratic_value[i]=dataset.quadratic_value[SW[i]];
-            subdataset.x[i]=dataset.x[SW[i]];
+            if(dataset.single==1) subdataset.xs[i]=dataset.xs[SW[i]];
+            else if(dataset.csr==0 && dataset.dense==0) subdataset.x[i]=dataset.x[SW[i]];
             betasub[i]=beta[SW[i]];
             esub[i]=e[SW[i]];
 
         }
 
+        // The rows of the working set are copied because the CSR and dense subsets must be contiguous.
+        if(dataset.dense==1){
+            #pragma omp parallel for schedule(static) private(i)
+            for(i=0;i<nSW;i++){
+                memcpy(&subdataset.matrix[((size_t) i)*dataset.stride],&dataset.matrix[((size_t) SW[i])*dataset.stride],dataset.stride*sizeof(double));
+            }
+        }
+        if(dataset.csr==1){
+            int nnz=0;
+            for(i=0;i<nSW;i++){
+                subdataset.rowPtr[i]=nnz;
+                nnz+=dataset.rowPtr[SW[i]+1]-dataset.rowPtr[SW[i]];
+            }
+            subdataset.rowPtr[nSW]=nnz;
+            if(nnz>subdatasetCapacity){
+                subdatasetCapacity=nnz;
+                subdataset.indexes=(unsigned int *) realloc(subdataset.indexes,subdatasetCapacity*sizeof(unsigned int));
+                subdataset.values=(double *) realloc(subdataset.values,subdatasetCapacity*sizeof(double));
+            }
+            #pragma omp parallel for schedule(static) private(i)
+            for(i=0;i<nSW;i++){
+                int length=subdataset.rowPtr[i+1]-subdataset.rowPtr[i];
+                memcpy(&subdataset.indexes[subdataset.rowPtr[i]],&dataset.indexes[dataset.rowPtr[SW[i]]],length*sizeof(unsigned int));
+                memcpy(&subdataset.values[subdataset.rowPtr[i]],&dataset.values[dataset.rowPtr[SW[i]]],length*sizeof(double));
+            }
+        }
+
 
         betasub[nSW]=beta[dataset.l];
 
@@ -477,7 +1295,9 @@ double* trainFULL(svm_dataset dataset,properties props){
         // CALL TO IRWLS
         /////////////////
 
-        double *betaTmp = subIRWLS(subdataset,props, GIN, esub, betasub);
+        timeSubproblem=omp_get_wtime();
+        double *betaTmp = subIRWLS(subdataset,props, GIN, esub, betasub, SW, Krows, workspace, context);
+        timeSubproblem=omp_get_wtime()-timeSubproblem;
         
 
         /////////////////
@@ -494,22 +1314,39 @@ double* trainFULL(svm_dataset dataset,properties props){
 
         betaNew[dataset.l]=betaTmp[subdataset.l];
 
-        #pragma omp parallel default(shared) private(i)
-        {	
-        #pragma omp for schedule(static)	
-        for (i=0;i<dataset.l;i++){
-            int j;
-
-            for (j=0;j<nSW;j++){  
-                e[i]=e[i]-kernelFunction(dataset,i,SW[j],props)*(betaNew[SW[j]]-beta[SW[j]]);
-                
+        // The weights that changed are compacted, the cached rows and the rest of samples are updated separately
+        nUncached=0;
+        nChanged=0;
+        for (i=0;i<nSW;i++) if (betaNew[SW[i]] != beta[SW[i]]){
+            if (Krows[i] == NULL){
+                uncachedIndex[nUncached]=SW[i];
+                uncachedValue[nUncached]=-(betaNew[SW[i]]-beta[SW[i]]);
+                nUncached++;
+            }else{
+                workspace->changedRows[nChanged]=Krows[i];
+                workspace->delta[nChanged]=betaNew[SW[i]]-beta[SW[i]];
+                nChanged++;
             }
-            e[i]=e[i]-(betaNew[dataset.l]-beta[dataset.l]);
+        }
 
+        cachedRowsErrorUpdate(workspace->changedRows,workspace->delta,nChanged,(nActive==dataset.l) ? NULL : active,nActive,betaNew[dataset.l]-beta[dataset.l],e);
+
+        // The contribution of the rows that are not in the cache is calculated by blocks
+        if(nUncached>0){
+            if(nActive==dataset.l){
+                kernelBlockProduct(dataset,NULL,dataset.l,uncachedIndex,nUncached,props,uncachedValue,e);
+            }else{
+                memset(eUpdate,0,nActive*sizeof(double));
+                kernelBlockProduct(dataset,active,nActive,uncachedIndex,nUncached,props,uncachedValue,eUpdate);
+                for (o=0;o<nActive;o++) e[active[o]]+=eUpdate[o];
+            }
         }
-        }        
 
-        free(betaTmp); 
+
+        if(cache != NULL){
+            kernelCacheRelease(cache,SW,Krows,nSW);
+            memset(Krows,0,nSW*sizeof(double *));
+        }
 
         double deltaW=0.0;
 	double normW=0.0;
@@ -532,6 +1369,50 @@ double* trainFULL(svm_dataset dataset,properties props){
 	    SinceBest+=1;
 	}
 
+        // Deadline: the training stops and the best weights found so far are returned
+        if(props.Deadline>0.0 && endNorm==0 && omp_get_wtime()-trainingStart>=props.Deadline){
+            deadlineReached=1;
+            break;
+        }
+
+
+        //////////////
+        // UNSHRINKING
+        //////////////
+
+        // Before stopping, the error of the shrunk samples is recalculated and every sample is checked again.
+        if(nShrunk>0 && (endNorm==1 || SinceBest>=300)){
+            int *shrunkIndex = workspace->permAux;
+            int *nzIndex = workspace->candidates;
+            double *nzValue = workspace->values;
+            int nNZ=0, nS=0;
+
+            for (i=0;i<dataset.l;i++){
+                if(shrunk[i]==1) shrunkIndex[nS++]=i;
+                if(betaNew[i] != 0.0){
+                    nzIndex[nNZ]=i;
+                    nzValue[nNZ]=betaNew[i];
+                    nNZ++;
+                }
+            }
+
+            memset(eUpdate,0,nS*sizeof(double));
+            kernelBlockProduct(dataset,shrunkIndex,nS,nzIndex,nNZ,props,nzValue,eUpdate);
+            for (o=0;o<nS;o++){
+                i=shrunkIndex[o];
+                e[i]=dataset.y[i]-betaNew[dataset.l]-eUpdate[o];
+                shrunk[i]=0;
+                stable[i]=0;
+            }
+
+            for (i=0;i<dataset.l;i++) active[i]=i;
+            nActive=dataset.l;
+            nShrunk=0;
+            shrinking=0;
+            endNorm=0;
+            SinceBest=0;
+        }
+
 
         ///////////////////////////////
         // UPDATING STOPPING CONDITIONS
@@ -539,12 +1420,19 @@ double* trainFULL(svm_dataset dataset,properties props){
 
         found00=0,found01=0,found02=0,found10=0,found11=0,found12=0;
 
+        // Samples of the working set of the last iteration (the largest violations policy keeps some of them)
+        if(props.WorkingSetPolicy==1){
+            memset(workspace->previous,0,dataset.l*sizeof(char));
+            for (o=0;o<nSW;o++) workspace->previous[SW[o]]=1;
+        }
+
         nSW=0;
         nSIn=0;
         nSC=0;
 
         
-        for (i=0;i<dataset.l;i++){
+        for (o=0;o<nActive;o++){
+            i=active[o];
                
             if(betaNew[i]*dataset.y[i]==((double)props.C)){
                 epsilonTmp=e[i]*dataset.y[i];
@@ -614,9 +1502,84 @@ double* trainFULL(svm_dataset dataset,properties props){
 
         }
         
+        ////////////
+        // SHRINKING
+        ////////////
+
+        for (o=0;o<nSIn;o++) stable[SIN[o]]+=1;
+        for (o=0;o<nSW;o++) stable[SW[o]]=0;
+        for (o=0;o<nSC;o++) stable[SC[o]]=0;
+
+        if(shrinking==1){
+            int nNewActive=0;
+            for (o=0;o<nActive;o++){
+                i=active[o];
+                if(stable[i]>=SHRINK_ITERATIONS){
+                    shrunk[i]=1;
+                    nShrunk++;
+                }else{
+                    active[nNewActive++]=i;
+                }
+            }
+            nActive=nNewActive;
+        }
+
         if(props.verbose==1) printf("%s", ".");
         if(props.verbose==1) fflush(stdout);
 
+        //////////////////////////////
+        // ADAPTIVE WORKING SET SIZE
+        //////////////////////////////
+
+        // The working set grows when the candidates did not fit in it and either the subproblem is cheap
+        // compared with the rest of the iteration or the stop criterion does not improve. It shrinks when
+        // the cubic cost of the subproblem dominates the iteration.
+        if(props.AdaptiveSize==1){
+            double timeOther=(omp_get_wtime()-timeIteration)-timeSubproblem;
+            int newSize=MaxWorkingSize;
+
+            if(nSC>nSW && (timeSubproblem<0.5*timeOther || SinceBest>=ADAPTIVE_STALL)){
+                newSize=(int) ceil(MaxWorkingSize*ADAPTIVE_GROWTH);
+                if(newSize>dataset.l) newSize=dataset.l;
+            }else if(timeSubproblem>2.0*timeOther && SinceBest==0){
+                newSize=(int) (MaxWorkingSize*ADAPTIVE_REDUCTION);
+                if(newSize<minWorkingSize) newSize=minWorkingSize;
+            }
+
+            if(newSize>capacity){
+                capacity=newSize;
+                subdataset.y=(double *) realloc(subdataset.y,capacity*sizeof(double));
+                subdataset.quadratic_value=(double *) realloc(subdataset.quadratic_value,capacity*sizeof(double));
+                subdataset.x=(svm_sample **) realloc(subdataset.x,capacity*sizeof(svm_sample *));
+                subdataset.xs=(svm_sample_single **) realloc(subdataset.xs,capacity*sizeof(svm_sample_single *));
+                if(dataset.dense==1){
+                    void *memory;
+                    if(posix_memalign(&memory,64,((size_t) capacity)*dataset.stride*sizeof(double)) != 0){
+                        fprintf(stderr, "Error: There is not enough memory to store the working set\n");
+                        exit(2);
+                    }
+                    free(subdataset.matrix);
+                    subdataset.matrix = (double *) memory;
+                }
+                if(dataset.csr==1) subdataset.rowPtr=(int *) realloc(subdataset.rowPtr,(capacity+1)*sizeof(int));
+                SW=(int *) realloc(SW,capacity*sizeof(int));
+                GIN=(double *) realloc(GIN,(capacity+1)*sizeof(double));
+                esub=(double *) realloc(esub,(capacity+1)*sizeof(double));
+                betasub=(double *) realloc(betasub,(capacity+1)*sizeof(double));
+                Krows=(double **) realloc(Krows,capacity*sizeof(double *));
+                memset(Krows,0,capacity*sizeof(double *));
+                uncached=(int *) realloc(uncached,capacity*sizeof(int));
+                uncachedIndex=(int *) realloc(uncachedIndex,capacity*sizeof(int));
+                uncachedValue=(double *) realloc(uncachedValue,capacity*sizeof(double));
+                SWNZ=(int *) realloc(SWNZ,capacity*sizeof(int));
+                betaSWNZ=(double *) realloc(betaSWNZ,capacity*sizeof(double));
+                resizeFullWorkspace(workspace,capacity);
+                // Per-thread workspaces of the linear algebra functions
+                updateSolverContext(context,capacity+1);
+            }
+            MaxWorkingSize=newSize;
+        }
+
         //////////////////////
         // SELECT WORKING SET
         //////////////////////
@@ -628,8 +1591,46 @@ double* trainFULL(svm_dataset dataset,properties props){
 
             }
         }else{
-              int *perm = rpermute(nSC);
               int space = (MaxWorkingSize-nSW);
+              int *perm = workspace->perm;
+
+              if(props.WorkingSetPolicy==0){
+                  randomPermutation(perm,nSC,&seed);
+              }else{
+                  // Distance of every candidate to the KKT condition of its group: e*y<=0 for the samples
+                  // with zero weight, e*y>=0 for the samples at the bound C and e*y=0 between the bounds.
+                  #pragma omp parallel for schedule(static) private(i)
+                  for(i=0;i<nSC;i++){
+                      int s=SC[i];
+                      if(betaNew[s]==0.0) violation[i]=e[s]*dataset.y[s];
+                      else if(betaNew[s]*dataset.y[s]==((double)props.C)) violation[i]=-e[s]*dataset.y[s];
+                      else violation[i]=fabs(e[s]*dataset.y[s]);
+                  }
+
+                  if(props.WorkingSetPolicy==1){
+                      // The samples just optimized satisfy their conditions and would never be selected
+                      // again, so consecutive working sets would be disjoint and the solution would
+                      // alternate between them. The largest violations of the previous working set keep
+                      // a part of the space.
+                      int *kept = workspace->permAux;
+                      int nKept=0, keep=(int) (space*VIOLATION_KEPT_RATIO);
+                      for(i=0;i<nSC;i++) if(workspace->previous[SC[i]]==1) kept[nKept++]=i;
+                      if(keep>nKept) keep=nKept;
+                      selectLargest(kept,violation,nKept,keep);
+                      for(i=0;i<keep;i++) violation[kept[i]]=HUGE_VAL;
+                      largestFirstBuffer(violation,nSC,space,props.Threads,perm,workspace->candidates,workspace->selected);
+                  }else{
+                      // Half of the space for the largest violations and the rest is chosen at random
+                      int half = space/2;
+                      largestFirstBuffer(violation,nSC,half,props.Threads,perm,workspace->candidates,workspace->selected);
+                      int *rest = workspace->permAux;
+                      int *tail = workspace->candidates;
+                      randomPermutation(rest,nSC-half,&seed);
+                      for(i=0;i<nSC-half;i++) tail[i]=perm[half+rest[i]];
+                      memcpy(&perm[half],tail,(nSC-half)*sizeof(int));
+                  }
+              }
+
             	for(i=0;i<nSC;i++){
                     if (i<space){
                         SW[nSW]=SC[perm[i]];
@@ -639,12 +1640,78 @@ double* trainFULL(svm_dataset dataset,properties props){
                         nSIn+=1;                	
                     }
             	}
-            	free(perm);
         }
 	
         //memcpy(beta,betaNew,dataset.l*sizeof(double));
+        outerIterations=iter;
+
+        /////////////
+        // CHECKPOINT
+        /////////////
+
+        // The state of the random number generator is stored so a resumed training repeats the same iterations
+        if(writer != NULL && endNorm==0 && SinceBest<300){
+            double now = omp_get_wtime();
+            if((props.CheckpointSeconds>0.0 && now-lastCheckpoint>=props.CheckpointSeconds) || (props.CheckpointSeconds==0.0 && iter%props.CheckpointInterval==0)){
+                trainCheckpoint state;
+                state.l=dataset.l;
+                state.C=props.C;
+                state.Kgamma=props.Kgamma;
+                state.kernelType=props.kernelType;
+                state.iter=iter;
+                state.SinceBest=SinceBest;
+                state.bestNorm=bestNorm;
+                state.MaxWorkingSize=MaxWorkingSize;
+                state.nSW=nSW;
+                state.nSIn=nSIn;
+                state.shrinking=shrinking;
+                state.nActive=nActive;
+                state.nShrunk=nShrunk;
+                state.seed=seed;
+                state.beta=betaNew;
+                state.betaBest=betaBest;
+                state.e=e;
+                state.SW=SW;
+                state.active=active;
+                state.stable=stable;
+                state.shrunk=shrunk;
+                saveCheckpoint(writer,&state);
+                lastCheckpoint=now;
+            }
+        }
+    }
+
+    if(writer != NULL){
+        int written = freeCheckpointWriter(writer);
+        if(props.verbose==1) printf("\n%d checkpoints saved in %s",written,props.Checkpoint);
+    }
+
+    if(deadlineReached==1){
+        memcpy(betaNew,betaBest,(dataset.l+1)*sizeof(double));
+        if(props.verbose==1) printf("\nThe deadline has been reached");
+
+        // The error is the one of the last weights (and it is outdated for the shrunk samples), so it
+        // is calculated again for the best weights e[i]=y[i]-sum_j beta[j]K(i,j)-b
+        if(error != NULL){
+            int *nonZero = (int *) calloc(dataset.l,sizeof(int));
+            double *minusBeta = (double *) calloc(dataset.l,sizeof(double));
+            int nNonZero=0;
+            for (i=0;i<dataset.l;i++){
+                e[i]=dataset.y[i]-betaNew[dataset.l];
+                if(betaNew[i] != 0.0){
+                    nonZero[nNonZero]=i;
+                    minusBeta[nNonZero]=-betaNew[i];
+                    nNonZero++;
+                }
+            }
+            if(nNonZero>0) kernelBlockProduct(dataset,NULL,dataset.l,nonZero,nNonZero,props,minusBeta,e);
+            free(minusBeta);
+            free(nonZero);
+        }
     }
+    if(deadline != NULL) *deadline=deadlineReached;
 
+    if(error != NULL) memcpy(error,e,dataset.l*sizeof(double));
     free(e);
     free(beta);
     free(betaBest);
@@ -660,8 +1727,28 @@ double* trainFULL(svm_dataset dataset,properties props){
     free(subdataset.y);
     free(subdataset.quadratic_value);
     free(subdataset.x);
-    free(betaTmp);
+    free(subdataset.xs);
+    free(subdataset.rowPtr);
+    free(subdataset.indexes);
+    free(subdataset.values);
+    free(subdataset.matrix);
+    free(violation);
+    freeFullWorkspace(workspace);
+    if(ownContext != NULL) freeSolverContext(ownContext);
     if(props.verbose==1) printf("\n");
+    if(props.verbose==1) printf("Outer iterations: %d\n",outerIterations);
+    if(props.verbose==1 && props.AdaptiveSize==1) printf("Final working set size: %d\n",MaxWorkingSize);
+
+    free(Krows);
+    free(uncached);
+    free(uncachedIndex);
+    free(uncachedValue);
+    free(SWNZ);
+    free(active);
+    free(stable);
+    free(shrunk);
+    free(eUpdate);
+    free(betaSWNZ);
   
     return betaNew;
 
@@ -676,17 +1763,49 @@ double* trainFULL(svm_dataset dataset,properties props){
 void printFULLInstructions(void) {
     fprintf(stderr, "full-train: This software train the SVM on the given training set and ");
     fprintf(stderr, "generages a model for futures prediction use.\n\n");
-    fprintf(stderr, "Usage: full-train [options] training_set_file model_file\n\n");
+    fprintf(stderr, "Usage: full-train [options] training_set_file model_file\n");
+    fprintf(stderr, "       full-train -V folds [options] training_set_file\n\n");
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -k kernel type: (default 1)\n");
-    fprintf(stderr, "       0 -- Linear kernel u'*v\n");
+    fprintf(stderr, "       0 -- Linear kernel u'*v (trained in the primal space unless -K or -R are used)\n");
     fprintf(stderr, "       1 -- radial basis function: exp(-gamma*|u-v|^2)\n");
     fprintf(stderr, "  -g gamma: set gamma in radial basis kernel function (default 1)\n");
     fprintf(stderr, "       radial basis K(u,v)= exp(-gamma*|u-v|^2)\n");
     fprintf(stderr, "  -c Cost: set SVM Cost (default 1)\n");
+    fprintf(stderr, "       a list of costs separated by commas trains one model per cost, saved in model_file.c<cost>\n");
     fprintf(stderr, "  -t Threads: Number of threads (default 1)\n");
     fprintf(stderr, "  -w Working set size: Size of the Least Squares problem in every iteration (default 500)\n");
     fprintf(stderr, "  -e eta: Stop criteria (default 0.001)\n");
+    fprintf(stderr, "  -m cache size: Memory budget in MB of the kernel cache (default 100, 0 disables the cache)\n");
+    fprintf(stderr, "  -V folds: k-fold cross validation, it prints the accuracy of every fold and no model is saved (default 0)\n");
+    fprintf(stderr, "  -i initial model: model file used as the starting point of the training (default none)\n");
+    fprintf(stderr, "       its support vectors are found in the training set by their features\n");
+    fprintf(stderr, "  -T deadline: maximum training time in seconds, the best weights found so far are saved (default 0, no limit)\n");
+    fprintf(stderr, "  -K checkpoint file: the state of the solver is saved periodically in this file (default none)\n");
+    fprintf(stderr, "  -I checkpoint interval: number of iterations, or seconds followed by s (default 10)\n");
+    fprintf(stderr, "  -R checkpoint file: resume an interrupted training from a checkpoint (default none)\n");
+    fprintf(stderr, "  -A adaptive working set size: (default 0)\n");
+    fprintf(stderr, "       0 -- The size given by -w is used during the whole training\n");
+    fprintf(stderr, "       1 -- The size starts at -w and it is adapted to the time of every iteration\n");
+    fprintf(stderr, "  -S working set policy: selection among the samples that violate the KKT conditions (default random)\n");
+    fprintf(stderr, "       random -- Random selection\n");
+    fprintf(stderr, "       violation -- Largest violations first\n");
+    fprintf(stderr, "       mixed -- Half largest violations, half random\n");
+    fprintf(stderr, "  -h shrinking: (default 1)\n");
+    fprintf(stderr, "       0 -- Every sample is checked in every iteration\n");
+    fprintf(stderr, "       1 -- The samples that stay at a bound are temporarily removed\n");
+    fprintf(stderr, "  -M multi-class decomposition: used when the training set has more than two classes (default ovo)\n");
+    fprintf(stderr, "       ovo -- One-vs-one, a binary classifier for every pair of classes\n");
+    fprintf(stderr, "       ovr -- One-vs-rest, a binary classifier for every class against the rest\n");
+    fprintf(stderr, "  -x exponential of the rbf kernel: (default 0)\n");
+    fprintf(stderr, "       0 -- Math library\n");
+    fprintf(stderr, "       1 -- Vectorized approximation (relative error below 1e-7)\n");
+    fprintf(stderr, "  -P precision: storage of the features (default double)\n");
+    fprintf(stderr, "       double -- Double precision\n");
+    fprintf(stderr, "       single -- Single precision (half of the memory, kernels are accumulated in double precision)\n");
+    fprintf(stderr, "  -L layout: layout of the features in memory (default samples)\n");
+    fprintf(stderr, "       samples -- Array of (index, value) structs per sample, dense datasets use an aligned dense matrix\n");
+    fprintf(stderr, "       csr -- CSR format, indexes and values in separate arrays (only double precision)\n");
     fprintf(stderr, "  -f file format: (default 1)\n"); 
     fprintf(stderr, "       0 -- CSV format (comma separator)\n");
     fprintf(stderr, "       1 -- libsvm format\n");   
@@ -696,6 +1815,48 @@ void printFULLInstructions(void) {
     fprintf(stderr, "       1 -- Screen messages\n");
 }
 
+/**
+ * @brief It compares two costs.
+ */
+
+static int compareCosts(const void *a, const void *b){
+    double ca=*((const double *) a), cb=*((const double *) b);
+    return (ca>cb)-(ca<cb);
+}
+
+/**
+ * @brief It parses a list of costs.
+ *
+ * It parses a list of costs separated by commas (for example "0.1,1,10,100") and sorts it in increasing order.
+ * @param list The list of costs.
+ * @param n Pointer to store the number of costs.
+ * @return The costs in increasing order.
+ */
+
+double* parseCostList(char *list, int *n){
+    int capacity=1;
+    char *c;
+    for (c=list;*c != '\0';c++) if (*c == ',') capacity++;
+
+    double *costs = (double *) malloc(capacity*sizeof(double));
+    char *copy = strdup(list);
+    char *token = strtok(copy, ",");
+    *n=0;
+    while (token != NULL) {
+        costs[*n] = atof(token);
+        if (costs[*n] <= 0.0) {
+            fprintf(stderr, "Invalid cost %s\n",token);
+            exit(2);
+        }
+        (*n)++;
+        token = strtok(NULL, ",");
+    }
+    free(copy);
+
+    qsort(costs,*n,sizeof(double),compareCosts);
+    return costs;
+}
+
 /**
  * @brief It parses the command line.
  *
@@ -718,6 +1879,22 @@ properties parseTrainFULLParameters(int* argc, char*** argv) {
     props.file = 1;
     props.separator = ",";
     props.verbose = 1;
+    props.CacheSize = 100.0;
+    props.Shrinking = 1;
+    props.WorkingSetPolicy = 0;
+    props.AdaptiveSize = 0;
+    props.InitModel = NULL;
+    props.Checkpoint = NULL;
+    props.CheckpointInterval = 10;
+    props.CheckpointSeconds = 0.0;
+    props.Resume = NULL;
+    props.Deadline = 0.0;
+    props.Multiclass = 0;
+    props.CPath = NULL;
+    props.Folds = 0;
+    props.FastExp = 0;
+    props.Single = 0;
+    props.CSR = 0;
 
     int i,j;
     for (i = 1; i < *argc; ++i) {
@@ -733,6 +1910,7 @@ properties parseTrainFULLParameters(int* argc, char*** argv) {
             props.Kgamma = atof(param_value);
         } else if (strcmp(param_name, "c") == 0) {
             props.C = atof(param_value);
+            if (strchr(param_value, ',') != NULL) props.CPath = param_value;
         } else if (strcmp(param_name, "e") == 0) {
             props.Eta = atof(param_value);
         } else if (strcmp(param_name, "t") == 0) {
@@ -749,13 +1927,110 @@ properties parseTrainFULLParameters(int* argc, char*** argv) {
             props.separator = param_value;
         } else if (strcmp(param_name, "v") == 0) {
             props.verbose = atoi(param_value);
+        } else if (strcmp(param_name, "m") == 0) {
+            props.CacheSize = atof(param_value);
+        } else if (strcmp(param_name, "h") == 0) {
+            props.Shrinking = atoi(param_value);
+        } else if (strcmp(param_name, "V") == 0) {
+            props.Folds = atoi(param_value);
+        } else if (strcmp(param_name, "i") == 0) {
+            props.InitModel = param_value;
+        } else if (strcmp(param_name, "A") == 0) {
+            props.AdaptiveSize = atoi(param_value);
+        } else if (strcmp(param_name, "K") == 0) {
+            props.Checkpoint = param_value;
+        } else if (strcmp(param_name, "I") == 0) {
+            // A number of iterations or a number of seconds followed by s
+            int length = strlen(param_value);
+            int invalid;
+            if (length>0 && param_value[length-1] == 's') {
+                props.CheckpointSeconds = atof(param_value);
+                invalid = (props.CheckpointSeconds<=0.0);
+            } else {
+                props.CheckpointInterval = atoi(param_value);
+                props.CheckpointSeconds = 0.0;
+                invalid = (props.CheckpointInterval<=0);
+            }
+            if (invalid) {
+                fprintf(stderr, "Invalid checkpoint interval %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "R") == 0) {
+            props.Resume = param_value;
+        } else if (strcmp(param_name, "T") == 0) {
+            props.Deadline = atof(param_value);
+        } else if (strcmp(param_name, "S") == 0) {
+            if (strcmp(param_value, "random") == 0) {
+                props.WorkingSetPolicy = 0;
+            } else if (strcmp(param_value, "violation") == 0) {
+                props.WorkingSetPolicy = 1;
+            } else if (strcmp(param_value, "mixed") == 0) {
+                props.WorkingSetPolicy = 2;
+            } else {
+                fprintf(stderr, "Unknown working set policy %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "M") == 0) {
+            if (strcmp(param_value, "ovo") == 0) {
+                props.Multiclass = 0;
+            } else if (strcmp(param_value, "ovr") == 0) {
+                props.Multiclass = 1;
+            } else {
+                fprintf(stderr, "Unknown multi-class decomposition %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "x") == 0) {
+            props.FastExp = atoi(param_value);
+        } else if (strcmp(param_name, "P") == 0) {
+            if (strcmp(param_value, "single") == 0) {
+                props.Single = 1;
+            } else if (strcmp(param_value, "double") == 0) {
+                props.Single = 0;
+            } else {
+                fprintf(stderr, "Unknown precision %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "L") == 0) {
+            if (strcmp(param_value, "csr") == 0) {
+                props.CSR = 1;
+            } else if (strcmp(param_value, "samples") == 0) {
+                props.CSR = 0;
+            } else {
+                fprintf(stderr, "Unknown layout %s\n",param_value);
+                exit(2);
+            }
         } else {
             fprintf(stderr, "Unknown parameter %s\n",param_name);
             printFULLInstructions();
             exit(2);
         }
     }
+
+    if (props.Single==1 && props.CSR==1) {
+        fprintf(stderr, "The csr layout is only available in double precision\n");
+        exit(2);
+    }
   
+    if (props.Folds>0 && (props.InitModel != NULL || props.CPath != NULL)) {
+        fprintf(stderr, "The cross validation can not be used with an initial model or a list of costs\n");
+        exit(2);
+    }
+
+    if ((props.Checkpoint != NULL || props.Resume != NULL) && (props.Folds>0 || props.CPath != NULL)) {
+        fprintf(stderr, "The checkpoints can not be used with the cross validation or a list of costs\n");
+        exit(2);
+    }
+
+    if (props.Deadline>0.0 && props.CPath != NULL) {
+        fprintf(stderr, "The deadline can not be used with a list of costs\n");
+        exit(2);
+    }
+
+    if (props.Resume != NULL && props.InitModel != NULL) {
+        fprintf(stderr, "A training can not be resumed from a checkpoint and an initial model at the same time\n");
+        exit(2);
+    }
+
     for (j = 1; i + j - 1 < *argc; ++j) {
         (*argv)[j] = (*argv)[i + j - 1];
     }
@@ -784,24 +2059,29 @@ model calculateFULLModel(properties props, svm_dataset dataset, double * beta ){
     classifier.maxdim = dataset.maxdim;
     classifier.kernelType = props.kernelType;
     
+    classifier.single = 0;
+    classifier.xs = NULL;
+    classifier.featuresSingle = NULL;
+    classifier.csr = 0;
+    classifier.rowPtr = NULL;
+    classifier.indexes = NULL;
+    classifier.values = NULL;
+    classifier.dense = 0;
+    classifier.matrix = NULL;
+    classifier.stride = 0;
+    
     int nElem=0;
     int nSVs=0;
-    svm_sample *iteratorSample;
-    svm_sample *classifierSample;
     int i;
     for (i =0;i<dataset.l;i++){
         if(beta[i] != 0.0){
             ++nSVs;
-            iteratorSample = dataset.x[i];
-            while (iteratorSample->index != -1){
-            	  ++iteratorSample;
-                ++nElem;
-            }
-            ++nElem;
+            nElem += sampleLength(dataset,i)+1;
         }
     }    
 
     classifier.nSVs = nSVs;
+    classifier.deadline = 0;
     classifier.nElem = nElem;
     classifier.weights = (double *) calloc(nSVs,sizeof(double));
     classifier.quadratic_value = (double *) calloc(nSVs,sizeof(double));
@@ -818,26 +2098,92 @@ model calculateFULLModel(properties props, svm_dataset dataset, double * beta ){
             classifier.weights[indexIt]=beta[i];            
             classifier.x[indexIt] = &classifier.features[featureIt];
             
-            iteratorSample = dataset.x[i];
-            classifierSample = classifier.x[indexIt];
-
-            while (iteratorSample->index != -1){
-                classifierSample->index = iteratorSample->index;
-                classifierSample->value = iteratorSample->value;
-                ++classifierSample;
-                ++iteratorSample;
-                ++featureIt;
-            }
-
-            classifierSample->index = iteratorSample->index;
+            copySample(dataset,i,classifier.x[indexIt]);
+            featureIt += sampleLength(dataset,i)+1;
             
             indexIt++;
-            ++featureIt;
         }
     }        
     return classifier;
 }
 
+/**
+ * @brief k-fold cross validation of the full SVM.
+ *
+ * The dataset is loaded once and every fold is a subset of it that shares its features and norms.
+ * The folds are trained one after another, every one of them using all the threads. It prints the
+ * accuracy and the training time of every fold and the average accuracy.
+ *
+ * @param dataset The training set.
+ * @param props The values of the training parameters (props.Folds is the number of folds).
+ * @return The average accuracy.
+ */
+
+double crossValidationFULL(svm_dataset dataset,properties props){
+    int *fold = crossValidationFolds(dataset.l,props.Folds);
+    int *trainIndexes = (int *) malloc(dataset.l*sizeof(int));
+    int *testIndexes = (int *) malloc(dataset.l*sizeof(int));
+    int f, i;
+    double average=0.0;
+
+    properties foldProps = props;
+    foldProps.verbose = 0;
+
+    predictProperties testProps;
+    testProps.Labels = 1;
+    testProps.Threads = props.Threads;
+    testProps.Soft = 0;
+    testProps.file = props.file;
+    testProps.separator = props.separator;
+    testProps.verbose = 0;
+    testProps.FastExp = props.FastExp;
+    testProps.Single = props.Single;
+    testProps.CSR = props.CSR;
+
+    // The folds are trained one after another with the same context
+    solverContext *context = initSolverContext(props.Threads,props.MaxSize+1);
+
+    for (f=0;f<props.Folds;f++){
+        int nTrain=0, nTest=0;
+        for (i=0;i<dataset.l;i++){
+            if(fold[i]==f) testIndexes[nTest++]=i;
+            else trainIndexes[nTrain++]=i;
+        }
+        svm_dataset trainSet = subsetDataset(dataset,trainIndexes,nTrain);
+        svm_dataset testSet = subsetDataset(dataset,testIndexes,nTest);
+
+        struct timeval time1, time2;
+        gettimeofday(&time1, NULL);
+        model classifier;
+        if(linearEngine(foldProps)==1){
+            double *W = trainLinear(trainSet,foldProps,NULL,NULL);
+            classifier = calculateLinearModel(foldProps,trainSet,W);
+            free(W);
+        }else{
+            double *W = trainFULL(trainSet,foldProps,NULL,NULL,context);
+            classifier = calculateFULLModel(foldProps,trainSet,W);
+            free(W);
+        }
+        gettimeofday(&time2, NULL);
+
+        double accuracy = modelAccuracy(testSet,&classifier,testProps);
+        average += accuracy/props.Folds;
+        printf("Fold %d: accuracy %f, %d support vectors, trained in %ld miliseconds\n",f+1,accuracy,classifier.nSVs,((time2.tv_sec-time1.tv_sec)*1000+(time2.tv_usec-time1.tv_usec)/1000));
+
+        freeModel(classifier);
+        freeDataset(trainSet);
+        freeDataset(testSet);
+    }
+    printf("Cross validation accuracy: %f\n",average);
+
+    freeSolverContext(context);
+
+    free(fold);
+    free(trainIndexes);
+    free(testIndexes);
+    return average;
+}
+
 
 
 /**
@@ -0,0 +1,541 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+ 
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ 
+ ============================================================================
+ */
+
+/**
+ * @brief Implementation of the grid search of the training parameters.
+ *
+ * See grid-search.h for a detailed description of its functions and parameters.
+ *
+ * @file grid-search.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @see grid-search.h
+ *
+ */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include "ParallelAlgorithms.h"
+#include "full-train.h"
+#include "budgeted-train.h"
+#include "linear-train.h"
+#include "LIBIRWLS-predict.h"
+#include "simdKernels.h"
+#include "jobQueue.h"
+#include "grid-search.h"
+
+
+/**
+ * @cond
+ */
+
+/** @brief Training sets with at least this number of samples are trained one at a time using all the threads. */
+#define GRID_SHARED_SAMPLES 20000
+
+/**
+ * @brief It compares two points by their expected training time (largest cost and budget first).
+ */
+
+static int compareGridCost(const void *a, const void *b){
+    const gridPoint *pa=(const gridPoint *) a, *pb=(const gridPoint *) b;
+    double ca=pa->C*(pa->size>0 ? pa->size : 1), cb=pb->C*(pb->size>0 ? pb->size : 1);
+    if(ca>cb) return -1;
+    if(ca<cb) return 1;
+    return 0;
+}
+
+/**
+ * @brief It compares two points by their accuracy (best first, fewer support vectors in a tie).
+ */
+
+static int compareGridAccuracy(const void *a, const void *b){
+    const gridPoint *pa=(const gridPoint *) a, *pb=(const gridPoint *) b;
+    if(pa->accuracy>pb->accuracy) return -1;
+    if(pa->accuracy<pb->accuracy) return 1;
+    if(pa->nSVs<pb->nSVs) return -1;
+    if(pa->nSVs>pb->nSVs) return 1;
+    return 0;
+}
+
+/**
+ * @brief It trains a point of the grid on a fold and returns the accuracy on the rest of the dataset.
+ */
+
+static double gridJob(svm_dataset trainSet, svm_dataset testSet, properties props, predictProperties testProps, int budgeted, int *nSVs, solverContext *context){
+    model classifier;
+
+    if(budgeted==1){
+        int *centroids;
+        if (props.algorithm==0){
+            centroids=randomCentroids(trainSet,props);
+        }else{
+            centroids=SGMA(trainSet,props);
+        }
+        omp_set_num_threads(props.Threads);
+        double *W = IRWLSpar(trainSet,centroids,props,NULL,NULL,context);
+        classifier = calculateBudgetedModel(props,trainSet,centroids,W);
+        free(centroids);
+        free(W);
+    }else if(linearEngine(props)==1){
+        double *W = trainLinear(trainSet,props,NULL,NULL);
+        classifier = calculateLinearModel(props,trainSet,W);
+        free(W);
+    }else{
+        double *W = trainFULL(trainSet,props,NULL,NULL,context);
+        classifier = calculateFULLModel(props,trainSet,W);
+        free(W);
+    }
+
+    *nSVs=classifier.nSVs;
+    double accuracy = modelAccuracy(testSet,&classifier,testProps);
+    freeModel(classifier);
+    return accuracy;
+}
+
+/**
+ * @brief It parses a list of positive values separated by commas.
+ *
+ * @param list The list of values.
+ * @param n It returns the number of values.
+ * @return The values in the order of the list.
+ */
+
+double* parseGridList(char *list, int *n){
+    double *values = (double *) malloc((strlen(list)/2+1)*sizeof(double));
+    char *copy = strdup(list);
+    char *token = strtok(copy, ",");
+    *n=0;
+    while (token != NULL) {
+        values[*n] = atof(token);
+        if (values[*n] <= 0.0) {
+            fprintf(stderr, "Invalid value %s in the grid\n",token);
+            exit(2);
+        }
+        (*n)++;
+        token = strtok(NULL, ",");
+    }
+    free(copy);
+
+    if (*n == 0) {
+        fprintf(stderr, "Empty list of values in the grid\n");
+        exit(2);
+    }
+    return values;
+}
+
+/**
+ * @brief Grid search using k-fold cross validation.
+ *
+ * The trainings of every point and fold are scheduled across props.train.Threads threads. Every worker
+ * owns a queue of jobs, it takes the jobs from the front of its own queue and, when it is empty, it steals
+ * jobs from the back of the queues of the other workers.
+ *
+ * Small training sets run many single-threaded jobs at the same time (one per thread) while large training
+ * sets, or grids with fewer jobs than threads, run the jobs one after another using all the threads.
+ *
+ * @param dataset The training set.
+ * @param props The values of the grid and the training parameters (props.train.Folds is the number of folds).
+ * @return The result of every point of the grid, sorted by accuracy (best first).
+ */
+
+gridPoint* gridSearch(svm_dataset dataset, gridProperties props){
+    int folds=props.train.Folds;
+    int nPoints=props.nC*props.nGamma*props.nSize;
+    int nJobs=nPoints*folds;
+    int i, j, k, f;
+
+    // The costliest points are dealt first so that the last jobs are the shortest ones
+    gridPoint *points = (gridPoint *) calloc(nPoints,sizeof(gridPoint));
+    int p=0;
+    for (i=0;i<props.nC;i++){
+        for (j=0;j<props.nGamma;j++){
+            for (k=0;k<props.nSize;k++){
+                points[p].C=props.C[i];
+                points[p].Kgamma=props.Kgamma[j];
+                points[p].size=(props.Budgeted==1) ? props.size[k] : 0;
+                p++;
+            }
+        }
+    }
+    qsort(points,nPoints,sizeof(gridPoint),compareGridCost);
+
+    // The folds are built once and shared by all the points
+    int *fold = crossValidationFolds(dataset.l,folds);
+    int *trainIndexes = (int *) malloc(dataset.l*sizeof(int));
+    int *testIndexes = (int *) malloc(dataset.l*sizeof(int));
+    svm_dataset *trainSets = (svm_dataset *) malloc(folds*sizeof(svm_dataset));
+    svm_dataset *testSets = (svm_dataset *) malloc(folds*sizeof(svm_dataset));
+    int smallestTrain=dataset.l;
+
+    for (f=0;f<folds;f++){
+        int nTrain=0, nTest=0;
+        for (i=0;i<dataset.l;i++){
+            if(fold[i]==f) testIndexes[nTest++]=i;
+            else trainIndexes[nTrain++]=i;
+        }
+        trainSets[f] = subsetDataset(dataset,trainIndexes,nTrain);
+        testSets[f] = subsetDataset(dataset,testIndexes,nTest);
+        if(nTrain<smallestTrain) smallestTrain=nTrain;
+    }
+    free(fold);
+    free(trainIndexes);
+    free(testIndexes);
+
+    // Many single-threaded jobs or one multi-threaded job at a time
+    int nWorkers=1, jobThreads=props.train.Threads;
+    if(props.train.Threads>1 && smallestTrain<GRID_SHARED_SAMPLES && nJobs>=props.train.Threads){
+        nWorkers=props.train.Threads;
+        jobThreads=1;
+    }
+
+    properties jobProps = props.train;
+    jobProps.Threads = jobThreads;
+    jobProps.verbose = 0;
+    jobProps.Folds = 0;
+    jobProps.CPath = NULL;
+    jobProps.InitModel = NULL;
+    // The temporal memory of the linear systems is shared by the threads of a job and can not grow
+    jobProps.AdaptiveSize = 0;
+    // Every worker has its own kernel cache
+    jobProps.CacheSize = props.train.CacheSize/nWorkers;
+
+    predictProperties testProps;
+    testProps.Labels = 1;
+    testProps.Threads = jobThreads;
+    testProps.Soft = 0;
+    testProps.file = props.train.file;
+    testProps.separator = props.train.separator;
+    testProps.verbose = 0;
+    testProps.FastExp = props.train.FastExp;
+    testProps.Single = props.train.Single;
+    testProps.CSR = props.train.CSR;
+
+    if(props.train.verbose==1){
+        printf("Running %d jobs (%d points and %d folds) on %d workers of %d threads\n\n",nJobs,nPoints,folds,nWorkers,jobThreads);
+    }
+
+    // Single-threaded jobs solve the linear systems with LAPACK and they do not need the temporal memory
+    int memorySize=1;
+    if(jobThreads>1){
+        memorySize=props.train.MaxSize+1;
+        for (k=0;k<props.nSize && props.Budgeted==1;k++){
+            if(props.size[k]>memorySize) memorySize=props.size[k];
+        }
+    }
+
+    // The jobs are point*folds+fold
+    jobQueue *queues = initJobQueues(nJobs,nWorkers);
+
+    double *accuracy = (double *) calloc(nJobs,sizeof(double));
+    double *time = (double *) calloc(nJobs,sizeof(double));
+    int *nSVs = (int *) calloc(nJobs,sizeof(int));
+
+    // The kernel functions are selected before the workers start
+    simdInstructionSet();
+    // The parallel regions inside a single-threaded job run on its own thread
+    omp_set_max_active_levels(1);
+
+    #pragma omp parallel num_threads(nWorkers)
+    {
+        int worker=omp_get_thread_num();
+        int job;
+        // Every worker has its own context, so the jobs do not share the temporal memory
+        solverContext *context = initSolverContext(jobThreads,memorySize);
+        while((job=nextJob(queues,nWorkers,worker))>=0){
+            int point=job/folds, jobFold=job%folds;
+            properties pointProps = jobProps;
+            pointProps.C = points[point].C;
+            pointProps.Kgamma = points[point].Kgamma;
+            if(props.Budgeted==1) pointProps.size = points[point].size;
+
+            double start=omp_get_wtime();
+            accuracy[job]=gridJob(trainSets[jobFold],testSets[jobFold],pointProps,testProps,props.Budgeted,&nSVs[job],context);
+            time[job]=omp_get_wtime()-start;
+
+            if(props.train.verbose==1){
+                #pragma omp critical
+                {
+                    printf("C = %g, gamma = %g",pointProps.C,pointProps.Kgamma);
+                    if(props.Budgeted==1) printf(", size = %d",pointProps.size);
+                    printf(", fold %d: accuracy %f in %.3f seconds\n",jobFold+1,accuracy[job],time[job]);
+                    fflush(stdout);
+                }
+            }
+        }
+        freeSolverContext(context);
+    }
+
+    for (p=0;p<nPoints;p++){
+        for (f=0;f<folds;f++){
+            points[p].accuracy += accuracy[p*folds+f]/folds;
+            points[p].nSVs += 1.0*nSVs[p*folds+f]/folds;
+            points[p].time += time[p*folds+f];
+        }
+    }
+    qsort(points,nPoints,sizeof(gridPoint),compareGridAccuracy);
+
+    freeJobQueues(queues,nWorkers);
+    for (f=0;f<folds;f++){
+        freeDataset(trainSets[f]);
+        freeDataset(testSets[f]);
+    }
+    free(trainSets);
+    free(testSets);
+    free(accuracy);
+    free(time);
+    free(nSVs);
+
+    return points;
+}
+
+/**
+ * @brief It prints the ranked table of the results of the grid.
+ *
+ * @param points The results of the grid sorted by accuracy.
+ * @param n The number of points.
+ * @param budgeted If the budget size column is printed.
+ */
+
+void printGridRanking(gridPoint *points, int n, int budgeted){
+    int i;
+    printf("\n%5s %12s %12s ","Rank","C","gamma");
+    if(budgeted==1) printf("%8s ","size");
+    printf("%10s %10s %12s\n","accuracy","SVs","time (s)");
+    for (i=0;i<n;i++){
+        printf("%5d %12g %12g ",i+1,points[i].C,points[i].Kgamma);
+        if(budgeted==1) printf("%8d ",points[i].size);
+        printf("%10f %10.1f %12.3f\n",points[i].accuracy,points[i].nSVs,points[i].time);
+    }
+    printf("\n");
+}
+
+/**
+ * @brief It shows the command line instructions in the standard output.
+ *
+ * It shows the command line instructions in the standard output.
+ */
+
+void printGridInstructions(void) {
+    fprintf(stderr, "grid-search: This software searches the training parameters of a SVM on a grid of values using k-fold cross validation.\n\n");
+    fprintf(stderr, "Usage: grid-search [options] training_set_file\n\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -k kernel type: (default 1)\n");
+    fprintf(stderr, "       0 -- Linear kernel u'*v (the gamma values are ignored)\n");
+    fprintf(stderr, "       1 -- radial basis function: exp(-gamma*|u-v|^2)\n");
+    fprintf(stderr, "  -g gamma: list of gamma values separated by commas (default 1)\n");
+    fprintf(stderr, "  -c Cost: list of costs separated by commas (default 1)\n");
+    fprintf(stderr, "  -s Classifier size: list of budget sizes separated by commas, it selects the budgeted solver (default full solver)\n");
+    fprintf(stderr, "  -a Algorithm of the budgeted solver: (default 1)\n");
+    fprintf(stderr, "       0 -- Random Selection\n");
+    fprintf(stderr, "       1 -- SGMA (Sparse Greedy Matrix Approximation)\n");
+    fprintf(stderr, "  -V folds: number of folds of the cross validation (default 3)\n");
+    fprintf(stderr, "  -t Threads: Number of threads (default 1)\n");
+    fprintf(stderr, "  -w Working set size: Size of the Least Squares problem in every iteration of the full solver (default 500)\n");
+    fprintf(stderr, "  -e eta: Stop criteria (default 0.001)\n");
+    fprintf(stderr, "  -m cache size: Memory budget in MB of the kernel caches of the full solver, shared by the concurrent jobs (default 100)\n");
+    fprintf(stderr, "  -S working set policy: selection among the samples that violate the KKT conditions (default random)\n");
+    fprintf(stderr, "       random -- Random selection\n");
+    fprintf(stderr, "       violation -- Largest violations first\n");
+    fprintf(stderr, "       mixed -- Half largest violations, half random\n");
+    fprintf(stderr, "  -h shrinking: (default 1)\n");
+    fprintf(stderr, "       0 -- Every sample is checked in every iteration\n");
+    fprintf(stderr, "       1 -- The samples that stay at a bound are temporarily removed\n");
+    fprintf(stderr, "  -x exponential of the rbf kernel: (default 0)\n");
+    fprintf(stderr, "       0 -- Math library\n");
+    fprintf(stderr, "       1 -- Vectorized approximation (relative error below 1e-7)\n");
+    fprintf(stderr, "  -P precision: storage of the features (default double)\n");
+    fprintf(stderr, "       double -- Double precision\n");
+    fprintf(stderr, "       single -- Single precision (half of the memory, kernels are accumulated in double precision)\n");
+    fprintf(stderr, "  -L layout: layout of the features in memory (default samples)\n");
+    fprintf(stderr, "       samples -- Array of (index, value) structs per sample, dense datasets use an aligned dense matrix\n");
+    fprintf(stderr, "       csr -- CSR format, indexes and values in separate arrays (only double precision)\n");
+    fprintf(stderr, "  -f file format: (default 1)\n");
+    fprintf(stderr, "       0 -- CSV format (comma separator)\n");
+    fprintf(stderr, "       1 -- libsvm format\n");
+    fprintf(stderr, "  -p separator: csv separator character (default \",\" if csv format is selected)\n");
+    fprintf(stderr, "  -v verbose: (default 1)\n");
+    fprintf(stderr, "       0 -- Only the ranked table\n");
+    fprintf(stderr, "       1 -- Screen messages\n");
+}
+
+/**
+ * @brief It parses the command line.
+ *
+ * It parses input command line to extract the parameters of the grid search.
+ * @param argc The number of words of the command line.
+ * @param argv The list of words of the command line.
+ * @return A struct that contains the values of the grid and the training parameters.
+ */
+
+gridProperties parseGridParameters(int* argc, char*** argv) {
+
+    gridProperties props;
+    props.train.Kgamma = 1.0;
+    props.train.C = 1.0;
+    props.train.Threads=1;
+    props.train.MaxSize=500;
+    props.train.Eta=0.001;
+    props.train.size=10;
+    props.train.algorithm=1;
+    props.train.kernelType=1;
+    props.train.file = 1;
+    props.train.separator = ",";
+    props.train.verbose = 1;
+    props.train.CacheSize = 100.0;
+    props.train.Shrinking = 1;
+    props.train.WorkingSetPolicy = 0;
+    props.train.AdaptiveSize = 0;
+    props.train.InitModel = NULL;
+    props.train.Checkpoint = NULL;
+    props.train.CheckpointInterval = 10;
+    props.train.CheckpointSeconds = 0.0;
+    props.train.Resume = NULL;
+    props.train.Deadline = 0.0;
+    props.train.Multiclass = 0;
+    props.train.CPath = NULL;
+    props.train.Folds = 3;
+    props.train.FastExp = 0;
+    props.train.Single = 0;
+    props.train.CSR = 0;
+
+    char *costList = "1";
+    char *gammaList = "1";
+    char *sizeList = NULL;
+
+    int i,j;
+    for (i = 1; i < *argc; ++i) {
+        if ((*argv)[i][0] != '-') break;
+        if (++i >= *argc) {
+            printGridInstructions();
+            exit(1);
+        }
+
+        char* param_name = &(*argv)[i-1][1];
+        char* param_value = (*argv)[i];
+        if (strcmp(param_name, "g") == 0) {
+            gammaList = param_value;
+        } else if (strcmp(param_name, "c") == 0) {
+            costList = param_value;
+        } else if (strcmp(param_name, "s") == 0) {
+            sizeList = param_value;
+        } else if (strcmp(param_name, "a") == 0) {
+            props.train.algorithm = atoi(param_value);
+        } else if (strcmp(param_name, "e") == 0) {
+            props.train.Eta = atof(param_value);
+        } else if (strcmp(param_name, "t") == 0) {
+            props.train.Threads = atoi(param_value);
+        } else if (strcmp(param_name, "k") == 0) {
+            props.train.kernelType = atoi(param_value);
+        } else if (strcmp(param_name, "w") == 0) {
+            props.train.MaxSize = atoi(param_value);
+        } else if (strcmp(param_name, "f") == 0) {
+            props.train.file = atoi(param_value);
+        } else if (strcmp(param_name, "p") == 0) {
+            props.train.separator = param_value;
+        } else if (strcmp(param_name, "v") == 0) {
+            props.train.verbose = atoi(param_value);
+        } else if (strcmp(param_name, "m") == 0) {
+            props.train.CacheSize = atof(param_value);
+        } else if (strcmp(param_name, "h") == 0) {
+            props.train.Shrinking = atoi(param_value);
+        } else if (strcmp(param_name, "V") == 0) {
+            props.train.Folds = atoi(param_value);
+        } else if (strcmp(param_name, "S") == 0) {
+            if (strcmp(param_value, "random") == 0) {
+                props.train.WorkingSetPolicy = 0;
+            } else if (strcmp(param_value, "violation") == 0) {
+                props.train.WorkingSetPolicy = 1;
+            } else if (strcmp(param_value, "mixed") == 0) {
+                props.train.WorkingSetPolicy = 2;
+            } else {
+                fprintf(stderr, "Unknown working set policy %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "x") == 0) {
+            props.train.FastExp = atoi(param_value);
+        } else if (strcmp(param_name, "P") == 0) {
+            if (strcmp(param_value, "single") == 0) {
+                props.train.Single = 1;
+            } else if (strcmp(param_value, "double") == 0) {
+                props.train.Single = 0;
+            } else {
+                fprintf(stderr, "Unknown precision %s\n",param_value);
+                exit(2);
+            }
+        } else if (strcmp(param_name, "L") == 0) {
+            if (strcmp(param_value, "csr") == 0) {
+                props.train.CSR = 1;
+            } else if (strcmp(param_value, "samples") == 0) {
+                props.train.CSR = 0;
+            } else {
+                fprintf(stderr, "Unknown layout %s\n",param_value);
+                exit(2);
+            }
+        } else {
+            fprintf(stderr, "Unknown parameter %s\n",param_name);
+            printGridInstructions();
+            exit(2);
+        }
+    }
+
+    if (props.train.Single==1 && props.train.CSR==1) {
+        fprintf(stderr, "The csr layout is only available in double precision\n");
+        exit(2);
+    }
+
+    if (props.train.Folds<2) {
+        fprintf(stderr, "The grid search needs at least 2 folds\n");
+        exit(2);
+    }
+
+    props.C = parseGridList(costList,&props.nC);
+    props.Kgamma = parseGridList(gammaList,&props.nGamma);
+    // The gamma values are ignored by the linear kernel
+    if (props.train.kernelType==0) props.nGamma=1;
+
+    props.Budgeted = (sizeList != NULL);
+    props.nSize = 1;
+    props.size = (int *) malloc(sizeof(int));
+    props.size[0] = props.train.size;
+    if (props.Budgeted==1) {
+        double *sizes = parseGridList(sizeList,&props.nSize);
+        props.size = (int *) realloc(props.size,props.nSize*sizeof(int));
+        for (j=0;j<props.nSize;j++) props.size[j]=(int) sizes[j];
+        free(sizes);
+    }
+
+    for (j = 1; i + j - 1 < *argc; ++j) {
+        (*argv)[j] = (*argv)[i + j - 1];
+    }
+    *argc -= i - 1;
+
+    return props;
+
+}
+
+/**
+ * @endcond
+ */
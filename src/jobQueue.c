@@ -0,0 +1,104 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @brief Implementation of the work-stealing queues of jobs.
+ *
+ * It implements the interface defined by jobQueue.h. See jobQueue.h for a detailed description of its functions.
+ *
+ * @file jobQueue.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ *
+ * @see jobQueue.h
+ */
+
+#include <omp.h>
+#include <stdlib.h>
+
+#include "jobQueue.h"
+
+/**
+ * @cond
+ */
+
+/**
+ * @brief It takes the first job of the queue of a worker (-1 if it is empty).
+ */
+
+static int popJob(jobQueue *queue){
+    int job=-1;
+    omp_set_lock(&queue->lock);
+    if(queue->head<queue->tail) job=queue->jobs[queue->head++];
+    omp_unset_lock(&queue->lock);
+    return job;
+}
+
+/**
+ * @brief It steals the last job of the queue of other worker (-1 if it is empty).
+ */
+
+static int stealJob(jobQueue *queue){
+    int job=-1;
+    omp_set_lock(&queue->lock);
+    if(queue->head<queue->tail) job=queue->jobs[--queue->tail];
+    omp_unset_lock(&queue->lock);
+    return job;
+}
+
+jobQueue *initJobQueues(int nJobs, int nWorkers){
+    jobQueue *queues = (jobQueue *) malloc(nWorkers*sizeof(jobQueue));
+    int i;
+    for (i=0;i<nWorkers;i++){
+        queues[i].jobs = (int *) malloc((nJobs/nWorkers+1)*sizeof(int));
+        queues[i].head = 0;
+        queues[i].tail = 0;
+        omp_init_lock(&queues[i].lock);
+    }
+    for (i=0;i<nJobs;i++){
+        jobQueue *queue=&queues[i%nWorkers];
+        queue->jobs[queue->tail++]=i;
+    }
+    return queues;
+}
+
+int nextJob(jobQueue *queues, int nWorkers, int worker){
+    int job=popJob(&queues[worker]);
+    int k;
+    for(k=1;k<nWorkers && job<0;k++){
+        job=stealJob(&queues[(worker+k)%nWorkers]);
+    }
+    return job;
+}
+
+void freeJobQueues(jobQueue *queues, int nWorkers){
+    int i;
+    for (i=0;i<nWorkers;i++){
+        omp_destroy_lock(&queues[i].lock);
+        free(queues[i].jobs);
+    }
+    free(queues);
+}
+
+/**
+ * @endcond
+ */
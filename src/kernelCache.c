@@ -0,0 +1,416 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @brief Implementation of the cache of rows of the kernel matrix.
+ *
+ * It implements the interface defined by kernelCache.h. See kernelCache.h for a detailed description of its functions.
+ *
+ * @file kernelCache.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ *
+ * @see kernelCache.h
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "kernelCache.h"
+#include "kernels.h"
+
+/**
+ * @cond
+ */
+
+/**
+ * @brief It creates a kernel cache.
+ *
+ * It creates a cache of kernel rows for a dataset with l samples. The number of rows is limited by a memory budget.
+ * The memory of every row is allocated the first time that it is used.
+ *
+ * @param l The number of samples of the dataset.
+ * @param megabytes The memory budget in MB.
+ * @return The cache or NULL if the budget is not enough to store a single row.
+ */
+
+kernelCache *initKernelCache(int l, double megabytes){
+
+    double capacity = (megabytes*1024.0*1024.0)/(l*sizeof(double));
+    if(capacity>l) capacity=l;
+    if(capacity<1.0) return NULL;
+
+    kernelCache *cache = (kernelCache *) malloc(sizeof(kernelCache));
+    cache->l = l;
+    cache->capacity = (int) capacity;
+    cache->nSlots = 0;
+    cache->rows = (double **) calloc(cache->capacity,sizeof(double *));
+    cache->slotSample = (int *) malloc(cache->capacity*sizeof(int));
+    cache->pinned = (int *) calloc(cache->capacity,sizeof(int));
+    cache->prev = (int *) malloc(cache->capacity*sizeof(int));
+    cache->next = (int *) malloc(cache->capacity*sizeof(int));
+    cache->sampleSlot = (int *) malloc(l*sizeof(int));
+    cache->head = -1;
+    cache->tail = -1;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->pending = (char *) calloc(cache->capacity,sizeof(char));
+    cache->parent = NULL;
+    cache->map = NULL;
+    cache->parentIndexes = NULL;
+    cache->parentRows = NULL;
+    cache->uncached = NULL;
+    cache->uncachedRows = NULL;
+    cache->parentBuffers = NULL;
+
+    int i;
+    for(i=0;i<l;i++) cache->sampleSlot[i]=-1;
+    for(i=0;i<cache->capacity;i++) cache->slotSample[i]=-1;
+
+    pthread_mutex_init(&cache->lock,NULL);
+    pthread_cond_init(&cache->ready,NULL);
+
+    return cache;
+}
+
+/**
+ * @brief It creates a view of a kernel cache.
+ *
+ * It creates a cache of the rows of a subset whose missing rows are gathered from the cache of the dataset.
+ *
+ * @param parent The cache of the dataset (NULL to create a cache that is not a view).
+ * @param parentDataset The dataset.
+ * @param map The sample of the dataset of every sample of the subset (the array is copied).
+ * @param l The number of samples of the subset.
+ * @param megabytes The memory budget of the view in MB.
+ * @return The view or NULL if the budget is not enough to store a single row.
+ */
+
+kernelCache *initKernelCacheView(kernelCache *parent, svm_dataset parentDataset, int *map, int l, double megabytes){
+
+    kernelCache *cache = initKernelCache(l,megabytes);
+    if(cache==NULL || parent==NULL) return cache;
+
+    cache->parent = parent;
+    cache->parentDataset = parentDataset;
+    cache->map = (int *) malloc(l*sizeof(int));
+    memcpy(cache->map,map,l*sizeof(int));
+
+    // A request never has more rows than samples in the subset
+    cache->parentIndexes = (int *) malloc(l*sizeof(int));
+    cache->parentRows = (double **) malloc(l*sizeof(double *));
+    cache->uncached = (int *) malloc(l*sizeof(int));
+    cache->uncachedRows = (double **) malloc(l*sizeof(double *));
+    cache->parentBuffers = initKernelCacheBuffers(l);
+    return cache;
+}
+
+/**
+ * @brief Free cache memory
+ *
+ * Free memory allocated by a kernel cache.
+ * @param cache The cache.
+ */
+
+void freeKernelCache(kernelCache *cache){
+
+    if(cache==NULL) return;
+
+    int i;
+    for(i=0;i<cache->nSlots;i++) free(cache->rows[i]);
+
+    pthread_mutex_destroy(&cache->lock);
+    pthread_cond_destroy(&cache->ready);
+    free(cache->rows);
+    free(cache->slotSample);
+    free(cache->sampleSlot);
+    free(cache->pinned);
+    free(cache->prev);
+    free(cache->next);
+    free(cache->pending);
+    free(cache->map);
+    free(cache->parentIndexes);
+    free(cache->parentRows);
+    free(cache->uncached);
+    free(cache->uncachedRows);
+    freeKernelCacheBuffers(cache->parentBuffers);
+    free(cache);
+}
+
+/**
+ * @brief It creates the buffers of the requests to a kernel cache.
+ *
+ * @param size The maximum number of rows of a request.
+ * @return The buffers.
+ */
+
+kernelCacheBuffers *initKernelCacheBuffers(int size){
+
+    if(size<1) size=1;
+
+    kernelCacheBuffers *buffers = (kernelCacheBuffers *) malloc(sizeof(kernelCacheBuffers));
+    buffers->size = size;
+    buffers->missing = (int *) malloc(size*sizeof(int));
+    buffers->missingSlot = (int *) malloc(size*sizeof(int));
+    buffers->missingRows = (double **) malloc(size*sizeof(double *));
+    buffers->waiting = (int *) malloc(size*sizeof(int));
+    return buffers;
+}
+
+/**
+ * @brief Free buffers memory
+ *
+ * Free memory allocated by the buffers of the requests to a kernel cache.
+ * @param buffers The buffers.
+ */
+
+void freeKernelCacheBuffers(kernelCacheBuffers *buffers){
+
+    if(buffers==NULL) return;
+
+    free(buffers->missing);
+    free(buffers->missingSlot);
+    free(buffers->missingRows);
+    free(buffers->waiting);
+    free(buffers);
+}
+
+/**
+ * @brief It removes a slot from the LRU list.
+ *
+ * @param cache The cache.
+ * @param slot The slot.
+ */
+
+static void unlinkSlot(kernelCache *cache, int slot){
+    if(cache->prev[slot] != -1) cache->next[cache->prev[slot]]=cache->next[slot];
+    else cache->head=cache->next[slot];
+    if(cache->next[slot] != -1) cache->prev[cache->next[slot]]=cache->prev[slot];
+    else cache->tail=cache->prev[slot];
+}
+
+/**
+ * @brief It puts a slot at the beginning of the LRU list (most recently used).
+ *
+ * @param cache The cache.
+ * @param slot The slot.
+ */
+
+static void linkSlotFront(kernelCache *cache, int slot){
+    cache->prev[slot]=-1;
+    cache->next[slot]=cache->head;
+    if(cache->head != -1) cache->prev[cache->head]=slot;
+    cache->head=slot;
+    if(cache->tail == -1) cache->tail=slot;
+}
+
+/**
+ * @brief It obtains a slot to store a new row.
+ *
+ * It allocates a new slot if the memory budget has not been reached or it replaces
+ * the least recently used slot that is not pinned.
+ *
+ * @param cache The cache.
+ * @return The slot or -1 if every slot is pinned.
+ */
+
+static int freeSlot(kernelCache *cache){
+
+    int slot;
+
+    if(cache->nSlots<cache->capacity){
+        slot=cache->nSlots;
+        cache->rows[slot]=(double *) malloc((cache->l)*sizeof(double));
+        cache->nSlots++;
+        linkSlotFront(cache,slot);
+        return slot;
+    }
+
+    slot=cache->tail;
+    while(slot != -1 && cache->pinned[slot]>0) slot=cache->prev[slot];
+    if(slot == -1) return -1;
+
+    cache->sampleSlot[cache->slotSample[slot]]=-1;
+    cache->slotSample[slot]=-1;
+    unlinkSlot(cache,slot);
+    linkSlotFront(cache,slot);
+    return slot;
+}
+
+/**
+ * @brief It calculates the rows of a view.
+ *
+ * The rows are requested to the cache of the dataset and the samples of the subset are gathered.
+ * The rows that do not fit in the cache of the dataset are calculated for the subset only. The
+ * buffers of the view are used, so only the thread that owns the view can call this function.
+ *
+ * @param cache The view.
+ * @param dataset The subset.
+ * @param indexes The indexes of the samples in the subset.
+ * @param n The number of samples.
+ * @param props The training parameters (kernel function).
+ * @param rows Array of n rows of the subset where the result is stored.
+ */
+
+static void viewRows(kernelCache *cache, svm_dataset dataset, int *indexes, int n, properties props, double **rows){
+
+    if(n==0) return;
+
+    int *parentIndexes = cache->parentIndexes;
+    double **parentRows = cache->parentRows;
+    int *uncached = cache->uncached;
+    double **uncachedRows = cache->uncachedRows;
+    int nUncached=0;
+    int k;
+
+    for(k=0;k<n;k++) parentIndexes[k]=cache->map[indexes[k]];
+    kernelCacheRows(cache->parent,cache->parentDataset,parentIndexes,n,props,parentRows,cache->parentBuffers);
+
+    for(k=0;k<n;k++){
+        if(parentRows[k]==NULL){
+            uncached[nUncached]=indexes[k];
+            uncachedRows[nUncached]=rows[k];
+            nUncached++;
+        }
+    }
+
+    #pragma omp parallel for schedule(dynamic) private(k)
+    for(k=0;k<n;k++){
+        if(parentRows[k] != NULL){
+            int i;
+            for(i=0;i<cache->l;i++) rows[k][i]=parentRows[k][cache->map[i]];
+        }
+    }
+    kernelBlock(dataset,uncached,nUncached,NULL,cache->l,props,uncachedRows);
+
+    kernelCacheRelease(cache->parent,parentIndexes,parentRows,n);
+}
+
+/**
+ * @brief It obtains a set of rows of the kernel matrix.
+ *
+ * It looks for the rows of the kernel matrix of a list of samples. The rows that are not
+ * in the cache are calculated in parallel. The rows are pinned and they must be released with
+ * kernelCacheRelease when they are not needed anymore.
+ *
+ * When the memory budget is not enough to store all the requested rows, the pointer of
+ * the rows that could not be stored is NULL and the kernel function must be evaluated by the caller.
+ *
+ * @param cache The cache.
+ * @param dataset The dataset.
+ * @param indexes The indexes of the samples.
+ * @param n The number of samples.
+ * @param props The training parameters (kernel function).
+ * @param rows Array of n pointers where the rows are returned.
+ * @param buffers The buffers of the request, their size must be at least n.
+ */
+
+void kernelCacheRows(kernelCache *cache, svm_dataset dataset, int *indexes, int n, properties props, double **rows, kernelCacheBuffers *buffers){
+
+    int *missing = buffers->missing;
+    int *missingSlot = buffers->missingSlot;
+    double **missingRows = buffers->missingRows;
+    int *waiting = buffers->waiting;
+    int nMissing=0, nWaiting=0;
+    int k, slot;
+
+    pthread_mutex_lock(&cache->lock);
+
+    for(k=0;k<n;k++){
+        slot=cache->sampleSlot[indexes[k]];
+        if(slot != -1){
+            cache->hits++;
+            unlinkSlot(cache,slot);
+            linkSlotFront(cache,slot);
+            if(cache->pending[slot]==1) waiting[nWaiting++]=slot;
+        }else{
+            cache->misses++;
+            slot=freeSlot(cache);
+            if(slot != -1){
+                cache->slotSample[slot]=indexes[k];
+                cache->sampleSlot[indexes[k]]=slot;
+                cache->pending[slot]=1;
+                missing[nMissing]=indexes[k];
+                missingSlot[nMissing]=slot;
+                missingRows[nMissing]=cache->rows[slot];
+                nMissing++;
+            }
+        }
+
+        if(slot != -1){
+            cache->pinned[slot]++;
+            rows[k]=cache->rows[slot];
+        }else{
+            rows[k]=NULL;
+        }
+    }
+
+    pthread_mutex_unlock(&cache->lock);
+
+    // The new rows are calculated without the lock, they are pinned and pending so other threads
+    // can use the cache but they never read a row before it is ready.
+    if(cache->parent != NULL){
+        viewRows(cache,dataset,missing,nMissing,props,missingRows);
+    }else{
+        kernelBlock(dataset,missing,nMissing,NULL,cache->l,props,missingRows);
+    }
+
+    pthread_mutex_lock(&cache->lock);
+    for(k=0;k<nMissing;k++) cache->pending[missingSlot[k]]=0;
+    if(nMissing>0) pthread_cond_broadcast(&cache->ready);
+
+    // The rows that are being calculated by other threads, the thread sleeps until they are ready.
+    // The own rows are ready before waiting, so two requests never wait for each other.
+    for(k=0;k<nWaiting;k++){
+        while(cache->pending[waiting[k]]==1) pthread_cond_wait(&cache->ready,&cache->lock);
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * @brief It releases a set of rows of the kernel matrix.
+ *
+ * It unpins the rows that were obtained using kernelCacheRows so they can be replaced.
+ *
+ * @param cache The cache.
+ * @param indexes The indexes of the samples.
+ * @param rows The rows returned by kernelCacheRows (NULL rows are ignored).
+ * @param n The number of samples.
+ */
+
+void kernelCacheRelease(kernelCache *cache, int *indexes, double **rows, int n){
+
+    int k, slot;
+
+    pthread_mutex_lock(&cache->lock);
+    for(k=0;k<n;k++){
+        if(rows[k]==NULL) continue;
+        slot=cache->sampleSlot[indexes[k]];
+        if(slot != -1 && cache->pinned[slot]>0) cache->pinned[slot]--;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * @endcond
+ */
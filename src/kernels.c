@@ -34,14 +34,442 @@
  */
 
 #include "kernels.h"
+#include "simdKernels.h"
 #include "IOStructures.h"
+#include <omp.h>
+#include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * @cond
  */
 
+extern void dgemm_(char *transa, char *transb, int *m, int *n, int *k, double
+                   *alpha, double *a, int *lda, double *b, int *ldb, double *beta, double *c,
+                   int *ldc );
+
+/** @brief Number of samples of every side of the tiles used to calculate blocks of the kernel matrix. */
+#define KERNEL_TILE 256
+
+/**
+ * @brief Inner product of two sparse samples.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @return The inner product of both samples.
+ */
+
+static inline double sparseDot(svm_sample *x, svm_sample *y){
+
+    double sum = 0.0;
+
+    while(x->index != -1 && y->index != -1){
+        if(x->index == y->index){
+            sum += x->value * y->value;
+            ++x;
+            ++y;
+        }else{
+            if(x->index > y->index)
+                ++y;
+            else
+                ++x;
+        }
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Inner product of two sparse samples in single precision (accumulated in double precision).
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @return The inner product of both samples.
+ */
+
+static inline double sparseDotSingle(svm_sample_single *x, svm_sample_single *y){
+
+    double sum = 0.0;
+
+    while(x->index != -1 && y->index != -1){
+        if(x->index == y->index){
+            sum += ((double) x->value) * ((double) y->value);
+            ++x;
+            ++y;
+        }else{
+            if(x->index > y->index)
+                ++y;
+            else
+                ++x;
+        }
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Inner product of two sparse samples stored in CSR format.
+ *
+ * @param index1 The feature indexes of the first sample.
+ * @param value1 The feature values of the first sample.
+ * @param n1 The number of features of the first sample.
+ * @param index2 The feature indexes of the second sample.
+ * @param value2 The feature values of the second sample.
+ * @param n2 The number of features of the second sample.
+ * @return The inner product of both samples.
+ */
+
+static inline double sparseDotCSR(unsigned int *index1, double *value1, int n1, unsigned int *index2, double *value2, int n2){
+
+    double sum = 0.0;
+    int i=0, j=0;
+
+    while(i<n1 && j<n2){
+        if(index1[i] == index2[j]){
+            sum += value1[i] * value2[j];
+            ++i;
+            ++j;
+        }else{
+            if(index1[i] > index2[j])
+                ++j;
+            else
+                ++i;
+        }
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Linear kernel of two sparse samples.
+ */
+
+static double linearSparse(kernelEvaluator *evaluator, int index1, int index2){
+    return sparseDot(evaluator->x1[index1],evaluator->x2[index2]);
+}
+
+/**
+ * @brief Linear kernel of two dense samples.
+ */
+
+static double linearDense(kernelEvaluator *evaluator, int index1, int index2){
+    return denseDot(evaluator->x1[index1],evaluator->x2[index2],evaluator->dim);
+}
+
+/**
+ * @brief Squared distance of two sparse samples (using the norm of both samples).
+ */
+
+static double distanceSparse(kernelEvaluator *evaluator, int index1, int index2){
+    return evaluator->norms1[index1]+evaluator->norms2[index2]-2.0*sparseDot(evaluator->x1[index1],evaluator->x2[index2]);
+}
+
+/**
+ * @brief Squared distance of two dense samples.
+ */
+
+static double distanceDense(kernelEvaluator *evaluator, int index1, int index2){
+    return denseSquaredDistance(evaluator->x1[index1],evaluator->x2[index2],evaluator->dim);
+}
+
+/**
+ * @brief Radial Basis Function of two sparse samples.
+ */
+
+static double rbfSparse(kernelEvaluator *evaluator, int index1, int index2){
+    return exp(-(evaluator->gamma)*distanceSparse(evaluator,index1,index2));
+}
+
+/**
+ * @brief Radial Basis Function of two dense samples.
+ */
+
+static double rbfDense(kernelEvaluator *evaluator, int index1, int index2){
+    return exp(-(evaluator->gamma)*distanceDense(evaluator,index1,index2));
+}
+
+/**
+ * @brief Linear kernel of two sparse samples in single precision.
+ */
+
+static double linearSparseSingle(kernelEvaluator *evaluator, int index1, int index2){
+    return sparseDotSingle(evaluator->xs1[index1],evaluator->xs2[index2]);
+}
+
+/**
+ * @brief Linear kernel of two dense samples in single precision.
+ */
+
+static double linearDenseSingle(kernelEvaluator *evaluator, int index1, int index2){
+    return denseDotSingle(evaluator->xs1[index1],evaluator->xs2[index2],evaluator->dim);
+}
+
+/**
+ * @brief Squared distance of two sparse samples in single precision (using the norm of both samples).
+ */
+
+static double distanceSparseSingle(kernelEvaluator *evaluator, int index1, int index2){
+    return evaluator->norms1[index1]+evaluator->norms2[index2]-2.0*sparseDotSingle(evaluator->xs1[index1],evaluator->xs2[index2]);
+}
+
+/**
+ * @brief Squared distance of two dense samples in single precision.
+ */
+
+static double distanceDenseSingle(kernelEvaluator *evaluator, int index1, int index2){
+    return denseSquaredDistanceSingle(evaluator->xs1[index1],evaluator->xs2[index2],evaluator->dim);
+}
+
+/**
+ * @brief Radial Basis Function of two sparse samples in single precision.
+ */
+
+static double rbfSparseSingle(kernelEvaluator *evaluator, int index1, int index2){
+    return exp(-(evaluator->gamma)*distanceSparseSingle(evaluator,index1,index2));
+}
+
+/**
+ * @brief Radial Basis Function of two dense samples in single precision.
+ */
+
+static double rbfDenseSingle(kernelEvaluator *evaluator, int index1, int index2){
+    return exp(-(evaluator->gamma)*distanceDenseSingle(evaluator,index1,index2));
+}
+
+/**
+ * @brief Inner product of two sparse samples in CSR format.
+ */
+
+static double sparseDotRows(kernelEvaluator *evaluator, int index1, int index2){
+    int start1 = evaluator->rowPtr1[index1];
+    int start2 = evaluator->rowPtr2[index2];
+    return sparseDotCSR(&evaluator->indexes1[start1],&evaluator->values1[start1],evaluator->rowPtr1[index1+1]-start1,
+                        &evaluator->indexes2[start2],&evaluator->values2[start2],evaluator->rowPtr2[index2+1]-start2);
+}
+
+/**
+ * @brief Linear kernel of two sparse samples in CSR format.
+ */
+
+static double linearSparseCSR(kernelEvaluator *evaluator, int index1, int index2){
+    return sparseDotRows(evaluator,index1,index2);
+}
+
+/**
+ * @brief Linear kernel of two dense samples in CSR format.
+ */
+
+static double linearDenseCSR(kernelEvaluator *evaluator, int index1, int index2){
+    return arrayDot(&evaluator->values1[evaluator->rowPtr1[index1]],&evaluator->values2[evaluator->rowPtr2[index2]],evaluator->dim);
+}
+
+/**
+ * @brief Squared distance of two sparse samples in CSR format (using the norm of both samples).
+ */
+
+static double distanceSparseCSR(kernelEvaluator *evaluator, int index1, int index2){
+    return evaluator->norms1[index1]+evaluator->norms2[index2]-2.0*sparseDotRows(evaluator,index1,index2);
+}
+
+/**
+ * @brief Squared distance of two dense samples in CSR format.
+ */
+
+static double distanceDenseCSR(kernelEvaluator *evaluator, int index1, int index2){
+    return arraySquaredDistance(&evaluator->values1[evaluator->rowPtr1[index1]],&evaluator->values2[evaluator->rowPtr2[index2]],evaluator->dim);
+}
+
+/**
+ * @brief Radial Basis Function of two sparse samples in CSR format.
+ */
+
+static double rbfSparseCSR(kernelEvaluator *evaluator, int index1, int index2){
+    return exp(-(evaluator->gamma)*distanceSparseCSR(evaluator,index1,index2));
+}
+
+/**
+ * @brief Radial Basis Function of two dense samples in CSR format.
+ */
+
+static double rbfDenseCSR(kernelEvaluator *evaluator, int index1, int index2){
+    return exp(-(evaluator->gamma)*distanceDenseCSR(evaluator,index1,index2));
+}
+
+/**
+ * @brief Linear kernel of two samples of dense matrices.
+ */
+
+static double linearMatrix(kernelEvaluator *evaluator, int index1, int index2){
+    return arrayDot(&evaluator->matrix1[((size_t) index1)*evaluator->stride1],&evaluator->matrix2[((size_t) index2)*evaluator->stride2],evaluator->dim);
+}
+
+/**
+ * @brief Squared distance of two samples of dense matrices.
+ */
+
+static double distanceMatrix(kernelEvaluator *evaluator, int index1, int index2){
+    return arraySquaredDistance(&evaluator->matrix1[((size_t) index1)*evaluator->stride1],&evaluator->matrix2[((size_t) index2)*evaluator->stride2],evaluator->dim);
+}
+
+/**
+ * @brief Radial Basis Function of two samples of dense matrices.
+ */
+
+static double rbfMatrix(kernelEvaluator *evaluator, int index1, int index2){
+    return exp(-(evaluator->gamma)*distanceMatrix(evaluator,index1,index2));
+}
+
+/**
+ * @brief It binds the specialized functions of a kernel evaluator.
+ *
+ * @param evaluator The evaluator whose sets of samples have been assigned.
+ * @param kernelType The kernel function (linear=0, rbf=1).
+ * @param dense 1 if both sets of samples are dense with the same features.
+ * @param single 1 if both sets of samples are stored in single precision.
+ * @param csr 1 if both sets of samples are stored in CSR format.
+ * @param matrix 1 if both sets of samples are stored in dense matrices.
+ */
+
+static void bindKernelEvaluator(kernelEvaluator *evaluator, int kernelType, int dense, int single, int csr, int matrix){
+    if(matrix==1){
+        evaluator->kernel = (kernelType==0) ? linearMatrix : rbfMatrix;
+        evaluator->distance = (kernelType==0) ? NULL : distanceMatrix;
+    }else if(csr==1){
+        if(kernelType==0){
+            evaluator->kernel = dense ? linearDenseCSR : linearSparseCSR;
+            evaluator->distance = NULL;
+        }else{
+            evaluator->kernel = dense ? rbfDenseCSR : rbfSparseCSR;
+            evaluator->distance = dense ? distanceDenseCSR : distanceSparseCSR;
+        }
+    }else if(single==1){
+        if(kernelType==0){
+            evaluator->kernel = dense ? linearDenseSingle : linearSparseSingle;
+            evaluator->distance = NULL;
+        }else{
+            evaluator->kernel = dense ? rbfDenseSingle : rbfSparseSingle;
+            evaluator->distance = dense ? distanceDenseSingle : distanceSparseSingle;
+        }
+    }else{
+        if(kernelType==0){
+            evaluator->kernel = dense ? linearDense : linearSparse;
+            evaluator->distance = NULL;
+        }else{
+            evaluator->kernel = dense ? rbfDense : rbfSparse;
+            evaluator->distance = dense ? distanceDense : distanceSparse;
+        }
+    }
+}
+
+/**
+ * @brief Kernel evaluator of the samples of a training set.
+ *
+ * It creates a kernel evaluator of two samples of the same dataset. The kernel function and the
+ * representation of the dataset (sparse or dense) are resolved here once.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param props The list of properties to extract the kernel parameters.
+ * @return The kernel evaluator.
+ */
+
+kernelEvaluator trainEvaluator(svm_dataset dataset, properties props){
+    kernelEvaluator evaluator;
+    evaluator.kernelType = props.kernelType;
+    evaluator.gamma = props.Kgamma;
+    evaluator.dim = dataset.maxdim;
+    evaluator.x1 = dataset.x;
+    evaluator.norms1 = dataset.quadratic_value;
+    evaluator.x2 = dataset.x;
+    evaluator.norms2 = dataset.quadratic_value;
+    evaluator.xs1 = dataset.xs;
+    evaluator.xs2 = dataset.xs;
+    evaluator.rowPtr1 = dataset.rowPtr;
+    evaluator.indexes1 = dataset.indexes;
+    evaluator.values1 = dataset.values;
+    evaluator.rowPtr2 = dataset.rowPtr;
+    evaluator.indexes2 = dataset.indexes;
+    evaluator.values2 = dataset.values;
+    evaluator.matrix1 = dataset.matrix;
+    evaluator.stride1 = dataset.stride;
+    evaluator.matrix2 = dataset.matrix;
+    evaluator.stride2 = dataset.stride;
+    bindKernelEvaluator(&evaluator,props.kernelType,dataset.sparse==0,dataset.single,dataset.csr,dataset.dense);
+    return evaluator;
+}
+
+/**
+ * @brief Kernel evaluator of the samples of a dataset and the Support Vectors of a model.
+ *
+ * It creates a kernel evaluator of one sample of the dataset (first index) and one Support Vector
+ * of a trained model (second index). The dense functions are used when the dataset and the model
+ * are dense with the same features. Both must be stored with the same precision.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param mymodel The trained SVM model.
+ * @return The kernel evaluator.
+ */
+
+kernelEvaluator testEvaluator(svm_dataset dataset, model mymodel){
+    kernelEvaluator evaluator;
+    evaluator.kernelType = mymodel.kernelType;
+    evaluator.gamma = mymodel.Kgamma;
+    evaluator.dim = mymodel.maxdim;
+    evaluator.x1 = dataset.x;
+    evaluator.norms1 = dataset.quadratic_value;
+    evaluator.x2 = mymodel.x;
+    evaluator.norms2 = mymodel.quadratic_value;
+    evaluator.xs1 = dataset.xs;
+    evaluator.xs2 = mymodel.xs;
+    evaluator.rowPtr1 = dataset.rowPtr;
+    evaluator.indexes1 = dataset.indexes;
+    evaluator.values1 = dataset.values;
+    evaluator.rowPtr2 = mymodel.rowPtr;
+    evaluator.indexes2 = mymodel.indexes;
+    evaluator.values2 = mymodel.values;
+    evaluator.matrix1 = dataset.matrix;
+    evaluator.stride1 = dataset.stride;
+    evaluator.matrix2 = mymodel.matrix;
+    evaluator.stride2 = mymodel.stride;
+    if(dataset.single != mymodel.single){
+        fprintf(stderr, "The dataset and the model must be stored with the same precision\n");
+        exit(2);
+    }
+    if(dataset.csr != mymodel.csr || dataset.dense != mymodel.dense || (dataset.dense==1 && dataset.maxdim != mymodel.maxdim)){
+        fprintf(stderr, "The dataset and the model must be stored with the same layout\n");
+        exit(2);
+    }
+    bindKernelEvaluator(&evaluator,mymodel.kernelType,(dataset.sparse==0 && mymodel.sparse==0 && dataset.maxdim==mymodel.maxdim),dataset.single,dataset.csr,dataset.dense);
+    return evaluator;
+}
+
+/**
+ * @brief Kernel function of one sample of the first set and a list of samples of the second set.
+ *
+ * For the Radial Basis Function the distances are calculated first and the exponential
+ * is obtained for the whole row using expBatch.
+ *
+ * @param evaluator The kernel evaluator.
+ * @param index1 The index of the sample of the first set.
+ * @param indexes2 The indexes of the samples of the second set (NULL to use the samples 0,...,n2-1).
+ * @param n2 The number of samples of the second set.
+ * @param fastExp 0 to use the exp function of the math library, 1 to use the vectorized approximation.
+ * @param K Array of length n2 to store the result.
+ */
+
+void kernelEvaluatorRow(kernelEvaluator *evaluator, int index1, int *indexes2, int n2, int fastExp, double *K){
+
+    int j;
+
+    if (evaluator->kernelType==0){
+        for(j=0;j<n2;j++) K[j]=evaluator->kernel(evaluator,index1,indexes2 ? indexes2[j] : j);
+    }else{
+        for(j=0;j<n2;j++) K[j]=evaluator->distance(evaluator,index1,indexes2 ? indexes2[j] : j);
+        expBatch(K,n2,evaluator->gamma,fastExp);
+    }
+}
+
 /**
  * @brief Radial Basis Function of two elements of the dataset.
  *
@@ -50,7 +478,8 @@
  * It returns exp(-gamma||x1-x2||^2)
  * x1 and x2 are two elements of the dataset and gamma is a parameter whose value can be found
  * in the struct props.
- *  
+ *
+ * To evaluate many pairs of samples it is faster to create a kernel evaluator with trainEvaluator.
  *
  * @param dataset The strut that contains the dataset information.
  * @param index1 The index of the first element of the dataset.
@@ -59,126 +488,386 @@
  * @return The value of the Radial Basis Function of both elements.
  */
 
-
 double kernelFunction(svm_dataset dataset, int index1, int index2, properties props){
+    kernelEvaluator evaluator = trainEvaluator(dataset,props);
+    return kernelEvaluate(&evaluator,index1,index2);
+}
 
-    double sum = 0.0;   
+/**
+ * @brief Radial Basis Function of one element of the dataset and Support Vectro of a trained model.
+ *
+ * This method returns the RBF Kernel function of one element of the dataset and Support Vectro of a trained model.
+ * 
+ * It returns exp(-gamma||x1-x2||^2)
+ *
+ * x1 is an element of the dataset and x2 is a support vector of a trained model, gamma is a parameter whose value can be found
+ * in the struct props. 
+ *
+ * To evaluate many pairs of samples it is faster to create a kernel evaluator with testEvaluator.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param index1 The index of the sample of the dataset.
+ * @param mymodel The trained SVM model.
+ * @param index2 The index of one of the Support Vectors of the trained model.
+ * @return The value of the Radial Basis Function of both elements.
+ */
 
-    // Pointer to both elements.    
-    svm_sample *x=dataset.x[index1];
-    svm_sample *y=dataset.x[index2];
+double kernelTest(svm_dataset dataset, int index1, model mymodel, int index2){
+    kernelEvaluator evaluator = testEvaluator(dataset,mymodel);
+    return kernelEvaluate(&evaluator,index1,index2);
+}
 
-    if (props.kernelType==0){
+/**
+ * @brief It scatters a sample of a dataset into a dense array.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param index The index of the sample.
+ * @param result The array of length dim where the sample is scattered.
+ * @param dim The length of the array (the number of features plus one).
+ * @param clean 1 to write zeros in the positions of the features of the sample instead of their values.
+ */
 
-        while(x->index != -1 && y->index != -1){
-	    if(x->index == y->index){
-                sum += x->value * y->value;
-                ++x;
-                ++y;
-            }else{
-                if(x->index > y->index)
-                    ++y;
-                else
-                    ++x;
-                }			
-            }
+static inline void scatterSample(svm_dataset dataset, int index, double *result, int dim, int clean){
+    if(dataset.dense==1){
+        int k;
+        double *row = &dataset.matrix[((size_t) index)*dataset.stride];
+        for(k=1;k<=dataset.maxdim && k<dim;++k) result[k] = clean ? 0.0 : row[k-1];
+    }else if(dataset.csr==1){
+        int k;
+        for(k=dataset.rowPtr[index];k<dataset.rowPtr[index+1];++k) if(dataset.indexes[k] < (unsigned int) dim) result[dataset.indexes[k]] = clean ? 0.0 : dataset.values[k];
+    }else if(dataset.single==1){
+        svm_sample_single *x;
+        for(x=dataset.xs[index];x->index != -1;++x) if(x->index < dim) result[x->index] = clean ? 0.0 : (double) x->value;
+    }else{
+        svm_sample *x;
+        for(x=dataset.x[index];x->index != -1;++x) if(x->index < dim) result[x->index] = clean ? 0.0 : x->value;
+    }
+}
 
-	return sum;        
+/**
+ * @brief Inner product of a sample of a dataset and a dense array.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param index The index of the sample.
+ * @param scatter The dense array of length dim.
+ * @param dim The length of the array (the number of features plus one).
+ * @return The inner product, it only reads the positions of the features of the sample.
+ */
 
+static inline double gatherSample(svm_dataset dataset, int index, double *scatter, int dim){
+    double sum=0.0;
+    if(dataset.dense==1){
+        int k;
+        double *row = &dataset.matrix[((size_t) index)*dataset.stride];
+        for(k=1;k<=dataset.maxdim && k<dim;++k) sum += scatter[k]*row[k-1];
+    }else if(dataset.csr==1){
+        int k;
+        for(k=dataset.rowPtr[index];k<dataset.rowPtr[index+1];++k) if(dataset.indexes[k] < (unsigned int) dim) sum += scatter[dataset.indexes[k]]*dataset.values[k];
+    }else if(dataset.single==1){
+        svm_sample_single *x;
+        for(x=dataset.xs[index];x->index != -1;++x) if(x->index < dim) sum += scatter[x->index]*((double) x->value);
     }else{
-        // If the dataset is not sparse we iterate directly.
-        if (dataset.sparse==0){
-            int maxdim = dataset.maxdim;
-            int i;
-            for(i=0;i<maxdim;i++){
-	        sum+=pow((x->value) - (y->value),2);
-	        ++x;
-                ++y;
-            }
+        svm_sample *x;
+        for(x=dataset.x[index];x->index != -1;++x) if(x->index < dim) sum += scatter[x->index]*x->value;
+    }
+    return sum;
+}
+
+/**
+ * @brief It copies a sample of a dense dataset into an array.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param index The index of the sample.
+ * @param result The array of length dim to store the sample.
+ * @param dim The length of the array (the number of features plus one).
+ */
+
+static void denseSample(svm_dataset dataset, int index, double *result, int dim){
+    memset(result,0,dim*sizeof(double));
+    scatterSample(dataset,index,result,dim,0);
+}
+
+/**
+ * @brief Tile of the kernel matrix of a dense dataset.
+ *
+ * It calculates a tile of the kernel matrix of two lists of samples using dgemm.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param indexes1 The indexes of the first list of samples (NULL to use consecutive samples starting at o1).
+ * @param o1 The position of the tile in the first list.
+ * @param n1 The number of rows of the tile.
+ * @param indexes2 The indexes of the second list of samples (NULL to use consecutive samples starting at o2).
+ * @param o2 The position of the tile in the second list.
+ * @param n2 The number of columns of the tile.
+ * @param props The list of properties to extract the kernel parameters.
+ * @param X1 Auxiliar memory to store n1 samples.
+ * @param X2 Auxiliar memory to store n2 samples.
+ * @param C The result, the kernel function of the samples i and j is stored in C[i*n2+j].
+ */
 
+static void denseKernelTile(svm_dataset dataset, int *indexes1, int o1, int n1, int *indexes2, int o2, int n2, properties props, double *X1, double *X2, double *C){
+
+    int i, j, index1, index2;
+    int dim = dataset.maxdim+1;
+    char trans='T';
+    char notrans='N';
+    double alpha = (props.kernelType==0) ? 1.0 : -2.0;
+    double zero = 0.0;
+    double value;
+    double *A1 = X1, *A2 = X2;
+    int lda1 = dim, lda2 = dim, k = dim;
+
+    if(dataset.dense==1){
+        // Consecutive samples are read from the dense matrix, other lists of samples are packed without the feature 0.
+        k = dataset.maxdim;
+        if(indexes1==NULL){
+            A1 = &dataset.matrix[((size_t) o1)*dataset.stride];
+            lda1 = dataset.stride;
         }else{
+            lda1 = k;
+            for(i=0;i<n1;i++) memcpy(&X1[i*k],&dataset.matrix[((size_t) indexes1[o1+i])*dataset.stride],k*sizeof(double));
+        }
+        if(indexes2==NULL){
+            A2 = &dataset.matrix[((size_t) o2)*dataset.stride];
+            lda2 = dataset.stride;
+        }else{
+            lda2 = k;
+            for(j=0;j<n2;j++) memcpy(&X2[j*k],&dataset.matrix[((size_t) indexes2[o2+j])*dataset.stride],k*sizeof(double));
+        }
+    }else{
+        for(i=0;i<n1;i++) denseSample(dataset,indexes1 ? indexes1[o1+i] : o1+i,&X1[i*dim],dim);
+        for(j=0;j<n2;j++) denseSample(dataset,indexes2 ? indexes2[o2+j] : o2+j,&X2[j*dim],dim);
+    }
 
-            sum += (dataset.quadratic_value[index1])+(dataset.quadratic_value[index2]);
-            while(x->index !=-1 && y->index !=-1) {
-                if(x->index == y->index){
-                    sum += -2.0 * (x->value) * (y->value);
-                    ++x;
-                    ++y;
-                }else{
-                    if((x->index) < (y->index)){
-                        ++x;
-                    }else{
-                        ++y;
-                    }
-                }
+    dgemm_(&trans, &notrans, &n2, &n1, &k, &alpha, A2, &lda2, A1, &lda1, &zero, C, &n2);
+
+    if(props.kernelType != 0){
+        for(i=0;i<n1;i++){
+            index1 = indexes1 ? indexes1[o1+i] : o1+i;
+            for(j=0;j<n2;j++){
+                index2 = indexes2 ? indexes2[o2+j] : o2+j;
+                value = C[i*n2+j]+dataset.quadratic_value[index1]+dataset.quadratic_value[index2];
+                // Rounding errors may give small negative distances.
+                if(value<0.0) value=0.0;
+                C[i*n2+j]=value;
             }
         }
-        return exp(-(props.Kgamma)*sum);
+        expBatch(C,n1*n2,props.Kgamma,props.FastExp);
     }
 }
 
 /**
- * @brief Radial Basis Function of one element of the dataset and Support Vectro of a trained model.
- *
- * This method returns the RBF Kernel function of one element of the dataset and Support Vectro of a trained model.
- * 
- * It returns exp(-gamma||x1-x2||^2)
+ * @brief Tile of the kernel matrix of a sparse dataset.
  *
- * x1 is an element of the dataset and x2 is a support vector of a trained model, gamma is a parameter whose value can be found
- * in the struct props. 
+ * It calculates a tile of the kernel matrix of two lists of samples. Every sample of the first list is
+ * scattered once into a dense array and its inner products with the samples of the second list are
+ * obtained gathering their nonzero features. The array is cleaned before returning.
  *
  * @param dataset The strut that contains the dataset information.
- * @param index1 The index of the sample of the dataset.
- * @param mymodel The trained SVM model.
- * @param index2 The index of one of the Support Vectors of the trained model.
- * @return The value of the Radial Basis Function of both elements.
+ * @param indexes1 The indexes of the first list of samples (NULL to use consecutive samples starting at o1).
+ * @param o1 The position of the tile in the first list.
+ * @param n1 The number of rows of the tile.
+ * @param indexes2 The indexes of the second list of samples (NULL to use consecutive samples starting at o2).
+ * @param o2 The position of the tile in the second list.
+ * @param n2 The number of columns of the tile.
+ * @param props The list of properties to extract the kernel parameters.
+ * @param scatter Auxiliar array of zeros with length the number of features plus one.
+ * @param C The result, the kernel function of the samples i and j is stored in C[i*n2+j].
  */
 
-double kernelTest(svm_dataset dataset, int index1, model mymodel, int index2){
+static void sparseKernelTile(svm_dataset dataset, int *indexes1, int o1, int n1, int *indexes2, int o2, int n2, properties props, double *scatter, double *C){
 
-    double sum = 0.0;
+    int i, j, index1, index2;
+    int dim = dataset.maxdim+1;
+    double sum;
 
-    // Pointer to both elements.  
-    svm_sample *x=dataset.x[index1];
-    svm_sample *y=mymodel.x[index2];
-	
+    for(i=0;i<n1;i++){
+        index1 = indexes1 ? indexes1[o1+i] : o1+i;
 
-    if (mymodel.kernelType==0){
+        scatterSample(dataset,index1,scatter,dim,0);
 
-        while(x->index != -1 && y->index != -1){
-	    if(x->index == y->index){
-                sum += x->value * y->value;
-                ++x;
-                ++y;
+        for(j=0;j<n2;j++){
+            index2 = indexes2 ? indexes2[o2+j] : o2+j;
+            sum=gatherSample(dataset,index2,scatter,dim);
+
+            if(props.kernelType==0){
+                C[i*n2+j]=sum;
             }else{
-                if(x->index > y->index)
-                    ++y;
-                else
-                    ++x;
-                }			
+                sum = dataset.quadratic_value[index1]+dataset.quadratic_value[index2]-2.0*sum;
+                // Rounding errors may give small negative distances.
+                if(sum<0.0) sum=0.0;
+                C[i*n2+j]=sum;
             }
-	return sum;        
+        }
+
+        scatterSample(dataset,index1,scatter,dim,1);
+    }
+
+    if(props.kernelType != 0) expBatch(C,n1*n2,props.Kgamma,props.FastExp);
+}
+
+/**
+ * @brief Tile of the kernel matrix.
+ *
+ * It calculates a tile of the kernel matrix of two lists of samples.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param indexes1 The indexes of the first list of samples (NULL to use consecutive samples starting at o1).
+ * @param o1 The position of the tile in the first list.
+ * @param n1 The number of rows of the tile.
+ * @param indexes2 The indexes of the second list of samples (NULL to use consecutive samples starting at o2).
+ * @param o2 The position of the tile in the second list.
+ * @param n2 The number of columns of the tile.
+ * @param props The list of properties to extract the kernel parameters.
+ * @param X1 Auxiliar memory to store n1 samples (dense datasets) or to scatter one sample (sparse datasets).
+ * @param X2 Auxiliar memory to store n2 samples (only dense datasets).
+ * @param C The result, the kernel function of the samples i and j is stored in C[i*n2+j].
+ */
+
+static void kernelTile(svm_dataset dataset, int *indexes1, int o1, int n1, int *indexes2, int o2, int n2, properties props, double *X1, double *X2, double *C){
 
+    if(dataset.sparse==0){
+        denseKernelTile(dataset,indexes1,o1,n1,indexes2,o2,n2,props,X1,X2,C);
     }else{
-            sum += (dataset.quadratic_value[index1])+(mymodel.quadratic_value[index2]);
-            while(x->index !=-1 && y->index !=-1) {
-                if(x->index == y->index){
-                    sum += -2.0 * (x->value) * (y->value);
-                    ++x;
-                    ++y;
-                }else{
-                    if((x->index) < (y->index)){
-                        ++x;
-                    }else{
-                        ++y;
-						
-                    }
-                }
+        sparseKernelTile(dataset,indexes1,o1,n1,indexes2,o2,n2,props,X1,C);
+    }
+}
+
+/**
+ * @brief Block of the kernel matrix of two lists of samples of the dataset.
+ *
+ * It calculates the kernel function of every sample of the first list against every sample of the second list.
+ * The block is divided in tiles that are calculated in parallel.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param indexes1 The indexes of the first list of samples (NULL to use the samples 0,...,n1-1).
+ * @param n1 The number of samples of the first list.
+ * @param indexes2 The indexes of the second list of samples (NULL to use the samples 0,...,n2-1).
+ * @param n2 The number of samples of the second list.
+ * @param props The list of properties to extract the kernel parameters.
+ * @param K Array of n1 rows of length n2 to store the result, K[i][j] is the kernel function of the samples indexes1[i] and indexes2[j].
+ */
+
+void kernelBlock(svm_dataset dataset, int *indexes1, int n1, int *indexes2, int n2, properties props, double **K){
+
+    if(n1<=0 || n2<=0) return;
+
+    int tiles1 = (n1+KERNEL_TILE-1)/KERNEL_TILE;
+    int tiles2 = (n2+KERNEL_TILE-1)/KERNEL_TILE;
+    int dim = dataset.maxdim+1;
+    int t;
+
+    #pragma omp parallel default(shared) private(t)
+    {
+    // Dense datasets store tiles of samples, sparse datasets only need an array to scatter one sample.
+    double *X1 = (dataset.sparse==0) ? (double *) malloc(KERNEL_TILE*dim*sizeof(double)) : (double *) calloc(dim,sizeof(double));
+    double *X2 = (dataset.sparse==0) ? (double *) malloc(KERNEL_TILE*dim*sizeof(double)) : NULL;
+    double *C = (double *) malloc(KERNEL_TILE*KERNEL_TILE*sizeof(double));
+
+    #pragma omp for schedule(dynamic)
+    for(t=0;t<tiles1*tiles2;t++){
+        int o1 = (t/tiles2)*KERNEL_TILE;
+        int o2 = (t%tiles2)*KERNEL_TILE;
+        int s1 = (n1-o1<KERNEL_TILE) ? n1-o1 : KERNEL_TILE;
+        int s2 = (n2-o2<KERNEL_TILE) ? n2-o2 : KERNEL_TILE;
+        int i;
+        kernelTile(dataset,indexes1,o1,s1,indexes2,o2,s2,props,X1,X2,C);
+        for(i=0;i<s1;i++) memcpy(&K[o1+i][o2],&C[i*s2],s2*sizeof(double));
+    }
+
+    free(X1);
+    free(X2);
+    free(C);
+    }
+}
+
+/**
+ * @brief Product of a block of the kernel matrix and a vector.
+ *
+ * It adds to the vector y the product of the block of the kernel matrix of two lists of samples and the vector x:
+ *
+ * y[i] += sum_j K(indexes1[i],indexes2[j])*x[j]
+ *
+ * The block is never stored, it is calculated by tiles. When there are enough tiles of rows every thread
+ * owns a set of rows of the result, otherwise the partial products of every tile of columns are stored and
+ * added in order. In both cases the result does not depend on the number of threads.
+ *
+ * @param dataset The strut that contains the dataset information.
+ * @param indexes1 The indexes of the first list of samples (NULL to use the samples 0,...,n1-1).
+ * @param n1 The number of samples of the first list (length of y).
+ * @param indexes2 The indexes of the second list of samples (NULL to use the samples 0,...,n2-1).
+ * @param n2 The number of samples of the second list (length of x).
+ * @param props The list of properties to extract the kernel parameters.
+ * @param x The vector to multiply.
+ * @param y The vector where the result is accumulated.
+ */
+
+void kernelBlockProduct(svm_dataset dataset, int *indexes1, int n1, int *indexes2, int n2, properties props, double *x, double *y){
+
+    if(n1<=0 || n2<=0) return;
+
+    int tiles1 = (n1+KERNEL_TILE-1)/KERNEL_TILE;
+    int tiles2 = (n2+KERNEL_TILE-1)/KERNEL_TILE;
+    int dim = dataset.maxdim+1;
+    int byRows = (tiles1>=tiles2);
+    double *partial = NULL;
+    int t, i;
+
+    if(byRows==0) partial = (double *) calloc(tiles2*n1,sizeof(double));
 
+    #pragma omp parallel default(shared) private(t)
+    {
+    // Dense datasets store tiles of samples, sparse datasets only need an array to scatter one sample.
+    double *X1 = (dataset.sparse==0) ? (double *) malloc(KERNEL_TILE*dim*sizeof(double)) : (double *) calloc(dim,sizeof(double));
+    double *X2 = (dataset.sparse==0) ? (double *) malloc(KERNEL_TILE*dim*sizeof(double)) : NULL;
+    double *C = (double *) malloc(KERNEL_TILE*KERNEL_TILE*sizeof(double));
+    int t2, o1, o2, s1, s2, i, j;
+    double sum;
+
+    if(byRows==1){
+        #pragma omp for schedule(dynamic)
+        for(t=0;t<tiles1;t++){
+            o1 = t*KERNEL_TILE;
+            s1 = (n1-o1<KERNEL_TILE) ? n1-o1 : KERNEL_TILE;
+            for(t2=0;t2<tiles2;t2++){
+                o2 = t2*KERNEL_TILE;
+                s2 = (n2-o2<KERNEL_TILE) ? n2-o2 : KERNEL_TILE;
+                kernelTile(dataset,indexes1,o1,s1,indexes2,o2,s2,props,X1,X2,C);
+                for(i=0;i<s1;i++){
+                    sum=0.0;
+                    for(j=0;j<s2;j++) sum+=C[i*s2+j]*x[o2+j];
+                    y[o1+i]+=sum;
+                }
+            }
+        }
+    }else{
+        #pragma omp for schedule(dynamic)
+        for(t=0;t<tiles2;t++){
+            o2 = t*KERNEL_TILE;
+            s2 = (n2-o2<KERNEL_TILE) ? n2-o2 : KERNEL_TILE;
+            for(t2=0;t2<tiles1;t2++){
+                o1 = t2*KERNEL_TILE;
+                s1 = (n1-o1<KERNEL_TILE) ? n1-o1 : KERNEL_TILE;
+                kernelTile(dataset,indexes1,o1,s1,indexes2,o2,s2,props,X1,X2,C);
+                for(i=0;i<s1;i++){
+                    sum=0.0;
+                    for(j=0;j<s2;j++) sum+=C[i*s2+j]*x[o2+j];
+                    partial[t*n1+o1+i]=sum;
+                }
             }
+        }
+    }
 
+    free(X1);
+    free(X2);
+    free(C);
+    }
 
-        return exp(-(mymodel.Kgamma)*sum);
+    if(byRows==0){
+        for(t=0;t<tiles2;t++){
+            for(i=0;i<n1;i++) y[i]+=partial[t*n1+i];
+        }
+        free(partial);
     }
 }
 
@@ -0,0 +1,474 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @brief Implementation of the primal IRWLS solver of the linear SVM.
+ *
+ * See linear-train.h for a detailed description of its functions and parameters.
+ *
+ * @file linear-train.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ * @see linear-train.h
+ *
+ */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include "linear-train.h"
+#include "simdKernels.h"
+
+/**
+ * @cond
+ */
+
+/** @brief Maximum number of iterations of the primal IRWLS procedure. */
+#define LINEAR_MAX_ITERATIONS 1000
+
+/** @brief Maximum number of iterations of the conjugate gradient in every weighted least squares problem. */
+#define LINEAR_CG_ITERATIONS 200
+
+/** @brief Norm of the residual relative to the right hand side that stops the conjugate gradient. */
+#define LINEAR_CG_TOLERANCE 1e-4
+
+/** @brief Maximum number of times that the step is halved in the line search. */
+#define LINEAR_LINE_SEARCH 20
+
+/** @brief Regularization of the bias in the weighted least squares problem, the bias is not penalized in the SVM. */
+#define LINEAR_BIAS_RIDGE 1e-10
+
+int linearEngine(properties props){
+    return (props.kernelType==0 && props.Checkpoint==NULL && props.Resume==NULL);
+}
+
+/**
+ * @brief Dot product of a sample and the weights of the features.
+ *
+ * @param dataset The dataset.
+ * @param index The index of the sample.
+ * @param w The weight of every feature (the feature k is w[k-1]).
+ * @return The dot product.
+ */
+
+static double sampleDot(svm_dataset dataset, int index, double *w){
+    double sum=0.0;
+    if(dataset.dense==1){
+        sum=arrayDot(&dataset.matrix[((size_t) index)*dataset.stride],w,dataset.maxdim);
+    }else if(dataset.csr==1){
+        int k;
+        for(k=dataset.rowPtr[index];k<dataset.rowPtr[index+1];++k) sum+=dataset.values[k]*w[dataset.indexes[k]-1];
+    }else if(dataset.single==1){
+        svm_sample_single *sample;
+        for(sample=dataset.xs[index];sample->index != -1;++sample) sum+=sample->value*w[sample->index-1];
+    }else{
+        svm_sample *sample;
+        for(sample=dataset.x[index];sample->index != -1;++sample) sum+=sample->value*w[sample->index-1];
+    }
+    return sum;
+}
+
+/**
+ * @brief It adds a sample multiplied by a value to an array of features.
+ *
+ * @param dataset The dataset.
+ * @param index The index of the sample.
+ * @param alpha The value.
+ * @param squared If the squared features are added instead of the features.
+ * @param result The array where the sample is added (the feature k is result[k-1]).
+ */
+
+static void sampleAdd(svm_dataset dataset, int index, double alpha, int squared, double *result){
+    if(dataset.dense==1){
+        int k;
+        double *row=&dataset.matrix[((size_t) index)*dataset.stride];
+        if(squared==1) for(k=0;k<dataset.maxdim;++k) result[k]+=alpha*row[k]*row[k];
+        else for(k=0;k<dataset.maxdim;++k) result[k]+=alpha*row[k];
+    }else if(dataset.csr==1){
+        int k;
+        for(k=dataset.rowPtr[index];k<dataset.rowPtr[index+1];++k){
+            double value=dataset.values[k];
+            result[dataset.indexes[k]-1]+=(squared==1) ? alpha*value*value : alpha*value;
+        }
+    }else if(dataset.single==1){
+        svm_sample_single *sample;
+        for(sample=dataset.xs[index];sample->index != -1;++sample){
+            double value=sample->value;
+            result[sample->index-1]+=(squared==1) ? alpha*value*value : alpha*value;
+        }
+    }else{
+        svm_sample *sample;
+        for(sample=dataset.x[index];sample->index != -1;++sample){
+            result[sample->index-1]+=(squared==1) ? alpha*sample->value*sample->value : alpha*sample->value;
+        }
+    }
+}
+
+/**
+ * @brief Product of the samples and a vector of weights.
+ *
+ * It calculates result[i]=w*x[i]+b for the samples whose mask is distinct than zero (all of them if the mask is NULL).
+ *
+ * @param dataset The dataset.
+ * @param w The weights of the features and the bias in the last position.
+ * @param mask The samples to calculate (NULL for all the samples).
+ * @param result The result of every sample.
+ */
+
+static void samplesProduct(svm_dataset dataset, double *w, double *mask, double *result){
+    int i;
+    #pragma omp parallel for schedule(static) private(i)
+    for(i=0;i<dataset.l;i++){
+        if(mask==NULL || mask[i] != 0.0) result[i]=sampleDot(dataset,i,w)+w[dataset.maxdim];
+    }
+}
+
+/**
+ * @brief Transposed product of the samples and a vector.
+ *
+ * It calculates result=sum_i u[i]*x[i] (or sum_i u[i]*x[i]^2 with the squared features) and the sum of u in
+ * result[maxdim]. Every thread adds its samples in its own array and the arrays are added at the end.
+ *
+ * @param dataset The dataset.
+ * @param u The value of every sample, the samples with value zero are skipped.
+ * @param squared If the squared features are used.
+ * @param result The result (maxdim+1 elements).
+ * @param partial Array of nThreads*maxdim elements for the partial results of every thread.
+ * @param nThreads The number of threads.
+ */
+
+static void transposeProduct(svm_dataset dataset, double *u, int squared, double *result, double *partial, int nThreads){
+    int d=dataset.maxdim, i;
+    double sum=0.0;
+
+    for(i=0;i<dataset.l;i++) sum+=u[i];
+    result[d]=sum;
+
+    #pragma omp parallel num_threads(nThreads) private(i)
+    {
+        int t=omp_get_thread_num(), nt=omp_get_num_threads(), k;
+        double *own=(nt==1) ? result : &partial[((size_t) t)*d];
+        int start=(int) (((long long) dataset.l)*t/nt);
+        int end=(int) (((long long) dataset.l)*(t+1)/nt);
+
+        memset(own,0,d*sizeof(double));
+        for(i=start;i<end;i++) if(u[i] != 0.0) sampleAdd(dataset,i,u[i],squared,own);
+
+        if(nt>1){
+            #pragma omp barrier
+            #pragma omp for schedule(static)
+            for(k=0;k<d;k++){
+                int o;
+                double value=0.0;
+                for(o=0;o<nt;o++) value+=partial[((size_t) o)*d+k];
+                result[k]=value;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Product of the matrix of the weighted least squares problem and a vector.
+ *
+ * The matrix is [I+X'DX X'D1; 1'DX 1'D1] where D is the diagonal matrix of the weights a.
+ *
+ * @param dataset The dataset.
+ * @param a The weight of every sample.
+ * @param v The vector (maxdim+1 elements).
+ * @param product Array to store the product of every sample with v.
+ * @param result The result (maxdim+1 elements).
+ * @param partial Array of nThreads*maxdim elements for the partial results of every thread.
+ * @param nThreads The number of threads.
+ */
+
+static void leastSquaresProduct(svm_dataset dataset, double *a, double *v, double *product, double *result, double *partial, int nThreads){
+    int d=dataset.maxdim, i, k;
+
+    samplesProduct(dataset,v,a,product);
+    for(i=0;i<dataset.l;i++) product[i]=(a[i] != 0.0) ? a[i]*product[i] : 0.0;
+    transposeProduct(dataset,product,0,result,partial,nThreads);
+    for(k=0;k<d;k++) result[k]+=v[k];
+    result[d]+=LINEAR_BIAS_RIDGE*v[d];
+}
+
+/**
+ * @brief Cost function of the SVM.
+ *
+ * @param dataset The dataset.
+ * @param C The C parameter.
+ * @param norm The squared norm of the weights of the features.
+ * @param f The output of the classifier for every sample.
+ * @param g The change of the output of every sample in the direction of the line search (NULL if there is no direction).
+ * @param eta The step in the direction.
+ * @return 0.5*norm+C*sum_i max(0,1-y[i]*(f[i]+eta*g[i])).
+ */
+
+static double linearCost(svm_dataset dataset, double C, double norm, double *f, double *g, double eta){
+    int i;
+    double loss=0.0;
+    #pragma omp parallel for schedule(static) private(i) reduction(+:loss)
+    for(i=0;i<dataset.l;i++){
+        double margin=1.0-dataset.y[i]*((g==NULL) ? f[i] : f[i]+eta*g[i]);
+        if(margin>0.0) loss+=margin;
+    }
+    return 0.5*norm+C*loss;
+}
+
+double* trainLinear(svm_dataset dataset, properties props, double *init, int *deadline){
+
+    double trainingStart = omp_get_wtime();
+    int deadlineReached = 0;
+    if(props.verbose==1) printf("\nTraining a linear SVM in the primal space\n");
+
+    int d=dataset.maxdim, i, k, iter, cgIter, search;
+    int nThreads=(props.Threads>0) ? props.Threads : 1;
+
+    double *w = (double *) calloc(d+1,sizeof(double));
+    double *z = (double *) calloc(d+1,sizeof(double));
+    double *rhs = (double *) calloc(d+1,sizeof(double));
+    double *r = (double *) calloc(d+1,sizeof(double));
+    double *p = (double *) calloc(d+1,sizeof(double));
+    double *q = (double *) calloc(d+1,sizeof(double));
+    double *precond = (double *) calloc(d+1,sizeof(double));
+    double *f = (double *) calloc(dataset.l,sizeof(double));
+    double *g = (double *) calloc(dataset.l,sizeof(double));
+    double *a = (double *) calloc(dataset.l,sizeof(double));
+    double *u = (double *) calloc(dataset.l,sizeof(double));
+    double *partial = (double *) calloc(((size_t) nThreads)*d,sizeof(double));
+    if(w==NULL || z==NULL || rhs==NULL || r==NULL || p==NULL || q==NULL || precond==NULL || f==NULL || g==NULL || a==NULL || u==NULL || partial==NULL){
+        fprintf(stderr, "Error: There is not enough memory to train the linear SVM\n");
+        exit(2);
+    }
+
+    if(init != NULL) memcpy(w,init,(d+1)*sizeof(double));
+
+    // Output of the classifier and cost function of the initial weights
+    samplesProduct(dataset,w,NULL,f);
+    double norm=0.0;
+    for(k=0;k<d;k++) norm+=w[k]*w[k];
+    double cost=linearCost(dataset,props.C,norm,f,NULL,0.0);
+
+    for(iter=1;iter<=LINEAR_MAX_ITERATIONS;iter++){
+
+        ///////////////////////////////
+        // WEIGHTS OF THE SAMPLES
+        ///////////////////////////////
+
+        // The same weights as the dual solver: a[i]=C/(y[i]*e[i]) with e[i]=y[i]-f[i]
+        #pragma omp parallel for schedule(static) private(i)
+        for(i=0;i<dataset.l;i++){
+            double ye=1.0-dataset.y[i]*f[i];
+            if(ye<0.0) a[i]=0.0;
+            else if(ye<(1.0/10000)) a[i]=((double)props.C)*10000.0;
+            else a[i]=((double)props.C)/ye;
+            u[i]=a[i]*dataset.y[i];
+        }
+
+        ////////////////////////////////////////////
+        // WEIGHTED LEAST SQUARES (CONJUGATE GRADIENT)
+        ////////////////////////////////////////////
+
+        // Right hand side [X'Dy; 1'Dy] and Jacobi preconditioner
+        transposeProduct(dataset,u,0,rhs,partial,nThreads);
+        transposeProduct(dataset,a,1,precond,partial,nThreads);
+        for(k=0;k<d;k++) precond[k]+=1.0;
+        precond[d]+=LINEAR_BIAS_RIDGE;
+
+        // The conjugate gradient starts from the current weights
+        memcpy(z,w,(d+1)*sizeof(double));
+        leastSquaresProduct(dataset,a,z,u,q,partial,nThreads);
+        double rhsNorm=0.0, rz=0.0, residual=0.0;
+        for(k=0;k<=d;k++){
+            r[k]=rhs[k]-q[k];
+            p[k]=r[k]/precond[k];
+            rz+=r[k]*p[k];
+            rhsNorm+=rhs[k]*rhs[k];
+            residual+=r[k]*r[k];
+        }
+        rhsNorm=sqrt(rhsNorm);
+
+        for(cgIter=0;cgIter<LINEAR_CG_ITERATIONS && sqrt(residual)>LINEAR_CG_TOLERANCE*rhsNorm;cgIter++){
+            leastSquaresProduct(dataset,a,p,u,q,partial,nThreads);
+            double pq=0.0;
+            for(k=0;k<=d;k++) pq+=p[k]*q[k];
+            if(!(pq>0.0)) break;
+            double alpha=rz/pq, rzNew=0.0;
+            residual=0.0;
+            for(k=0;k<=d;k++){
+                z[k]+=alpha*p[k];
+                r[k]-=alpha*q[k];
+                residual+=r[k]*r[k];
+                rzNew+=r[k]*r[k]/precond[k];
+            }
+            double beta=rzNew/rz;
+            rz=rzNew;
+            for(k=0;k<=d;k++) p[k]=r[k]/precond[k]+beta*p[k];
+        }
+
+        ///////////////////////////////
+        // LINE SEARCH
+        ///////////////////////////////
+
+        // Direction z-w and change of the output of every sample in that direction
+        double ww=0.0, wz=0.0, zz=0.0, deltaW=0.0, normW=0.0;
+        for(k=0;k<=d;k++){
+            z[k]-=w[k];
+            deltaW+=z[k]*z[k];
+            normW+=w[k]*w[k];
+            if(k<d){
+                ww+=w[k]*w[k];
+                wz+=w[k]*z[k];
+                zz+=z[k]*z[k];
+            }
+        }
+        samplesProduct(dataset,z,NULL,g);
+
+        double eta=1.0, newCost=cost;
+        for(search=0;search<LINEAR_LINE_SEARCH;search++){
+            newCost=linearCost(dataset,props.C,ww+2.0*eta*wz+eta*eta*zz,f,g,eta);
+            if(newCost<cost) break;
+            eta*=0.5;
+        }
+
+        // The weights do not improve the cost function in the direction of the least squares solution
+        if(!(newCost<cost)) break;
+
+        for(k=0;k<=d;k++) w[k]+=eta*z[k];
+        for(i=0;i<dataset.l;i++) f[i]+=eta*g[i];
+        cost=newCost;
+
+        if(props.verbose==1) printf("%s", ".");
+        if(props.verbose==1) fflush(stdout);
+
+        // Stop criterion of the dual solver on the distance to the solution of the least squares problem,
+        // the weights are a fixed point of the procedure when they are the solution of their own problem.
+        if(deltaW/normW<props.Eta) break;
+
+        // Deadline: the training stops, the cost function never grows so the current weights are the best ones
+        if(props.Deadline>0.0 && omp_get_wtime()-trainingStart>=props.Deadline){
+            deadlineReached=1;
+            break;
+        }
+    }
+    if(iter>LINEAR_MAX_ITERATIONS) iter=LINEAR_MAX_ITERATIONS;
+
+    if(props.verbose==1) printf("\n");
+    if(props.verbose==1) printf("Iterations: %d\n",iter);
+    if(props.verbose==1) printf("Cost function: %f\n",cost);
+    if(props.verbose==1 && deadlineReached==1) printf("The deadline has been reached\n");
+    if(deadline != NULL) *deadline=deadlineReached;
+
+    free(z);
+    free(rhs);
+    free(r);
+    free(p);
+    free(q);
+    free(precond);
+    free(f);
+    free(g);
+    free(a);
+    free(u);
+    free(partial);
+
+    return w;
+}
+
+double* initialLinearWeights(svm_dataset dataset, model *mymodel, properties props){
+    double *init = (double *) calloc(dataset.maxdim+1,sizeof(double));
+    int i;
+
+    if(mymodel->kernelType != 0){
+        fprintf(stderr, "The initial model must use the linear kernel\n");
+        exit(2);
+    }
+
+    for(i=0;i<mymodel->nSVs;i++){
+        svm_sample *sample;
+        for(sample=mymodel->x[i];sample->index != -1;++sample){
+            if(sample->index>=1 && sample->index<=dataset.maxdim) init[sample->index-1]+=mymodel->weights[i]*sample->value;
+        }
+    }
+    init[dataset.maxdim]=mymodel->bias;
+
+    if(props.verbose==1) printf("Initial model: weights of the features obtained from %d support vectors\n",mymodel->nSVs);
+
+    return init;
+}
+
+model calculateLinearModel(properties props, svm_dataset dataset, double *w){
+    model classifier;
+    classifier.Kgamma = props.Kgamma;
+    classifier.bias = w[dataset.maxdim];
+    classifier.sparse = dataset.sparse;
+    classifier.maxdim = dataset.maxdim;
+    classifier.kernelType = 0;
+
+    classifier.single = 0;
+    classifier.xs = NULL;
+    classifier.featuresSingle = NULL;
+    classifier.csr = 0;
+    classifier.rowPtr = NULL;
+    classifier.indexes = NULL;
+    classifier.values = NULL;
+    classifier.dense = 0;
+    classifier.matrix = NULL;
+    classifier.stride = 0;
+
+    int k, nElem=0;
+    double norm=0.0;
+    for(k=0;k<dataset.maxdim;k++){
+        if(w[k] != 0.0){
+            nElem++;
+            norm+=w[k]*w[k];
+        }
+    }
+
+    classifier.nSVs = 1;
+    classifier.deadline = 0;
+    classifier.nElem = nElem+1;
+    classifier.weights = (double *) calloc(1,sizeof(double));
+    classifier.quadratic_value = (double *) calloc(1,sizeof(double));
+    classifier.x = (svm_sample **) calloc(1,sizeof(svm_sample *));
+    classifier.features = (svm_sample *) calloc(nElem+1,sizeof(svm_sample));
+
+    classifier.weights[0]=1.0;
+    classifier.quadratic_value[0]=norm;
+    classifier.x[0]=classifier.features;
+    nElem=0;
+    for(k=0;k<dataset.maxdim;k++){
+        if(w[k] != 0.0){
+            classifier.features[nElem].index=k+1;
+            classifier.features[nElem].value=w[k];
+            nElem++;
+        }
+    }
+    classifier.features[nElem].index=-1;
+
+    return classifier;
+}
+
+/**
+ * @endcond
+ */
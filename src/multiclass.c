@@ -0,0 +1,252 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+/**
+ * @brief Implementation of the training of problems with more than two classes.
+ *
+ * It implements the interface defined by multiclass.h. See multiclass.h for a detailed description of its functions.
+ *
+ * @file multiclass.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ *
+ * @see multiclass.h
+ */
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ParallelAlgorithms.h"
+#include "full-train.h"
+#include "budgeted-train.h"
+#include "linear-train.h"
+#include "kernelCache.h"
+#include "simdKernels.h"
+#include "jobQueue.h"
+#include "multiclass.h"
+
+/**
+ * @cond
+ */
+
+/** @brief Binary problems with at least this number of samples are trained one at a time using all the threads. */
+#define MULTICLASS_SHARED_SAMPLES 20000
+
+/**
+ * @brief It compares two labels.
+ */
+
+static int compareLabels(const void *a, const void *b){
+    double la=*((const double *) a), lb=*((const double *) b);
+    if(la<lb) return -1;
+    if(la>lb) return 1;
+    return 0;
+}
+
+int datasetClasses(svm_dataset dataset, double **labels){
+    int i, n=0;
+    double *sorted = (double *) malloc((dataset.l>0 ? dataset.l : 1)*sizeof(double));
+    memcpy(sorted,dataset.y,dataset.l*sizeof(double));
+    qsort(sorted,dataset.l,sizeof(double),compareLabels);
+    for(i=0;i<dataset.l;i++){
+        if(n==0 || sorted[i] != sorted[n-1]) sorted[n++]=sorted[i];
+    }
+    *labels = (double *) realloc(sorted,(n>0 ? n : 1)*sizeof(double));
+    return n;
+}
+
+multiclassModel trainMulticlass(svm_dataset dataset, double *labels, int nClasses, properties props, int budgeted){
+    multiclassModel mymodel;
+    int i, j, k;
+
+    mymodel.nClasses = nClasses;
+    mymodel.labels = (double *) malloc(nClasses*sizeof(double));
+    memcpy(mymodel.labels,labels,nClasses*sizeof(double));
+    // With two classes both decompositions have a single binary problem
+    mymodel.strategy = (nClasses==2) ? 0 : props.Multiclass;
+    mymodel.nModels = (mymodel.strategy==0) ? nClasses*(nClasses-1)/2 : nClasses;
+    mymodel.positive = (int *) malloc(mymodel.nModels*sizeof(int));
+    mymodel.negative = (int *) malloc(mymodel.nModels*sizeof(int));
+
+    // The problems of a class are consecutive, so the workers use the kernel rows of the same samples
+    k=0;
+    for (i=0;i<nClasses;i++){
+        if(mymodel.strategy==0){
+            for (j=i+1;j<nClasses;j++){
+                mymodel.positive[k]=i;
+                mymodel.negative[k]=j;
+                k++;
+            }
+        }else{
+            mymodel.positive[k]=i;
+            mymodel.negative[k]=-1;
+            k++;
+        }
+    }
+
+    int *classOf = (int *) malloc(dataset.l*sizeof(int));
+    int *count = (int *) calloc(nClasses,sizeof(int));
+    for (i=0;i<dataset.l;i++){
+        double *label = (double *) bsearch(&dataset.y[i],labels,nClasses,sizeof(double),compareLabels);
+        classOf[i] = (int) (label-labels);
+        count[classOf[i]]++;
+    }
+
+    int largest=0;
+    for (k=0;k<mymodel.nModels;k++){
+        int n = (mymodel.negative[k]==-1) ? dataset.l : count[mymodel.positive[k]]+count[mymodel.negative[k]];
+        if(n>largest) largest=n;
+    }
+
+    // Many single-threaded binary problems or one multi-threaded binary problem at a time
+    int nWorkers=1, jobThreads=props.Threads;
+    if(props.Threads>1 && largest<MULTICLASS_SHARED_SAMPLES && mymodel.nModels>=props.Threads){
+        nWorkers=props.Threads;
+        jobThreads=1;
+    }
+
+    properties jobProps = props;
+    jobProps.Threads = jobThreads;
+    jobProps.verbose = 0;
+    int linear = (budgeted==0 && linearEngine(props)==1);
+
+    // The one-vs-one problems read the rows of the cache of the whole training set through their own views,
+    // half of the budget is used by the shared cache and the other half by the views of the workers.
+    // The one-vs-rest problems contain every sample, so they use the shared cache directly.
+    kernelCache *shared = NULL;
+    double viewSize = 0.0;
+    if(budgeted==0 && linear==0){
+        if(mymodel.strategy==0){
+            shared = initKernelCache(dataset.l,props.CacheSize/2.0);
+            viewSize = props.CacheSize/(2.0*nWorkers);
+        }else{
+            shared = initKernelCache(dataset.l,props.CacheSize);
+        }
+    }
+
+    // Single-threaded problems solve the linear systems with LAPACK and they do not need the temporal memory
+    int memorySize=1;
+    if(jobThreads>1) memorySize = (budgeted==1) ? props.size : props.MaxSize+1;
+
+    if(props.verbose==1){
+        printf("Training %d binary problems (%s) of %d classes on %d workers of %d threads\n\n",mymodel.nModels,(mymodel.strategy==0) ? "one-vs-one" : "one-vs-rest",nClasses,nWorkers,jobThreads);
+    }
+
+    model *models = (model *) malloc(mymodel.nModels*sizeof(model));
+    jobQueue *queues = initJobQueues(mymodel.nModels,nWorkers);
+    double start = omp_get_wtime();
+
+    // The kernel functions are selected before the workers start
+    simdInstructionSet();
+    // The parallel regions inside a single-threaded problem run on its own thread
+    omp_set_max_active_levels(1);
+
+    #pragma omp parallel num_threads(nWorkers)
+    {
+        int worker=omp_get_thread_num();
+        int job, n, s;
+        int *indexes = (int *) malloc(dataset.l*sizeof(int));
+        solverContext *context = (linear==1) ? NULL : initSolverContext(jobThreads,memorySize);
+
+        while((job=nextJob(queues,nWorkers,worker))>=0){
+            int positive=mymodel.positive[job], negative=mymodel.negative[job];
+            double jobStart=omp_get_wtime();
+
+            // The samples of the binary problem labeled +1 and -1
+            n=0;
+            for (s=0;s<dataset.l;s++){
+                if(negative==-1 || classOf[s]==positive || classOf[s]==negative) indexes[n++]=s;
+            }
+            svm_dataset subset = subsetDataset(dataset,indexes,n);
+            for (s=0;s<n;s++) subset.y[s] = (classOf[indexes[s]]==positive) ? 1.0 : -1.0;
+            subsetClassAverages(&subset);
+
+            // The deadline is shared by all the binary problems
+            properties problemProps = jobProps;
+            if(props.Deadline>0.0){
+                problemProps.Deadline = props.Deadline-(jobStart-start);
+                if(problemProps.Deadline<=0.0) problemProps.Deadline=1e-9;
+            }
+
+            int deadline=0;
+            double *W;
+            if(budgeted==1){
+                int *centroids = (props.algorithm==0) ? randomCentroids(subset,problemProps) : SGMA(subset,problemProps);
+                // The selection of the centroids is part of the training time
+                if(props.Deadline>0.0){
+                    problemProps.Deadline = props.Deadline-(omp_get_wtime()-start);
+                    if(problemProps.Deadline<=0.0) problemProps.Deadline=1e-9;
+                }
+                W = IRWLSpar(subset,centroids,problemProps,NULL,&deadline,context);
+                models[job] = calculateBudgetedModel(problemProps,subset,centroids,W);
+                free(centroids);
+            }else if(linear==1){
+                W = trainLinear(subset,problemProps,NULL,&deadline);
+                models[job] = calculateLinearModel(problemProps,subset,W);
+            }else{
+                kernelCache *cache = (mymodel.strategy==0) ? initKernelCacheView(shared,dataset,indexes,n,viewSize) : shared;
+                W = trainFULLWarm(subset,problemProps,NULL,NULL,NULL,cache,&deadline,context);
+                if(mymodel.strategy==0) freeKernelCache(cache);
+                models[job] = calculateFULLModel(problemProps,subset,W);
+            }
+            models[job].deadline = deadline;
+            free(W);
+            freeDataset(subset);
+
+            if(props.verbose==1){
+                #pragma omp critical
+                {
+                    if(negative==-1) printf("Class %g vs rest",labels[positive]);
+                    else printf("Classes %g vs %g",labels[positive],labels[negative]);
+                    printf(": %d samples, %d support vectors in %.3f seconds\n",n,models[job].nSVs,omp_get_wtime()-jobStart);
+                    fflush(stdout);
+                }
+            }
+        }
+
+        if(context != NULL) freeSolverContext(context);
+        free(indexes);
+    }
+
+    mergeModels(&mymodel,models);
+
+    if(props.verbose==1){
+        printf("\n%d binary classifiers with %d support vectors, %d of them distinct\n",mymodel.nModels,mymodel.start[mymodel.nModels],mymodel.svs.nSVs);
+        if(shared != NULL){
+            printf("Shared kernel cache: %d rows of %d, %lld hits, %lld misses (hit rate %.2f%%)\n",shared->nSlots,shared->capacity,shared->hits,shared->misses,100.0*shared->hits/(shared->hits+shared->misses));
+        }
+    }
+
+    for (k=0;k<mymodel.nModels;k++) freeModel(models[k]);
+    free(models);
+    freeJobQueues(queues,nWorkers);
+    freeKernelCache(shared);
+    free(classOf);
+    free(count);
+    return mymodel;
+}
+
+/**
+ * @endcond
+ */
@@ -0,0 +1,674 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+
+/**
+ * @brief Implementation of the vectorized operations on dense samples.
+ *
+ * It implements the interface defined by simdKernels.h. See simdKernels.h for a detailed description of its functions.
+ *
+ * Every feature is stored in a svm_sample struct (the index followed by the value), so the values of
+ * two consecutive features are 16 bytes apart. Every version loads several features and keeps the
+ * values with an unpack instruction before the arithmetic operations.
+ *
+ * The fast exponential reduces the argument as x = k*ln(2) + r with |r| <= ln(2)/2, evaluates the
+ * Taylor polynomial of degree 7 of exp(r) (truncation error below 5e-9) and multiplies it by 2^k.
+ *
+ * @file simdKernels.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ *
+ * @see simdKernels.h
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "simdKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @cond
+ */
+
+/** @brief Smallest argument of the fast exponential (its result is still a normal number). */
+#define EXP_MIN -708.0
+
+/** @brief Largest argument of the fast exponential. */
+#define EXP_MAX 709.0
+
+/** @brief log2(e) */
+#define EXP_LOG2E 1.4426950408889634074
+
+/** @brief High part of ln(2) (its product by any integer k with |k|<2048 is exact). */
+#define EXP_LN2_HI 6.93147180369123816490e-01
+
+/** @brief Low part of ln(2). */
+#define EXP_LN2_LO 1.90821492927058770002e-10
+
+/**
+ * @brief Scalar fast exponential exp(-gamma*v) of an array (reference version).
+ */
+
+static void expFastScalar(double *values, int n, double gamma){
+    double x, k, r, p;
+    union {double d; long long i;} scale;
+    int i;
+    for(i=0;i<n;i++){
+        x = -gamma*values[i];
+        if(x<EXP_MIN) x=EXP_MIN;
+        if(x>EXP_MAX) x=EXP_MAX;
+        k = floor(x*EXP_LOG2E+0.5);
+        r = (x-k*EXP_LN2_HI)-k*EXP_LN2_LO;
+        p = 1.0+r*(1.0+r*(1.0/2+r*(1.0/6+r*(1.0/24+r*(1.0/120+r*(1.0/720+r*(1.0/5040)))))));
+        scale.i = ((long long) k+1023) << 52;
+        values[i] = p*scale.d;
+    }
+}
+
+/**
+ * @brief Scalar inner product of two dense samples (reference version).
+ */
+
+static double dotScalar(svm_sample *x, svm_sample *y, int n){
+    double sum=0.0;
+    int i;
+    for(i=0;i<n;i++) sum += x[i].value*y[i].value;
+    return sum;
+}
+
+/**
+ * @brief Scalar squared distance of two dense samples (reference version).
+ */
+
+static double distanceScalar(svm_sample *x, svm_sample *y, int n){
+    double sum=0.0, d;
+    int i;
+    for(i=0;i<n;i++){
+        d = x[i].value-y[i].value;
+        sum += d*d;
+    }
+    return sum;
+}
+
+/**
+ * @brief Scalar inner product of two dense samples in single precision (reference version).
+ */
+
+static double dotSingleScalar(svm_sample_single *x, svm_sample_single *y, int n){
+    double sum=0.0;
+    int i;
+    for(i=0;i<n;i++) sum += ((double) x[i].value)*((double) y[i].value);
+    return sum;
+}
+
+/**
+ * @brief Scalar squared distance of two dense samples in single precision (reference version).
+ */
+
+static double distanceSingleScalar(svm_sample_single *x, svm_sample_single *y, int n){
+    double sum=0.0, d;
+    int i;
+    for(i=0;i<n;i++){
+        d = ((double) x[i].value)-((double) y[i].value);
+        sum += d*d;
+    }
+    return sum;
+}
+
+/**
+ * @brief Scalar inner product of two arrays (reference version).
+ */
+
+static double arrayDotScalar(double *x, double *y, int n){
+    double sum=0.0;
+    int i;
+    for(i=0;i<n;i++) sum += x[i]*y[i];
+    return sum;
+}
+
+/**
+ * @brief Scalar squared distance of two arrays (reference version).
+ */
+
+static double arrayDistanceScalar(double *x, double *y, int n){
+    double sum=0.0, d;
+    int i;
+    for(i=0;i<n;i++){
+        d = x[i]-y[i];
+        sum += d*d;
+    }
+    return sum;
+}
+
+#ifdef SIMD_X86
+
+/**
+ * @brief SSE2 inner product of two dense samples.
+ */
+
+__attribute__((target("sse2")))
+static double dotSSE2(svm_sample *x, svm_sample *y, int n){
+    const double *a = (const double *) x;
+    const double *b = (const double *) y;
+    __m128d acc = _mm_setzero_pd();
+    double result[2];
+    int i;
+    for(i=0;i+2<=n;i+=2){
+        __m128d xv = _mm_unpackhi_pd(_mm_loadu_pd(a+2*i),_mm_loadu_pd(a+2*i+2));
+        __m128d yv = _mm_unpackhi_pd(_mm_loadu_pd(b+2*i),_mm_loadu_pd(b+2*i+2));
+        acc = _mm_add_pd(acc,_mm_mul_pd(xv,yv));
+    }
+    _mm_storeu_pd(result,acc);
+    return result[0]+result[1]+dotScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief SSE2 squared distance of two dense samples.
+ */
+
+__attribute__((target("sse2")))
+static double distanceSSE2(svm_sample *x, svm_sample *y, int n){
+    const double *a = (const double *) x;
+    const double *b = (const double *) y;
+    __m128d acc = _mm_setzero_pd();
+    double result[2];
+    int i;
+    for(i=0;i+2<=n;i+=2){
+        __m128d xv = _mm_unpackhi_pd(_mm_loadu_pd(a+2*i),_mm_loadu_pd(a+2*i+2));
+        __m128d yv = _mm_unpackhi_pd(_mm_loadu_pd(b+2*i),_mm_loadu_pd(b+2*i+2));
+        __m128d d = _mm_sub_pd(xv,yv);
+        acc = _mm_add_pd(acc,_mm_mul_pd(d,d));
+    }
+    _mm_storeu_pd(result,acc);
+    return result[0]+result[1]+distanceScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX2 inner product of two dense samples.
+ */
+
+__attribute__((target("avx2,fma")))
+static double dotAVX2(svm_sample *x, svm_sample *y, int n){
+    const double *a = (const double *) x;
+    const double *b = (const double *) y;
+    __m256d acc = _mm256_setzero_pd();
+    double result[4];
+    int i;
+    for(i=0;i+4<=n;i+=4){
+        __m256d xv = _mm256_unpackhi_pd(_mm256_loadu_pd(a+2*i),_mm256_loadu_pd(a+2*i+4));
+        __m256d yv = _mm256_unpackhi_pd(_mm256_loadu_pd(b+2*i),_mm256_loadu_pd(b+2*i+4));
+        acc = _mm256_fmadd_pd(xv,yv,acc);
+    }
+    _mm256_storeu_pd(result,acc);
+    return (result[0]+result[1])+(result[2]+result[3])+dotScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX2 squared distance of two dense samples.
+ */
+
+__attribute__((target("avx2,fma")))
+static double distanceAVX2(svm_sample *x, svm_sample *y, int n){
+    const double *a = (const double *) x;
+    const double *b = (const double *) y;
+    __m256d acc = _mm256_setzero_pd();
+    double result[4];
+    int i;
+    for(i=0;i+4<=n;i+=4){
+        __m256d xv = _mm256_unpackhi_pd(_mm256_loadu_pd(a+2*i),_mm256_loadu_pd(a+2*i+4));
+        __m256d yv = _mm256_unpackhi_pd(_mm256_loadu_pd(b+2*i),_mm256_loadu_pd(b+2*i+4));
+        __m256d d = _mm256_sub_pd(xv,yv);
+        acc = _mm256_fmadd_pd(d,d,acc);
+    }
+    _mm256_storeu_pd(result,acc);
+    return (result[0]+result[1])+(result[2]+result[3])+distanceScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX-512 inner product of two dense samples.
+ */
+
+__attribute__((target("avx512f")))
+static double dotAVX512(svm_sample *x, svm_sample *y, int n){
+    const double *a = (const double *) x;
+    const double *b = (const double *) y;
+    __m512d acc = _mm512_setzero_pd();
+    int i;
+    for(i=0;i+8<=n;i+=8){
+        __m512d xv = _mm512_unpackhi_pd(_mm512_loadu_pd(a+2*i),_mm512_loadu_pd(a+2*i+8));
+        __m512d yv = _mm512_unpackhi_pd(_mm512_loadu_pd(b+2*i),_mm512_loadu_pd(b+2*i+8));
+        acc = _mm512_fmadd_pd(xv,yv,acc);
+    }
+    return _mm512_reduce_add_pd(acc)+dotScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX-512 squared distance of two dense samples.
+ */
+
+__attribute__((target("avx512f")))
+static double distanceAVX512(svm_sample *x, svm_sample *y, int n){
+    const double *a = (const double *) x;
+    const double *b = (const double *) y;
+    __m512d acc = _mm512_setzero_pd();
+    int i;
+    for(i=0;i+8<=n;i+=8){
+        __m512d xv = _mm512_unpackhi_pd(_mm512_loadu_pd(a+2*i),_mm512_loadu_pd(a+2*i+8));
+        __m512d yv = _mm512_unpackhi_pd(_mm512_loadu_pd(b+2*i),_mm512_loadu_pd(b+2*i+8));
+        __m512d d = _mm512_sub_pd(xv,yv);
+        acc = _mm512_fmadd_pd(d,d,acc);
+    }
+    return _mm512_reduce_add_pd(acc)+distanceScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX2 inner product of two arrays.
+ */
+
+__attribute__((target("avx2,fma")))
+static double arrayDotAVX2(double *x, double *y, int n){
+    __m256d acc = _mm256_setzero_pd();
+    double result[4];
+    int i;
+    for(i=0;i+4<=n;i+=4) acc = _mm256_fmadd_pd(_mm256_loadu_pd(x+i),_mm256_loadu_pd(y+i),acc);
+    _mm256_storeu_pd(result,acc);
+    return (result[0]+result[1])+(result[2]+result[3])+arrayDotScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX2 squared distance of two arrays.
+ */
+
+__attribute__((target("avx2,fma")))
+static double arrayDistanceAVX2(double *x, double *y, int n){
+    __m256d acc = _mm256_setzero_pd();
+    double result[4];
+    int i;
+    for(i=0;i+4<=n;i+=4){
+        __m256d d = _mm256_sub_pd(_mm256_loadu_pd(x+i),_mm256_loadu_pd(y+i));
+        acc = _mm256_fmadd_pd(d,d,acc);
+    }
+    _mm256_storeu_pd(result,acc);
+    return (result[0]+result[1])+(result[2]+result[3])+arrayDistanceScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX-512 inner product of two arrays.
+ */
+
+__attribute__((target("avx512f")))
+static double arrayDotAVX512(double *x, double *y, int n){
+    __m512d acc = _mm512_setzero_pd();
+    int i;
+    for(i=0;i+8<=n;i+=8) acc = _mm512_fmadd_pd(_mm512_loadu_pd(x+i),_mm512_loadu_pd(y+i),acc);
+    return _mm512_reduce_add_pd(acc)+arrayDotScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX-512 squared distance of two arrays.
+ */
+
+__attribute__((target("avx512f")))
+static double arrayDistanceAVX512(double *x, double *y, int n){
+    __m512d acc = _mm512_setzero_pd();
+    int i;
+    for(i=0;i+8<=n;i+=8){
+        __m512d d = _mm512_sub_pd(_mm512_loadu_pd(x+i),_mm512_loadu_pd(y+i));
+        acc = _mm512_fmadd_pd(d,d,acc);
+    }
+    return _mm512_reduce_add_pd(acc)+arrayDistanceScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief It loads the values of four consecutive features in single precision and converts them to double precision.
+ */
+
+__attribute__((target("avx2,fma")))
+static inline __m256d loadSingleAVX2(const float *values){
+    __m256 features = _mm256_loadu_ps(values);
+    __m128 v = _mm_shuffle_ps(_mm256_castps256_ps128(features),_mm256_extractf128_ps(features,1),_MM_SHUFFLE(3,1,3,1));
+    return _mm256_cvtps_pd(v);
+}
+
+/**
+ * @brief AVX2 inner product of two dense samples in single precision (accumulated in double precision).
+ */
+
+__attribute__((target("avx2,fma")))
+static double dotSingleAVX2(svm_sample_single *x, svm_sample_single *y, int n){
+    const float *a = (const float *) x;
+    const float *b = (const float *) y;
+    __m256d acc = _mm256_setzero_pd();
+    double result[4];
+    int i;
+    for(i=0;i+4<=n;i+=4) acc = _mm256_fmadd_pd(loadSingleAVX2(a+2*i),loadSingleAVX2(b+2*i),acc);
+    _mm256_storeu_pd(result,acc);
+    return (result[0]+result[1])+(result[2]+result[3])+dotSingleScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX2 squared distance of two dense samples in single precision (accumulated in double precision).
+ */
+
+__attribute__((target("avx2,fma")))
+static double distanceSingleAVX2(svm_sample_single *x, svm_sample_single *y, int n){
+    const float *a = (const float *) x;
+    const float *b = (const float *) y;
+    __m256d acc = _mm256_setzero_pd();
+    double result[4];
+    int i;
+    for(i=0;i+4<=n;i+=4){
+        __m256d d = _mm256_sub_pd(loadSingleAVX2(a+2*i),loadSingleAVX2(b+2*i));
+        acc = _mm256_fmadd_pd(d,d,acc);
+    }
+    _mm256_storeu_pd(result,acc);
+    return (result[0]+result[1])+(result[2]+result[3])+distanceSingleScalar(x+i,y+i,n-i);
+}
+
+/**
+ * @brief AVX2 fast exponential exp(-gamma*v) of an array.
+ */
+
+__attribute__((target("avx2,fma")))
+static void expFastAVX2(double *values, int n, double gamma){
+    const __m256d g = _mm256_set1_pd(-gamma);
+    const __m256d minimum = _mm256_set1_pd(EXP_MIN);
+    const __m256d maximum = _mm256_set1_pd(EXP_MAX);
+    const __m256d log2e = _mm256_set1_pd(EXP_LOG2E);
+    const __m256d ln2hi = _mm256_set1_pd(EXP_LN2_HI);
+    const __m256d ln2lo = _mm256_set1_pd(EXP_LN2_LO);
+    const __m128i bias = _mm_set1_epi32(1023);
+    int i;
+    for(i=0;i+4<=n;i+=4){
+        __m256d x = _mm256_mul_pd(_mm256_loadu_pd(values+i),g);
+        x = _mm256_min_pd(_mm256_max_pd(x,minimum),maximum);
+        __m256d k = _mm256_round_pd(_mm256_mul_pd(x,log2e),_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC);
+        __m256d r = _mm256_fnmadd_pd(k,ln2lo,_mm256_fnmadd_pd(k,ln2hi,x));
+        __m256d p = _mm256_set1_pd(1.0/5040);
+        p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(1.0/720));
+        p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(1.0/120));
+        p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(1.0/24));
+        p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(1.0/6));
+        p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(1.0/2));
+        p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(1.0));
+        p = _mm256_fmadd_pd(p,r,_mm256_set1_pd(1.0));
+        __m128i exponent = _mm_add_epi32(_mm256_cvtpd_epi32(k),bias);
+        __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepi32_epi64(exponent),52));
+        _mm256_storeu_pd(values+i,_mm256_mul_pd(p,scale));
+    }
+    expFastScalar(values+i,n-i,gamma);
+}
+
+/**
+ * @brief AVX-512 fast exponential exp(-gamma*v) of an array.
+ */
+
+__attribute__((target("avx512f")))
+static void expFastAVX512(double *values, int n, double gamma){
+    const __m512d g = _mm512_set1_pd(-gamma);
+    const __m512d minimum = _mm512_set1_pd(EXP_MIN);
+    const __m512d maximum = _mm512_set1_pd(EXP_MAX);
+    const __m512d log2e = _mm512_set1_pd(EXP_LOG2E);
+    const __m512d ln2hi = _mm512_set1_pd(EXP_LN2_HI);
+    const __m512d ln2lo = _mm512_set1_pd(EXP_LN2_LO);
+    int i;
+    for(i=0;i+8<=n;i+=8){
+        __m512d x = _mm512_mul_pd(_mm512_loadu_pd(values+i),g);
+        x = _mm512_min_pd(_mm512_max_pd(x,minimum),maximum);
+        __m512d k = _mm512_roundscale_pd(_mm512_mul_pd(x,log2e),_MM_FROUND_TO_NEAREST_INT|_MM_FROUND_NO_EXC);
+        __m512d r = _mm512_fnmadd_pd(k,ln2lo,_mm512_fnmadd_pd(k,ln2hi,x));
+        __m512d p = _mm512_set1_pd(1.0/5040);
+        p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(1.0/720));
+        p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(1.0/120));
+        p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(1.0/24));
+        p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(1.0/6));
+        p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(1.0/2));
+        p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(1.0));
+        p = _mm512_fmadd_pd(p,r,_mm512_set1_pd(1.0));
+        _mm512_storeu_pd(values+i,_mm512_scalef_pd(p,k));
+    }
+    expFastScalar(values+i,n-i,gamma);
+}
+
+#endif
+
+/** @brief Selected version of the inner product. */
+static double (*dotFunction)(svm_sample *, svm_sample *, int) = NULL;
+
+/** @brief Selected version of the squared distance. */
+static double (*distanceFunction)(svm_sample *, svm_sample *, int) = NULL;
+
+/** @brief Selected version of the inner product in single precision. */
+static double (*dotSingleFunction)(svm_sample_single *, svm_sample_single *, int) = NULL;
+
+/** @brief Selected version of the squared distance in single precision. */
+static double (*distanceSingleFunction)(svm_sample_single *, svm_sample_single *, int) = NULL;
+
+/** @brief Selected version of the inner product of two arrays. */
+static double (*arrayDotFunction)(double *, double *, int) = NULL;
+
+/** @brief Selected version of the squared distance of two arrays. */
+static double (*arrayDistanceFunction)(double *, double *, int) = NULL;
+
+/** @brief Selected version of the fast exponential. */
+static void (*expFunction)(double *, int, double) = NULL;
+
+/** @brief Name of the selected instruction set. */
+static const char *instructionSet = "scalar";
+
+/** @brief The selection runs once, the threads that call a function during the selection wait for it. */
+static pthread_once_t selection = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief It selects the best version of the operations for this processor.
+ *
+ * It is called through pthread_once, that also makes the selected functions visible to every thread.
+ */
+
+static void selectInstructionSet(void){
+
+    double (*dot)(svm_sample *, svm_sample *, int) = dotScalar;
+    double (*distance)(svm_sample *, svm_sample *, int) = distanceScalar;
+    double (*dotSingle)(svm_sample_single *, svm_sample_single *, int) = dotSingleScalar;
+    double (*distanceSingle)(svm_sample_single *, svm_sample_single *, int) = distanceSingleScalar;
+    double (*arrayDot)(double *, double *, int) = arrayDotScalar;
+    double (*arrayDistance)(double *, double *, int) = arrayDistanceScalar;
+    void (*fastExp)(double *, int, double) = expFastScalar;
+    const char *name = "scalar";
+
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    // The arrays of the CSR format and of the exponential do not depend on the layout of the structs.
+    if(__builtin_cpu_supports("avx512f")){
+        arrayDot = arrayDotAVX512;
+        arrayDistance = arrayDistanceAVX512;
+        fastExp = expFastAVX512;
+    }else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        arrayDot = arrayDotAVX2;
+        arrayDistance = arrayDistanceAVX2;
+        fastExp = expFastAVX2;
+    }
+    // The vectorized versions need the value of every feature in the second half of a 16 bytes struct.
+    if(sizeof(svm_sample)==2*sizeof(double) && offsetof(svm_sample,value)==sizeof(double)){
+        if(__builtin_cpu_supports("avx512f")){
+            dot = dotAVX512;
+            distance = distanceAVX512;
+            name = "AVX-512";
+        }else if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+            dot = dotAVX2;
+            distance = distanceAVX2;
+            name = "AVX2";
+        }else if(__builtin_cpu_supports("sse2")){
+            dot = dotSSE2;
+            distance = distanceSSE2;
+            name = "SSE2";
+        }
+    }
+    // The single precision versions need the value of every feature in the second half of a 8 bytes struct.
+    if(sizeof(svm_sample_single)==2*sizeof(float) && offsetof(svm_sample_single,value)==sizeof(float)){
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+            dotSingle = dotSingleAVX2;
+            distanceSingle = distanceSingleAVX2;
+        }
+    }
+#endif
+
+    instructionSet = name;
+    expFunction = fastExp;
+    arrayDistanceFunction = arrayDistance;
+    arrayDotFunction = arrayDot;
+    distanceSingleFunction = distanceSingle;
+    dotSingleFunction = dotSingle;
+    distanceFunction = distance;
+    dotFunction = dot;
+}
+
+/**
+ * @brief Inner product of two dense samples.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of x[i].value*y[i].value.
+ */
+
+double denseDot(svm_sample *x, svm_sample *y, int n){
+    pthread_once(&selection,selectInstructionSet);
+    return dotFunction(x,y,n);
+}
+
+/**
+ * @brief Squared euclidean distance of two dense samples.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of (x[i].value-y[i].value)^2.
+ */
+
+double denseSquaredDistance(svm_sample *x, svm_sample *y, int n){
+    pthread_once(&selection,selectInstructionSet);
+    return distanceFunction(x,y,n);
+}
+
+/**
+ * @brief Inner product of two dense samples in single precision.
+ *
+ * The products are accumulated in double precision.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of x[i].value*y[i].value.
+ */
+
+double denseDotSingle(svm_sample_single *x, svm_sample_single *y, int n){
+    pthread_once(&selection,selectInstructionSet);
+    return dotSingleFunction(x,y,n);
+}
+
+/**
+ * @brief Squared euclidean distance of two dense samples in single precision.
+ *
+ * The differences are calculated and accumulated in double precision.
+ *
+ * @param x The first feature of the first sample.
+ * @param y The first feature of the second sample.
+ * @param n The number of features of both samples.
+ * @return The sum of (x[i].value-y[i].value)^2.
+ */
+
+double denseSquaredDistanceSingle(svm_sample_single *x, svm_sample_single *y, int n){
+    pthread_once(&selection,selectInstructionSet);
+    return distanceSingleFunction(x,y,n);
+}
+
+/**
+ * @brief Inner product of two arrays.
+ *
+ * @param x The first array.
+ * @param y The second array.
+ * @param n The length of both arrays.
+ * @return The sum of x[i]*y[i].
+ */
+
+double arrayDot(double *x, double *y, int n){
+    pthread_once(&selection,selectInstructionSet);
+    return arrayDotFunction(x,y,n);
+}
+
+/**
+ * @brief Squared euclidean distance of two arrays.
+ *
+ * @param x The first array.
+ * @param y The second array.
+ * @param n The length of both arrays.
+ * @return The sum of (x[i]-y[i])^2.
+ */
+
+double arraySquaredDistance(double *x, double *y, int n){
+    pthread_once(&selection,selectInstructionSet);
+    return arrayDistanceFunction(x,y,n);
+}
+
+/**
+ * @brief Exponential of an array of distances.
+ *
+ * It replaces every value v of the array by exp(-gamma*v).
+ *
+ * @param values The array.
+ * @param n The length of the array.
+ * @param gamma The parameter of the exponential.
+ * @param fast 0 to use the exp function of the math library, 1 to use the vectorized approximation
+ * (relative error below 1e-7 for arguments greater than -708, smaller results are rounded up to exp(-708)).
+ */
+
+void expBatch(double *values, int n, double gamma, int fast){
+    int i;
+    if(fast==1){
+        pthread_once(&selection,selectInstructionSet);
+        expFunction(values,n,gamma);
+    }else{
+        for(i=0;i<n;i++) values[i]=exp(-gamma*values[i]);
+    }
+}
+
+/**
+ * @brief Instruction set used by the vectorized operations.
+ *
+ * @return The name of the instruction set selected in this processor.
+ */
+
+const char *simdInstructionSet(void){
+    pthread_once(&selection,selectInstructionSet);
+    return instructionSet;
+}
+
+/**
+ * @endcond
+ */
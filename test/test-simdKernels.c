@@ -0,0 +1,235 @@
+/*
+ ============================================================================
+ Author      : Roberto Diaz Morales
+ ============================================================================
+
+ Copyright (c) 2016 Roberto Díaz Morales
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+ (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+ publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+ subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ ============================================================================
+ */
+
+
+/**
+ * @brief Correctness test of the vectorized operations on dense samples.
+ *
+ * It compares every vectorized version of simdKernels.c with its scalar reference for every length
+ * from 0 to TEST_LENGTH and for arrays that start at different offsets of an aligned buffer. The
+ * versions that the processor does not support are skipped. It returns 0 if every comparison passes.
+ *
+ * The static functions are tested by including simdKernels.c.
+ *
+ * @file test-simdKernels.c
+ * @author Roberto Diaz Morales
+ * @date 23 Aug 2016
+ *
+ * @see simdKernels.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../src/simdKernels.c"
+
+/** @brief Largest length of the tested arrays. */
+#define TEST_LENGTH 67
+
+/** @brief Number of offsets (in elements) from the aligned start of the buffers. */
+#define TEST_OFFSETS 8
+
+/** @brief Relative tolerance of the vectorized versions with respect to the scalar references. */
+#define TEST_TOLERANCE 1e-12
+
+/** @brief Relative tolerance of the fast exponential with respect to the exp function of the math library. */
+#define TEST_EXP_TOLERANCE 1e-7
+
+/**
+ * @cond
+ */
+
+static int failures = 0;
+static int checks = 0;
+
+static double randomValue(void){
+    return 2.0*((double) rand())/RAND_MAX-1.0;
+}
+
+static void check(const char *name, int n, int offset, double value, double reference, double scale, double tolerance){
+    checks++;
+    if(fabs(value-reference) > tolerance*(scale+1e-300) && !(value==reference)){
+        failures++;
+        fprintf(stderr, "%s n=%d offset=%d: %.17g (reference %.17g)\n", name, n, offset, value, reference);
+    }
+}
+
+static void testSamples(const char *name, double (*function)(svm_sample *, svm_sample *, int), double (*reference)(svm_sample *, svm_sample *, int), svm_sample *x, svm_sample *y, double *scale){
+    int n, offset;
+    for(offset=0;offset<TEST_OFFSETS;offset++){
+        for(n=0;n<=TEST_LENGTH;n++){
+            check(name,n,offset,function(x+offset,y+offset,n),reference(x+offset,y+offset,n),scale[offset*(TEST_LENGTH+1)+n],TEST_TOLERANCE);
+        }
+    }
+}
+
+static void testSingle(const char *name, double (*function)(svm_sample_single *, svm_sample_single *, int), double (*reference)(svm_sample_single *, svm_sample_single *, int), svm_sample_single *x, svm_sample_single *y, double *scale){
+    int n, offset;
+    for(offset=0;offset<TEST_OFFSETS;offset++){
+        for(n=0;n<=TEST_LENGTH;n++){
+            check(name,n,offset,function(x+offset,y+offset,n),reference(x+offset,y+offset,n),scale[offset*(TEST_LENGTH+1)+n],TEST_TOLERANCE);
+        }
+    }
+}
+
+static void testArrays(const char *name, double (*function)(double *, double *, int), double (*reference)(double *, double *, int), double *x, double *y, double *scale){
+    int n, offset;
+    for(offset=0;offset<TEST_OFFSETS;offset++){
+        for(n=0;n<=TEST_LENGTH;n++){
+            check(name,n,offset,function(x+offset,y+offset,n),reference(x+offset,y+offset,n),scale[offset*(TEST_LENGTH+1)+n],TEST_TOLERANCE);
+        }
+    }
+}
+
+static void testExp(const char *name, void (*function)(double *, int, double), double *distances, double *values, double *expected){
+    double gammas[3] = {0.001, 1.0, 100.0};
+    int g, n, offset, i;
+    for(g=0;g<3;g++){
+        for(offset=0;offset<TEST_OFFSETS;offset++){
+            for(n=0;n<=TEST_LENGTH;n++){
+                for(i=0;i<TEST_LENGTH+TEST_OFFSETS;i++){
+                    values[i]=distances[i];
+                    expected[i]=distances[i];
+                }
+                function(values+offset,n,gammas[g]);
+                expFastScalar(expected+offset,n,gammas[g]);
+                for(i=0;i<TEST_LENGTH+TEST_OFFSETS;i++){
+                    if(i<offset || i>=offset+n){
+                        // The elements outside the array must not change.
+                        check(name,n,offset,values[i],distances[i],0.0,0.0);
+                    }else{
+                        check(name,n,offset,values[i],expected[i],expected[i],TEST_TOLERANCE);
+                        if(-gammas[g]*distances[i]>EXP_MIN) check(name,n,offset,values[i],exp(-gammas[g]*distances[i]),exp(-gammas[g]*distances[i]),TEST_EXP_TOLERANCE);
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(void){
+
+    int size = TEST_LENGTH+TEST_OFFSETS;
+    int i, n, offset;
+
+    svm_sample *x, *y;
+    svm_sample_single *xs, *ys;
+    double *ax, *ay, *distances, *values, *expected;
+    double *scaleDot = (double *) malloc(TEST_OFFSETS*(TEST_LENGTH+1)*sizeof(double));
+    double *scaleDistance = (double *) malloc(TEST_OFFSETS*(TEST_LENGTH+1)*sizeof(double));
+
+    if(posix_memalign((void **) &x,64,size*sizeof(svm_sample)) != 0 || posix_memalign((void **) &y,64,size*sizeof(svm_sample)) != 0 ||
+       posix_memalign((void **) &xs,64,size*sizeof(svm_sample_single)) != 0 || posix_memalign((void **) &ys,64,size*sizeof(svm_sample_single)) != 0 ||
+       posix_memalign((void **) &ax,64,size*sizeof(double)) != 0 || posix_memalign((void **) &ay,64,size*sizeof(double)) != 0 ||
+       posix_memalign((void **) &distances,64,size*sizeof(double)) != 0 || posix_memalign((void **) &values,64,size*sizeof(double)) != 0 ||
+       posix_memalign((void **) &expected,64,size*sizeof(double)) != 0){
+        fprintf(stderr, "Error: Not enough memory\n");
+        exit(2);
+    }
+
+    srand(1);
+    for(i=0;i<size;i++){
+        x[i].index = i+1;
+        y[i].index = i+1;
+        x[i].value = randomValue();
+        y[i].value = randomValue();
+        xs[i].index = i+1;
+        ys[i].index = i+1;
+        xs[i].value = (float) x[i].value;
+        ys[i].value = (float) y[i].value;
+        ax[i] = x[i].value;
+        ay[i] = y[i].value;
+        // Distances from 0 up to values whose exponential is below exp(-708) for the largest gamma.
+        distances[i] = 10.0*(randomValue()+1.0);
+    }
+
+    // The rounding errors are relative to the sum of the absolute values of the terms.
+    for(offset=0;offset<TEST_OFFSETS;offset++){
+        for(n=0;n<=TEST_LENGTH;n++){
+            double sumDot=0.0, sumDistance=0.0;
+            for(i=offset;i<offset+n;i++){
+                sumDot += fabs(x[i].value*y[i].value);
+                sumDistance += (x[i].value-y[i].value)*(x[i].value-y[i].value);
+            }
+            scaleDot[offset*(TEST_LENGTH+1)+n] = sumDot;
+            scaleDistance[offset*(TEST_LENGTH+1)+n] = sumDistance;
+        }
+    }
+
+    printf("Selected instruction set: %s\n", simdInstructionSet());
+
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse2")){
+        printf("Testing SSE2\n");
+        testSamples("dotSSE2",dotSSE2,dotScalar,x,y,scaleDot);
+        testSamples("distanceSSE2",distanceSSE2,distanceScalar,x,y,scaleDistance);
+    }
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        printf("Testing AVX2\n");
+        testSamples("dotAVX2",dotAVX2,dotScalar,x,y,scaleDot);
+        testSamples("distanceAVX2",distanceAVX2,distanceScalar,x,y,scaleDistance);
+        testSingle("dotSingleAVX2",dotSingleAVX2,dotSingleScalar,xs,ys,scaleDot);
+        testSingle("distanceSingleAVX2",distanceSingleAVX2,distanceSingleScalar,xs,ys,scaleDistance);
+        testArrays("arrayDotAVX2",arrayDotAVX2,arrayDotScalar,ax,ay,scaleDot);
+        testArrays("arrayDistanceAVX2",arrayDistanceAVX2,arrayDistanceScalar,ax,ay,scaleDistance);
+        testExp("expFastAVX2",expFastAVX2,distances,values,expected);
+    }
+    if(__builtin_cpu_supports("avx512f")){
+        printf("Testing AVX-512\n");
+        testSamples("dotAVX512",dotAVX512,dotScalar,x,y,scaleDot);
+        testSamples("distanceAVX512",distanceAVX512,distanceScalar,x,y,scaleDistance);
+        testArrays("arrayDotAVX512",arrayDotAVX512,arrayDotScalar,ax,ay,scaleDot);
+        testArrays("arrayDistanceAVX512",arrayDistanceAVX512,arrayDistanceScalar,ax,ay,scaleDistance);
+        testExp("expFastAVX512",expFastAVX512,distances,values,expected);
+    }
+#endif
+
+    // The selected functions through the public interface.
+    testSamples("denseDot",denseDot,dotScalar,x,y,scaleDot);
+    testSamples("denseSquaredDistance",denseSquaredDistance,distanceScalar,x,y,scaleDistance);
+    testSingle("denseDotSingle",denseDotSingle,dotSingleScalar,xs,ys,scaleDot);
+    testSingle("denseSquaredDistanceSingle",denseSquaredDistanceSingle,distanceSingleScalar,xs,ys,scaleDistance);
+    testArrays("arrayDot",arrayDot,arrayDotScalar,ax,ay,scaleDot);
+    testArrays("arraySquaredDistance",arraySquaredDistance,arrayDistanceScalar,ax,ay,scaleDistance);
+    testExp("expFastScalar",expFastScalar,distances,values,expected);
+
+    printf("%d comparisons, %d failures\n", checks, failures);
+
+    free(x);
+    free(y);
+    free(xs);
+    free(ys);
+    free(ax);
+    free(ay);
+    free(distances);
+    free(values);
+    free(expected);
+    free(scaleDot);
+    free(scaleDistance);
+
+    return failures == 0 ? 0 : 1;
+}
+
+/**
+ * @endcond
+ */